@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <system_error>
 #include <vector>
 
@@ -54,6 +55,7 @@ struct BlockShortEntry {
 class INode {
 public:
   typedef std::function<void(std::error_code)> Callback;
+  typedef std::function<void(uint32_t startHeight, std::vector<BlockShortEntry>&& blocks)> BlocksHandler;
 
   virtual ~INode() {}
   virtual bool addObserver(INodeObserver* observer) = 0;
@@ -74,6 +76,19 @@ public:
   virtual void getNewBlocks(std::vector<hash_t>&& knownBlockIds, std::vector<cryptonote::block_complete_entry_t>& newBlocks, uint32_t& startHeight, const Callback& callback) = 0;
   virtual void getTransactionOutsGlobalIndices(const hash_t& transactionHash, std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) = 0;
   virtual void queryBlocks(std::vector<hash_t>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const Callback& callback) = 0;
+  // queryBlocks that passes the blocks to blocksHandler in consecutive batches as they arrive, each with the height of its
+  // first block, and calls it at least once on success. The handler may block to hold the download back.
+  virtual void streamBlocks(std::vector<hash_t>&& knownBlockIds, uint64_t timestamp, const BlocksHandler& blocksHandler, const Callback& callback) {
+    auto newBlocks = std::make_shared<std::vector<BlockShortEntry>>();
+    auto startHeight = std::make_shared<uint32_t>(0);
+    queryBlocks(std::move(knownBlockIds), timestamp, *newBlocks, *startHeight, [newBlocks, startHeight, blocksHandler, callback](std::error_code ec) {
+      if (!ec) {
+        blocksHandler(*startHeight, std::move(*newBlocks));
+      }
+
+      callback(ec);
+    });
+  }
   virtual void getPoolSymmetricDifference(std::vector<hash_t>&& knownPoolTxIds, hash_t knownBlockId, bool& isBcActual, std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<hash_t>& deletedTxIds, const Callback& callback) = 0;
   virtual void getMultisignatureOutputByGlobalIndex(uint64_t amount, uint32_t gindex, multi_signature_output_t& out, const Callback& callback) = 0;
 
@@ -63,6 +63,7 @@ struct WalletTransaction {
   uint64_t creationTime;
   uint64_t unlockTime;
   std::string extra;
+  hash_t paymentId; // from extra, NULL_HASH if it has none
   bool isBase;
 };
 
@@ -120,6 +121,9 @@ public:
 
   virtual void changePassword(const std::string& oldPassword, const std::string& newPassword) = 0;
   virtual void save(std::ostream& destination, bool saveDetails = true, bool saveCache = true) = 0;
+  //appends transactions changed since the last save or load to a saved wallet.
+  //returns false and writes nothing when the wallet has to be saved in full instead
+  virtual bool saveChanges(std::ostream& destination) = 0;
 
   virtual size_t getAddressCount() const = 0;
   virtual std::string getAddress(size_t index) const = 0;
@@ -144,12 +148,20 @@ public:
   virtual WalletTransactionWithTransfers getTransaction(const hash_t& transactionHash) const = 0;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const hash_t& blockHash, size_t count) const = 0;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const = 0;
+  //same as getTransactions, but only transactions with transfers to or from one of the addresses
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, const hash_t& blockHash, size_t count) const = 0;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const = 0;
+  //confirmed transactions with the given payment id, grouped by block in blockchain order
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const hash_t& paymentId) const = 0;
   virtual std::vector<hash_t> getBlockHashes(uint32_t blockIndex, size_t count) const = 0;
   virtual uint32_t getBlockCount() const  = 0;
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const = 0;
   virtual std::vector<size_t> getDelayedTransactionIds() const = 0;
 
   virtual size_t transfer(const TransactionParameters& sendingTransaction) = 0;
+  //sends several transactions at once: decoys are fetched in one request, transactions are signed in parallel and relayed together.
+  //nothing is sent if any transaction can't be built. transactions that failed to relay are left in FAILED state
+  virtual std::vector<size_t> transfer(const std::vector<TransactionParameters>& sendingTransactions) = 0;
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) = 0;
   virtual void commitTransaction(size_t transactionId) = 0;
@@ -57,7 +57,32 @@ void JsonRpcServer::processRequest(const cryptonote::HttpRequest& req, cryptonot
         return;
       }
 
-      processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
+      ResultWriter resultWriter;
+      processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse, resultWriter);
+
+      if (resultWriter && !jsonRpcResponse.contains("error")) {
+        resp.setStatus(cryptonote::HttpResponse::STATUS_200);
+        resp.setStreamedBody([this, jsonRpcResponse, resultWriter] (std::ostream& out) {
+          out << '{';
+          for (const auto& field : jsonRpcResponse.getObject()) {
+            out << '"' << field.first << "\":" << field.second << ',';
+          }
+
+          out << "\"result\":";
+          try {
+            resultWriter(out);
+          } catch (std::exception& e) {
+            // the status line and part of the result are out already, so the client can only learn of the failure
+            // from the connection being dropped before the last chunk
+            logger(Logging::WARNING) << "Error while streaming json rpc result, dropping the connection: " << e.what();
+            throw;
+          }
+
+          out << '}';
+        });
+
+        return;
+      }
 
       std::ostringstream jsonOutputStream;
       jsonOutputStream << jsonRpcResponse;
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <functional>
+#include <ostream>
 #include <system_error>
 
 #include <system/Dispatcher.h>
@@ -36,6 +38,9 @@ public:
   virtual void start(const std::string& bindAddress, uint16_t bindPort);
 
 protected:
+  // Writes the "result" member of a response straight to the http body, see processJsonRpcRequest.
+  typedef std::function<void (std::ostream& out)> ResultWriter;
+
   static void makeErrorResponse(const std::error_code& ec, Common::JsonValue& resp);
   static void makeMethodNotFoundResponse(Common::JsonValue& resp);
   static void makeGenericErrorReponse(Common::JsonValue& resp, const char* what, int errorCode = -32001);
@@ -43,7 +48,9 @@ protected:
   static void prepareJsonResponse(const Common::JsonValue& req, Common::JsonValue& resp);
   static void makeJsonParsingErrorResponse(Common::JsonValue& resp);
 
-  virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) = 0;
+  // Either fills resp completely or, for large results, leaves "result" out of it and sets resultWriter,
+  // in which case the response is sent with chunked encoding as the writer produces it.
+  virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp, ResultWriter& resultWriter) = 0;
 
   // HttpServer
   virtual void processRequest(const cryptonote::HttpRequest& request, cryptonote::HttpResponse& response) override;
@@ -6,6 +6,7 @@
 #include "NodeErrors.h"
 
 #include <atomic>
+#include <iterator>
 #include <system_error>
 #include <thread>
 
@@ -13,14 +14,15 @@
 #include <http/HttpResponse.h>
 #include <system/ContextGroup.h>
 #include <system/Dispatcher.h>
-#include <system/Event.h>
-#include <system/EventLock.h>
+#include <system/RemoteContext.h>
 #include <system/Timer.h>
 #include "cryptonote/core/transaction/TransactionApi.h"
 
 #include "cryptonote/core/CryptoNoteTools.h"
+#include "rpc/BlocksStream.h"
 #include "rpc/CoreRpcServerCommandsDefinitions.h"
 #include "rpc/HttpClient.h"
+#include "rpc/HttpClientPool.h"
 #include "rpc/JsonRpc.h"
 #include "cryptonote/structures/array.hpp"
 
@@ -36,6 +38,9 @@ namespace cryptonote {
 
 namespace {
 
+// Blocks decoded from /queryblocksstream.bin are handed over this many at a time
+const size_t BLOCKS_STREAM_BATCH_SIZE = 100;
+
 std::error_code interpretResponseStatus(const std::string& status) {
   if (CORE_RPC_STATUS_BUSY == status) {
     return make_error_code(error::NODE_BUSY);
@@ -47,7 +52,8 @@ std::error_code interpretResponseStatus(const std::string& status) {
 
 }
 
-NodeRpcProxy::NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort) :
+NodeRpcProxy::NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort, size_t connectionCount) :
+    m_connectionCount(std::max<size_t>(connectionCount, 1)),
     m_rpcTimeout(10000),
     m_pullInterval(5000),
     m_nodeHost(nodeHost),
@@ -71,6 +77,7 @@ void NodeRpcProxy::resetInternalState() {
   m_networkHeight.store(0, std::memory_order_relaxed);
   m_lastKnowHash = cryptonote::NULL_HASH;
   m_knownTxs.clear();
+  m_poolSequence = 0;
 }
 
 void NodeRpcProxy::init(const INode::Callback& callback) {
@@ -123,11 +130,8 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
     m_dispatcher = &dispatcher;
     ContextGroup contextGroup(dispatcher);
     m_context_group = &contextGroup;
-    HttpClient httpClient(dispatcher, m_nodeHost, m_nodePort);
-    m_httpClient = &httpClient;
-    Event httpEvent(dispatcher);
-    m_httpEvent = &httpEvent;
-    m_httpEvent->set();
+    HttpClientPool httpClients(dispatcher, m_nodeHost, m_nodePort, m_connectionCount);
+    m_httpClients = &httpClients;
 
     {
       std::lock_guard<std::mutex> lock(m_mutex);
@@ -156,8 +160,7 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
 
   m_dispatcher = nullptr;
   m_context_group = nullptr;
-  m_httpClient = nullptr;
-  m_httpEvent = nullptr;
+  m_httpClients = nullptr;
   m_connected = false;
   m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
 }
@@ -171,22 +174,55 @@ void NodeRpcProxy::updateNodeStatus() {
 }
 
 bool NodeRpcProxy::updatePoolStatus() {
-  std::vector<hash_t> knownTxs = getKnownTxsVector();
-  hash_t tailBlock = m_lastKnowHash;
+  cryptonote::COMMAND_RPC_GET_POOL_CHANGES_LITE::request req = AUTO_VAL_INIT(req);
+  cryptonote::COMMAND_RPC_GET_POOL_CHANGES_LITE::response rsp = AUTO_VAL_INIT(rsp);
 
-  bool isBcActual = false;
-  std::vector<std::unique_ptr<ITransactionReader>> addedTxs;
-  std::vector<hash_t> deletedTxsIds;
+  // once the node has given a pool sequence number, only what changed since is asked for
+  req.tailBlockId = m_lastKnowHash;
+  req.poolSequence = m_poolSequence;
+  if (m_poolSequence == 0) {
+    req.knownTxsIds = getKnownTxsVector();
+  }
 
-  std::error_code ec = doGetPoolSymmetricDifference(std::move(knownTxs), tailBlock, isBcActual, addedTxs, deletedTxsIds);
+  std::error_code ec = binaryCommand("/get_pool_changes_lite.bin", req, rsp);
   if (ec) {
     return true;
   }
 
-  if (!isBcActual) {
+  if (!rsp.isTailBlockActual) {
     return false;
   }
 
+  std::vector<hash_t> deletedTxsIds;
+  if (req.poolSequence != 0 && !rsp.isPoolDelta) {
+    // the node could not tell what changed since, so it sent all of its pool
+    std::unordered_set<hash_t> poolTxs;
+    for (const auto& tpi : rsp.addedTxs) {
+      poolTxs.insert(tpi.txHash);
+    }
+
+    for (const auto& hash : m_knownTxs) {
+      if (poolTxs.count(hash) == 0) {
+        deletedTxsIds.push_back(hash);
+      }
+    }
+  } else {
+    for (const auto& hash : rsp.deletedTxsIds) {
+      if (m_knownTxs.count(hash) != 0) {
+        deletedTxsIds.push_back(hash);
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<ITransactionReader>> addedTxs;
+  for (const auto& tpi : rsp.addedTxs) {
+    if (m_knownTxs.count(tpi.txHash) == 0) {
+      addedTxs.push_back(createTransactionPrefix(tpi.txPrefix, tpi.txHash));
+    }
+  }
+
+  m_poolSequence = rsp.poolSequence;
+
   if (!addedTxs.empty() || !deletedTxsIds.empty()) {
     updatePoolState(addedTxs, deletedTxsIds);
     m_observerManager.notify(&INodeObserver::poolChanged);
@@ -231,8 +267,13 @@ void NodeRpcProxy::updateBlockchainStatus() {
     updatePeerCount(getInfoResp.incoming_connections_count + getInfoResp.outgoing_connections_count);
   }
 
-  if (m_connected != m_httpClient->isConnected()) {
-    m_connected = m_httpClient->isConnected();
+  updateConnectionStatus();
+}
+
+void NodeRpcProxy::updateConnectionStatus() {
+  bool connected = m_httpClients->isConnected();
+  if (m_connected != connected) {
+    m_connected = connected;
     m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
   }
 }
@@ -356,8 +397,26 @@ void NodeRpcProxy::queryBlocks(std::vector<hash_t>&& knownBlockIds, uint64_t tim
     return;
   }
 
-  scheduleRequest(std::bind(&NodeRpcProxy::doQueryBlocksLite, this, std::move(knownBlockIds), timestamp,
-          std::ref(newBlocks), std::ref(startHeight)), callback);
+  BlocksHandler blocksHandler = [&newBlocks, &startHeight](uint32_t height, std::vector<BlockShortEntry>&& blocks) {
+    if (newBlocks.empty()) {
+      startHeight = height;
+    }
+
+    std::move(blocks.begin(), blocks.end(), std::back_inserter(newBlocks));
+  };
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doStreamBlocks, this, std::move(knownBlockIds), timestamp, blocksHandler), callback);
+}
+
+void NodeRpcProxy::streamBlocks(std::vector<hash_t>&& knownBlockIds, uint64_t timestamp, const BlocksHandler& blocksHandler,
+  const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doStreamBlocks, this, std::move(knownBlockIds), timestamp, blocksHandler), callback);
 }
 
 void NodeRpcProxy::getPoolSymmetricDifference(std::vector<hash_t>&& knownPoolTxIds, hash_t knownBlockId, bool& isBcActual,
@@ -515,6 +574,30 @@ std::error_code NodeRpcProxy::doGetTransactionOutsGlobalIndices(const hash_t& tr
   return ec;
 }
 
+std::error_code NodeRpcProxy::doStreamBlocks(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp,
+        const BlocksHandler& blocksHandler) {
+  // The stream holds its connection while the handler waits, the caller may need another one meanwhile
+  if (m_blocksStreamSupported && m_connectionCount > 1) {
+    bool isSupported = true;
+    std::error_code ec = doQueryBlocksStream(knownBlockIds, timestamp, blocksHandler, isSupported);
+    if (isSupported) {
+      return ec;
+    }
+
+    // Daemon predates /queryblocksstream.bin
+    m_blocksStreamSupported = false;
+  }
+
+  std::vector<cryptonote::BlockShortEntry> newBlocks;
+  uint32_t startHeight = 0;
+  std::error_code ec = doQueryBlocksLite(knownBlockIds, timestamp, newBlocks, startHeight);
+  if (!ec) {
+    handOverBlocks(blocksHandler, startHeight, std::move(newBlocks));
+  }
+
+  return ec;
+}
+
 std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp,
         std::vector<cryptonote::BlockShortEntry>& newBlocks, uint32_t& startHeight) {
   cryptonote::COMMAND_RPC_QUERY_BLOCKS_LITE::request req = AUTO_VAL_INIT(req);
@@ -556,6 +639,99 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<hash_t>& known
   return std::error_code();
 }
 
+std::error_code NodeRpcProxy::doQueryBlocksStream(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp,
+        const BlocksHandler& blocksHandler, bool& isSupported) {
+  cryptonote::COMMAND_RPC_QUERY_BLOCKS_STREAM::request req = AUTO_VAL_INIT(req);
+  cryptonote::COMMAND_RPC_QUERY_BLOCKS_STREAM::response header = AUTO_VAL_INIT(header);
+
+  req.blockIds = knownBlockIds;
+  req.timestamp = timestamp;
+
+  HttpRequest hreq;
+  HttpResponse hres;
+  hreq.setUrl("/queryblocksstream.bin");
+  hreq.setBody(storeToBinaryKeyValue(req));
+
+  bool headerReceived = false;
+  bool blocksHandled = false;
+  uint32_t height = 0;
+  std::vector<cryptonote::BlockShortEntry> blocks;
+
+  auto handleBlocks = [&]() {
+    uint32_t count = static_cast<uint32_t>(blocks.size());
+    handOverBlocks(blocksHandler, height, std::move(blocks));
+    blocks.clear();
+    height += count;
+    blocksHandled = true;
+  };
+
+  // Blocks are decoded as records arrive and handed over a batch at a time, so the caller can process them
+  // while the rest is still being received
+  BlocksStreamReader reader([&](const std::string& record) {
+    if (!headerReceived) {
+      if (!loadFromBinaryKeyValue(header, record)) {
+        throw std::runtime_error("Failed to parse blocks stream header");
+      }
+
+      headerReceived = true;
+      height = static_cast<uint32_t>(header.startHeight);
+      return;
+    }
+
+    BlockShortEntry bse;
+    if (!loadBlockRecord(record, bse)) {
+      throw std::runtime_error("Failed to parse blocks stream record");
+    }
+
+    blocks.push_back(std::move(bse));
+    if (blocks.size() == BLOCKS_STREAM_BATCH_SIZE) {
+      handleBlocks();
+    }
+  });
+
+  try {
+    HttpClientPool::Lease lease(*m_httpClients);
+    lease.client().request(hreq, hres, [&](const std::string& data) {
+      if (hres.getStatus() == HttpResponse::STATUS_200) {
+        reader.feed(data);
+      }
+    });
+  } catch (const ConnectException&) {
+    return make_error_code(error::CONNECT_ERROR);
+  } catch (const std::exception&) {
+    return make_error_code(error::NETWORK_ERROR);
+  }
+
+  if (hres.getStatus() == HttpResponse::STATUS_404) {
+    isSupported = false;
+    return make_error_code(error::NETWORK_ERROR);
+  }
+
+  if (hres.getStatus() != HttpResponse::STATUS_200 || !reader.isFinished()) {
+    return make_error_code(error::NETWORK_ERROR);
+  }
+
+  std::error_code ec = interpretResponseStatus(header.status);
+  if (ec) {
+    return ec;
+  }
+
+  if (!blocks.empty() || !blocksHandled) {
+    handleBlocks();
+  }
+
+  return std::error_code();
+}
+
+void NodeRpcProxy::handOverBlocks(const BlocksHandler& blocksHandler, uint32_t startHeight, std::vector<cryptonote::BlockShortEntry>&& blocks) {
+  // The handler may block until its caller catches up, which must not stop the other requests on the dispatcher
+  System::RemoteContext<void> context(*m_dispatcher, [&blocksHandler, startHeight, &blocks] {
+    blocksHandler(startHeight, std::move(blocks));
+  });
+
+  context.get();
+}
+
 std::error_code NodeRpcProxy::doGetPoolSymmetricDifference(std::vector<hash_t>&& knownPoolTxIds, hash_t knownBlockId, bool& isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<hash_t>& deletedTxIds) {
   cryptonote::COMMAND_RPC_GET_POOL_CHANGES_LITE::request req = AUTO_VAL_INIT(req);
@@ -610,10 +786,7 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure,
           callback(std::make_error_code(std::errc::operation_canceled));
         } else {
           std::error_code ec = procedure();
-          if (m_connected != m_httpClient->isConnected()) {
-            m_connected = m_httpClient->isConnected();
-            m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
-          }
+          updateConnectionStatus();
           callback(m_stop ? std::make_error_code(std::errc::operation_canceled) : ec);
         }
       }, std::move(procedure), std::move(callback)));
@@ -625,8 +798,8 @@ std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Reques
   std::error_code ec;
 
   try {
-    EventLock eventLock(*m_httpEvent);
-    invokeBinaryCommand(*m_httpClient, url, req, res);
+    HttpClientPool::Lease lease(*m_httpClients);
+    invokeBinaryCommand(lease.client(), url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
@@ -642,8 +815,8 @@ std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request&
   std::error_code ec;
 
   try {
-    EventLock eventLock(*m_httpEvent);
-    invokeJsonCommand(*m_httpClient, url, req, res);
+    HttpClientPool::Lease lease(*m_httpClients);
+    invokeJsonCommand(lease.client(), url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
@@ -659,7 +832,7 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
   std::error_code ec = make_error_code(error::INTERNAL_NODE_ERROR);
 
   try {
-    EventLock eventLock(*m_httpEvent);
+    HttpClientPool::Lease lease(*m_httpClients);
 
     JsonRpc::JsonRpcRequest jsReq;
 
@@ -672,7 +845,7 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
     httpReq.setUrl("/json_rpc");
     httpReq.setBody(jsReq.getBody());
 
-    m_httpClient->request(httpReq, httpRes);
+    lease.client().request(httpReq, httpRes);
 
     JsonRpc::JsonRpcResponse jsRes;
 
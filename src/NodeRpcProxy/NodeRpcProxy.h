@@ -22,7 +22,7 @@ namespace System {
 
 namespace cryptonote {
 
-class HttpClient;
+class HttpClientPool;
 
 class INodeRpcProxyObserver {
 public:
@@ -32,7 +32,9 @@ public:
 
 class NodeRpcProxy : public cryptonote::INode {
 public:
-  NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort);
+  static const size_t DEFAULT_CONNECTION_COUNT = 4;
+
+  NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort, size_t connectionCount = DEFAULT_CONNECTION_COUNT);
   virtual ~NodeRpcProxy();
 
   virtual bool addObserver(cryptonote::INodeObserver* observer) override;
@@ -56,6 +58,7 @@ public:
   virtual void getNewBlocks(std::vector<hash_t>&& knownBlockIds, std::vector<cryptonote::block_complete_entry_t>& newBlocks, uint32_t& startHeight, const Callback& callback) override;
   virtual void getTransactionOutsGlobalIndices(const hash_t& transactionHash, std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override;
   virtual void queryBlocks(std::vector<hash_t>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const Callback& callback) override;
+  virtual void streamBlocks(std::vector<hash_t>&& knownBlockIds, uint64_t timestamp, const BlocksHandler& blocksHandler, const Callback& callback) override;
   virtual void getPoolSymmetricDifference(std::vector<hash_t>&& knownPoolTxIds, hash_t knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<hash_t>& deletedTxIds, const Callback& callback) override;
   virtual void getMultisignatureOutputByGlobalIndex(uint64_t amount, uint32_t gindex, multi_signature_output_t& out, const Callback& callback) override;
@@ -81,6 +84,7 @@ private:
   bool updatePoolStatus();
   void updatePeerCount(size_t peerCount);
   void updatePoolState(const std::vector<std::unique_ptr<ITransactionReader>>& addedTxs, const std::vector<hash_t>& deletedTxsIds);
+  void updateConnectionStatus();
 
   std::error_code doRelayTransaction(const cryptonote::transaction_t& transaction);
   std::error_code doGetRandomOutsByAmounts(std::vector<uint64_t>& amounts, uint64_t outsCount,
@@ -89,8 +93,12 @@ private:
     std::vector<cryptonote::block_complete_entry_t>& newBlocks, uint32_t& startHeight);
   std::error_code doGetTransactionOutsGlobalIndices(const hash_t& transactionHash,
                                                     std::vector<uint32_t>& outsGlobalIndices);
+  std::error_code doStreamBlocks(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp, const BlocksHandler& blocksHandler);
   std::error_code doQueryBlocksLite(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp,
     std::vector<cryptonote::BlockShortEntry>& newBlocks, uint32_t& startHeight);
+  std::error_code doQueryBlocksStream(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp,
+    const BlocksHandler& blocksHandler, bool& isSupported);
+  void handOverBlocks(const BlocksHandler& blocksHandler, uint32_t startHeight, std::vector<cryptonote::BlockShortEntry>&& blocks);
   std::error_code doGetPoolSymmetricDifference(std::vector<hash_t>&& knownPoolTxIds, hash_t knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<hash_t>& deletedTxIds);
 
@@ -120,9 +128,10 @@ private:
 
   const std::string m_nodeHost;
   const unsigned short m_nodePort;
+  const size_t m_connectionCount;
   unsigned int m_rpcTimeout;
-  HttpClient* m_httpClient = nullptr;
-  System::Event* m_httpEvent = nullptr;
+  HttpClientPool* m_httpClients = nullptr;
+  bool m_blocksStreamSupported = true;
 
   uint64_t m_pullInterval;
 
@@ -136,6 +145,8 @@ private:
   hash_t m_lastKnowHash;
   std::atomic<uint64_t> m_lastLocalBlockTimestamp;
   std::unordered_set<hash_t> m_knownTxs;
+  // pool sequence number of the node m_knownTxs are up to, 0 if it does not give one
+  uint64_t m_poolSequence;
 
   bool m_connected;
 };
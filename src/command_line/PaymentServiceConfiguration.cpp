@@ -17,7 +17,7 @@ namespace PaymentService {
 
 Configuration::Configuration():generateNewContainer(false), daemonize(false), registerService(false), 
 unregisterService(false), logFile("payment_gate.log"), printAddresses(false), logLevel(Logging::INFO),
-bindAddress(""), bindPort(0)
+bindAddress(""), bindPort(0), decoyCacheOutputs(0)
 {
 }
 
@@ -36,6 +36,7 @@ void Configuration::initOptions(boost::program_options::options_description& des
       ("log-file,l", po::value<std::string>(), "log file")
       ("server-root", po::value<std::string>(), "server root. The service will use it as working directory. Don't set it if don't want to change it")
       ("log-level", po::value<size_t>(), "log level")
+      ("decoy-cache-outputs", po::value<uint64_t>(), "decoy outputs to fetch and keep per amount for transfers, 0 (default) asks the daemon on every transfer")
       ("address", "print wallet addresses and exit");
 }
 
@@ -72,6 +73,10 @@ void Configuration::init(const boost::program_options::variables_map& options) {
     }
   }
 
+  if (options.count("decoy-cache-outputs") != 0) {
+    decoyCacheOutputs = options["decoy-cache-outputs"].as<uint64_t>();
+  }
+
   if (options.count("server-root") != 0) {
     serverRoot = options["server-root"].as<std::string>();
   }
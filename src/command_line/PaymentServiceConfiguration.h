@@ -38,6 +38,7 @@ struct Configuration {
   bool printAddresses;
 
   size_t logLevel;
+  uint64_t decoyCacheOutputs;
 };
 
 } //namespace PaymentService
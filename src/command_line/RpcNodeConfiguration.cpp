@@ -11,12 +11,14 @@ namespace po = boost::program_options;
 RpcNodeConfiguration::RpcNodeConfiguration() {
   daemonHost = "";
   daemonPort = 0;
+  daemonConnections = 0;
 }
 
 void RpcNodeConfiguration::initOptions(boost::program_options::options_description& desc) {
   desc.add_options()
     ("daemon-address", po::value<std::string>()->default_value("localhost"), "daemon address")
-    ("daemon-port", po::value<uint16_t>()->default_value(8081), "daemon port");
+    ("daemon-port", po::value<uint16_t>()->default_value(8081), "daemon port")
+    ("daemon-connections", po::value<uint32_t>()->default_value(4), "number of concurrent connections to the daemon");
 }
 
 void RpcNodeConfiguration::init(const boost::program_options::variables_map& options) {
@@ -27,6 +29,10 @@ void RpcNodeConfiguration::init(const boost::program_options::variables_map& opt
   if (options.count("daemon-port") != 0 && (!options["daemon-port"].defaulted() || daemonPort == 0)) {
     daemonPort = options["daemon-port"].as<uint16_t>();
   }
+
+  if (options.count("daemon-connections") != 0 && (!options["daemon-connections"].defaulted() || daemonConnections == 0)) {
+    daemonConnections = options["daemon-connections"].as<uint32_t>();
+  }
 }
 
 } //namespace PaymentService
@@ -18,6 +18,7 @@ public:
 
   std::string daemonHost;
   uint16_t daemonPort;
+  uint32_t daemonConnections;
 };
 
 } //namespace PaymentService
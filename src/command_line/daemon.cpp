@@ -93,6 +93,7 @@ void Daemon::init()
   addSetting(arg_log_level);
   addSetting(arg_console);
   addSetting(arg_testnet_on);
+  addSetting(arg_mempool_max_size);
   addSetting(arg_print_genesis_tx);
 }
 
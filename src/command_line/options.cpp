@@ -27,6 +27,10 @@ const arg_descriptor<bool> arg_console = {"no-console", "Disable daemon console
 const arg_descriptor<bool> arg_testnet_on = {"testnet", "Used to deploy test nets. Checkpoints and hardcoded seeds are ignored, "
                                                         "network id is changed. Use it with --data-dir flag. The wallet must be launched with --testnet flag.",
                                              false};
+// Memory pool
+const arg_descriptor<uint64_t> arg_mempool_max_size = {"mempool-max-size", "Maximum size in bytes of the transactions kept in the memory pool, "
+                                                                           "those paying the least per byte are evicted past it",
+                                                       cryptonote::parameters::CRYPTONOTE_MEMPOOL_MAX_SIZE};
 // BLockchain
 const arg_descriptor<bool> arg_print_genesis_tx = {"print-genesis-tx", "Prints genesis' block tx hex to insert it to config and exits"};
 const arg_descriptor<std::string> arg_extra_messages =  {"extra-messages-file", "Specify file for extra messages to include into coinbase transactions", "", true};
@@ -28,6 +28,9 @@ extern const arg_descriptor<bool> arg_console;
 // Test arguments
 extern const arg_descriptor<bool> arg_testnet_on;
 
+// Memory pool arguments
+extern const arg_descriptor<uint64_t> arg_mempool_max_size;
+
 // Miner arguments
 extern const arg_descriptor<std::string> arg_extra_messages;
 extern const arg_descriptor<std::string> arg_start_mining;
@@ -61,7 +61,7 @@ filename_t filenames =
 
 storage_version_t storage = {
     {1, 0, 0},
-    {1, 0, 0}};
+    {3, 0, 0}};
 
 } // namespace
 
@@ -54,7 +54,7 @@ filename_t filenames =
 
 storage_version_t storage = {
     {1, 0, 0},
-    {1, 0, 0}};
+    {3, 0, 0}};
 
 } // namespace
 config_t data = {
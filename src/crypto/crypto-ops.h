@@ -31,6 +31,8 @@
  #ifndef CRYPTO_OPS_H_
  #define CRYPTO_OPS_H_
 
+#include <stddef.h>
+
  #ifdef __cplusplus
 extern "C"
 {
@@ -126,6 +128,7 @@ extern void ge_scalarmult_base(ge_p3 *, const unsigned char *);
 /* From ge_tobytes.c */
 
 extern void ge_tobytes(unsigned char *, const ge_p2 *);
+extern void ge_tobytes_batch(unsigned char *, const ge_p2 *, fe *, size_t);
 
 /* From sc_reduce.c */
 
@@ -134,6 +137,8 @@ extern void sc_reduce(unsigned char *);
 /* New code */
 
 extern void ge_scalarmult(ge_p2 *, const unsigned char *, const ge_p3 *);
+extern void ge_scalarmult_recode(signed char *, const unsigned char *);
+extern void ge_scalarmult_recoded(ge_p2 *, const signed char *, const ge_p3 *);
 extern void ge_scalarmult_p3(ge_p3 *, const unsigned char *, const ge_p3 *);
 extern void ge_double_scalarmult_precomp_vartime(ge_p2 *, const unsigned char *, const ge_p3 *, const unsigned char *, const ge_dsmp);
 extern void ge_double_scalarmult_precomp_vartime2(ge_p2 *, const unsigned char *, const ge_dsmp, const unsigned char *, const ge_dsmp);
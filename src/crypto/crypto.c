@@ -96,6 +96,63 @@ int generate_key_derivation(const uint8_t *public_key, const uint8_t *secret_key
   return 1;
 }
 
+size_t generate_key_derivations(const uint8_t *public_keys, size_t count, const uint8_t *secret_key, uint8_t *key_derivations, int *results)
+{
+  signed char e[64];
+  ge_p3 point;
+  ge_p2 point2;
+  ge_p1p1 point3;
+  ge_p2 *points;
+  fe *scratch;
+  size_t i;
+  size_t derived = 0;
+  assert(sc_check(secret_key) == 0);
+  if (count == 0)
+  {
+    return 0;
+  }
+  points = (ge_p2 *)malloc(count * sizeof(ge_p2));
+  scratch = (fe *)malloc(count * sizeof(fe));
+  if (points == NULL || scratch == NULL)
+  {
+    free(points);
+    free(scratch);
+    for (i = 0; i < count; i++)
+    {
+      results[i] = generate_key_derivation(public_keys + 32 * i, secret_key, key_derivations + 32 * i);
+      derived += results[i];
+    }
+    return derived;
+  }
+  ge_scalarmult_recode(e, secret_key);
+  for (i = 0; i < count; i++)
+  {
+    if (ge_frombytes_vartime(&point, public_keys + 32 * i) != 0)
+    {
+      /* keep the batch uniform, the slot is zeroed after encoding */
+      ge_p3_to_p2(&points[i], &ge_p3_identity);
+      results[i] = 0;
+      continue;
+    }
+    ge_scalarmult_recoded(&point2, e, &point);
+    ge_mul8(&point3, &point2);
+    ge_p1p1_to_p2(&points[i], &point3);
+    results[i] = 1;
+    ++derived;
+  }
+  ge_tobytes_batch(key_derivations, points, scratch, count);
+  for (i = 0; i < count; i++)
+  {
+    if (!results[i])
+    {
+      memset(key_derivations + 32 * i, 0, 32);
+    }
+  }
+  free(points);
+  free(scratch);
+  return derived;
+}
+
 static void derivation_to_scalar(const uint8_t *derivation, size_t output_index, uint8_t *res)
 {
   struct
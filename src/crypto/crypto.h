@@ -26,6 +26,11 @@ extern "C"
   extern int check_key(const uint8_t *public_key);
   extern int secret_key_to_public_key(const uint8_t *secret_key, uint8_t *public_key);
   extern int generate_key_derivation(const uint8_t *public_key, const uint8_t *secret_key, uint8_t *key_derivation);
+  /* Derives count keys against one secret key, sharing its recoding and a single field inversion.
+   * results[i] is set as generate_key_derivation would return it; returns the number of successful derivations.
+   */
+  extern size_t generate_key_derivations(const uint8_t *public_keys, size_t count, const uint8_t *secret_key,
+                                         uint8_t *key_derivations, int *results);
 
   extern int derive_public_key(const uint8_t *derivation, size_t output_index,
                                const uint8_t *base, uint8_t *derived_key);
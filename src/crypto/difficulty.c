@@ -61,7 +61,9 @@ bool check_hash(const hash_t *hash, uint64_t difficulty)
 
 int compare(const void *a, const void *b)
 {
-  return (*(int *)a - *(int *)b);
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
 }
 
 uint64_t next_difficulty(uint64_t *timestamps,
@@ -71,13 +73,24 @@ uint64_t next_difficulty(uint64_t *timestamps,
 {
   difficulty_config_t *config = (difficulty_config_t *)conf;
 
-  assert(config->window >= 2);
-
   if (timestamps_length > config->window)
   {
     timestamps_length = config->window;
   }
 
+  qsort(timestamps, timestamps_length, sizeof(uint64_t), compare);
+  return next_difficulty_sorted(timestamps, timestamps_length, cumulativeDifficulties, conf);
+}
+
+uint64_t next_difficulty_sorted(const uint64_t *timestamps,
+                                uint16_t timestamps_length,
+                                const uint64_t *cumulativeDifficulties,
+                                uint64_t *conf)
+{
+  difficulty_config_t *config = (difficulty_config_t *)conf;
+
+  assert(config->window >= 2);
+
   size_t length = timestamps_length;
   assert(length <= config->window);
   if (length <= 1)
@@ -85,8 +98,6 @@ uint64_t next_difficulty(uint64_t *timestamps,
     return 1;
   }
 
-  qsort(timestamps, timestamps_length, sizeof(uint64_t), compare);
-
   size_t cutBegin, cutEnd;
   assert(2 * config->cut <= config->window - 2);
 
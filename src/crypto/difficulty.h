@@ -19,6 +19,11 @@ extern "C"
                                   uint16_t timestamps_length,
                                   uint64_t *cumulativeDifficulties,
                                   uint64_t *config);
+  // same as next_difficulty for timestamps already sorted and no longer than the window
+  extern uint64_t next_difficulty_sorted(const uint64_t *timestamps,
+                                         uint16_t timestamps_length,
+                                         const uint64_t *cumulativeDifficulties,
+                                         uint64_t *config);
 
 #ifdef __cplusplus
 } // extern "C"
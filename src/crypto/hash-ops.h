@@ -77,6 +77,17 @@ extern void cn_fast_hash(const void *data, size_t length, char *hash);
 
 extern void cn_slow_hash(const void *data, size_t length, char *hash, int variant, int prehashed);
 
+// How many hashes cn_slow_hash_multi computes side by side, each with a scratchpad of its own.
+#define SLOW_HASH_MULTI_MAX 4
+
+// cn_slow_hash of count inputs of the same length, hash[i] of data[i]. With AES-NI the inputs are
+// hashed up to SLOW_HASH_MULTI_MAX at a time with their steps interleaved, one by one otherwise.
+extern void cn_slow_hash_multi(const void *const *data, size_t length, size_t count, char *const *hash, int variant);
+
+// Frees the scratchpads cn_slow_hash and cn_slow_hash_multi keep for the calling thread, to be called by
+// hashing threads before they exit. The next call on the thread allocates them again.
+extern void slow_hash_free_state(void);
+
 extern void hash_extra_blake(const void *data, size_t length, char *hash);
 extern void hash_extra_groestl(const void *data, size_t length, char *hash);
 extern void hash_extra_jh(const void *data, size_t length, char *hash);
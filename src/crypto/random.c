@@ -95,12 +95,29 @@ static void generate_system_random_bytes(size_t n, void *result) {
 
 #endif
 
-static union hash_state state;
+#if defined(_MSC_VER)
+#define THREADV __declspec(thread)
+#else
+#define THREADV __thread
+#endif
+
+/* Every thread keeps its own generator state, seeded from the system on first use,
+ * so transactions can be signed on several threads at once. */
+static THREADV union hash_state state;
+static THREADV int state_seeded;
 
 #if !defined(NDEBUG)
-static volatile int curstate; /* To catch thread safety problems. */
+static THREADV volatile int curstate; /* To catch reentrancy problems. */
 #endif
 
+static void seed_random(void) {
+  generate_system_random_bytes(32, &state);
+  state_seeded = 1;
+#if !defined(NDEBUG)
+  curstate = 1;
+#endif
+}
+
 FINALIZER(deinit_random) {
 #if !defined(NDEBUG)
   assert(curstate == 1);
@@ -110,15 +127,17 @@ FINALIZER(deinit_random) {
 }
 
 INITIALIZER(init_random) {
-  generate_system_random_bytes(32, &state);
-  REGISTER_FINALIZER(deinit_random);
 #if !defined(NDEBUG)
   assert(curstate == 0);
-  curstate = 1;
 #endif
+  seed_random();
+  REGISTER_FINALIZER(deinit_random);
 }
 
 void generate_random_bytes_not_thread_safe(size_t n, void *result) {
+  if (!state_seeded) {
+    seed_random();
+  }
 #if !defined(NDEBUG)
   assert(curstate == 1);
   curstate = 2;
@@ -150,4 +169,8 @@ void generate_random_bytes_not_thread_safe(size_t n, void *result) {
 void setup_random(int value)
 {
   memset(&state, value, sizeof(union hash_state));
+  state_seeded = 1;
+#if !defined(NDEBUG)
+  curstate = 1;
+#endif
 }
@@ -333,6 +333,9 @@ union cn_slow_hash_state
 
 THREADV uint8_t *hp_state = NULL;
 THREADV int hp_allocated = 0;
+// Scratchpads for cn_slow_hash_multi, as many as the widest call of the thread needed so far
+THREADV uint8_t *hp_multi_state = NULL;
+THREADV size_t hp_multi_count = 0;
 
 #if defined(_MSC_VER)
 #define cpuid(info,x)    __cpuidex(info,x,0)
@@ -650,6 +653,10 @@ void slow_hash_allocate_state(void)
 
 void slow_hash_free_state(void)
 {
+    free(hp_multi_state);
+    hp_multi_state = NULL;
+    hp_multi_count = 0;
+
     if(hp_state == NULL)
         return;
 
@@ -834,6 +841,183 @@ void cn_slow_hash(const void *data, size_t length, char *hash, int variant, int
     extra_hashes[state.hs.b[0] & 3](&state, 200, hash);
 }
 
+/*
+ * cn_slow_hash_multi: several hashes computed side by side.  Each iteration of
+ * step 3 waits on a random scratchpad read, then on the AES round and the
+ * multiply that depend on it; the iterations of independent hashes have no
+ * such dependencies between them, so interleaving them fills those waits.
+ * Steps 1, 2, 4 and 5 run one hash after the other as in cn_slow_hash.
+ */
+
+#define CN_SLOW_HASH_MULTI_INTERLEAVED
+
+#if defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+/* what cn_slow_hash keeps in locals between steps, for one of the hashes */
+struct cn_slow_hash_lane
+{
+    RDATA_ALIGN16 uint64_t a[2];
+    RDATA_ALIGN16 uint64_t b[4];
+    RDATA_ALIGN16 uint64_t c[2];
+    RDATA_ALIGN16 uint8_t expandedKey[240];
+    __m128i _b, _b1;
+    uint64_t tweak1_2;
+    uint64_t division_result;
+    uint64_t sqrt_result;
+    uint8_t *hp_state;
+    union cn_slow_hash_state state;
+};
+
+static void (*const cn_extra_hashes[4])(const void *, size_t, char *) =
+{
+    hash_extra_blake, hash_extra_groestl, hash_extra_jh, hash_extra_skein
+};
+
+/* CryptoNight steps 1 and 2 into the lane, with scratchpad as its 2MB buffer */
+STATIC void cn_lane_init(struct cn_slow_hash_lane *lane, const void *data, size_t length, int variant, uint8_t *scratchpad)
+{
+    uint8_t text[INIT_SIZE_BYTE];
+    union cn_slow_hash_state state;
+    uint64_t *b = lane->b;
+    size_t i;
+
+    hash_process(&state.hs, data, length);
+    memcpy(text, state.init, INIT_SIZE_BYTE);
+
+    VARIANT1_INIT64();
+    VARIANT2_INIT64();
+    lane->tweak1_2 = tweak1_2;
+    lane->division_result = division_result;
+    lane->sqrt_result = sqrt_result;
+
+    aes_expand_key(state.hs.b, lane->expandedKey);
+    for(i = 0; i < MEMORY / INIT_SIZE_BYTE; i++)
+    {
+        aes_pseudo_round(text, text, lane->expandedKey, INIT_SIZE_BLK);
+        memcpy(&scratchpad[i * INIT_SIZE_BYTE], text, INIT_SIZE_BYTE);
+    }
+
+    U64(lane->a)[0] = U64(&state.k[0])[0] ^ U64(&state.k[32])[0];
+    U64(lane->a)[1] = U64(&state.k[0])[1] ^ U64(&state.k[32])[1];
+    U64(b)[0] = U64(&state.k[16])[0] ^ U64(&state.k[48])[0];
+    U64(b)[1] = U64(&state.k[16])[1] ^ U64(&state.k[48])[1];
+
+    lane->_b = _mm_load_si128(R128(b));
+    lane->_b1 = _mm_load_si128(R128(b) + 1);
+    lane->hp_state = scratchpad;
+    lane->state = state;
+}
+
+/* one iteration of CryptoNight step 3, the body of the AES-NI loop of cn_slow_hash */
+STATIC FORCE_INLINE void cn_lane_step(struct cn_slow_hash_lane *lane, int variant)
+{
+    uint8_t *hp_state = lane->hp_state;
+    uint64_t *a = lane->a;
+    uint64_t *b = lane->b;
+    uint64_t *c = lane->c;
+    const uint64_t tweak1_2 = lane->tweak1_2;
+    uint64_t division_result = lane->division_result;
+    uint64_t sqrt_result = lane->sqrt_result;
+    __m128i _a, _b = lane->_b, _b1 = lane->_b1, _c;
+    uint64_t hi, lo;
+    uint64_t *p;
+    size_t j;
+
+    pre_aes();
+    _c = _mm_aesenc_si128(_c, _a);
+    post_aes();
+
+    lane->_b = _b;
+    lane->_b1 = _b1;
+    lane->division_result = division_result;
+    lane->sqrt_result = sqrt_result;
+}
+
+/* CryptoNight steps 4 and 5 of the lane */
+STATIC void cn_lane_finish(struct cn_slow_hash_lane *lane, char *hash)
+{
+    uint8_t text[INIT_SIZE_BYTE];
+    size_t i;
+
+    memcpy(text, lane->state.init, INIT_SIZE_BYTE);
+    aes_expand_key(&lane->state.hs.b[32], lane->expandedKey);
+    for(i = 0; i < MEMORY / INIT_SIZE_BYTE; i++)
+    {
+        aes_pseudo_round_xor(text, text, lane->expandedKey, &lane->hp_state[i * INIT_SIZE_BYTE], INIT_SIZE_BLK);
+    }
+
+    memcpy(lane->state.init, text, INIT_SIZE_BYTE);
+    hash_permutation(&lane->state.hs);
+    cn_extra_hashes[lane->state.hs.b[0] & 3](&lane->state, 200, hash);
+}
+
+void cn_slow_hash_multi(const void *const *data, size_t length, size_t count, char *const *hash, int variant)
+{
+    struct cn_slow_hash_lane lanes[SLOW_HASH_MULTI_MAX];
+    size_t i, k, n;
+
+    n = count < SLOW_HASH_MULTI_MAX ? count : SLOW_HASH_MULTI_MAX;
+    if(n > 1 && n > hp_multi_count && !force_software_aes() && check_aes_hw())
+    {
+        free(hp_multi_state);
+        hp_multi_state = (uint8_t *) malloc(n * MEMORY);
+        hp_multi_count = hp_multi_state == NULL ? 0 : n;
+    }
+
+    for(; count > 0; count -= n, data += n, hash += n)
+    {
+        n = count < SLOW_HASH_MULTI_MAX ? count : SLOW_HASH_MULTI_MAX;
+        if(n == 1 || n > hp_multi_count)
+        {
+            for(k = 0; k < n; k++)
+                cn_slow_hash(data[k], length, hash[k], variant, 0);
+
+            continue;
+        }
+
+        for(k = 0; k < n; k++)
+            cn_lane_init(&lanes[k], data[k], length, variant, hp_multi_state + k * MEMORY);
+
+        /* the lane count is a constant in each loop, so that the steps are inlined side by side */
+        switch(n)
+        {
+        case 2:
+            for(i = 0; i < ITER / 2; i++)
+            {
+                cn_lane_step(&lanes[0], variant);
+                cn_lane_step(&lanes[1], variant);
+            }
+            break;
+
+        case 3:
+            for(i = 0; i < ITER / 2; i++)
+            {
+                cn_lane_step(&lanes[0], variant);
+                cn_lane_step(&lanes[1], variant);
+                cn_lane_step(&lanes[2], variant);
+            }
+            break;
+
+        default:
+            for(i = 0; i < ITER / 2; i++)
+            {
+                cn_lane_step(&lanes[0], variant);
+                cn_lane_step(&lanes[1], variant);
+                cn_lane_step(&lanes[2], variant);
+                cn_lane_step(&lanes[3], variant);
+            }
+            break;
+        }
+
+        for(k = 0; k < n; k++)
+            cn_lane_finish(&lanes[k], hash[k]);
+    }
+}
+
 #elif !defined NO_AES && (defined(__arm__) || defined(__aarch64__))
 void slow_hash_allocate_state(void)
 {
@@ -1578,3 +1762,14 @@ void cn_slow_hash(const void *data, size_t length, char *hash, int variant, int
 }
 
 #endif
+
+#if !defined(CN_SLOW_HASH_MULTI_INTERLEAVED)
+/* no interleaved implementation for this platform: one hash after the other */
+void cn_slow_hash_multi(const void *const *data, size_t length, size_t count, char *const *hash, int variant)
+{
+    size_t i;
+
+    for(i = 0; i < count; i++)
+        cn_slow_hash(data[i], length, hash[i], variant, 0);
+}
+#endif
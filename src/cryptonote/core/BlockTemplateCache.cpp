@@ -0,0 +1,176 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockTemplateCache.h"
+
+#include <boost/utility/value_init.hpp>
+
+#include "cryptonote/structures/array.hpp"
+
+#undef ERROR
+
+using namespace Logging;
+
+namespace cryptonote
+{
+
+namespace
+{
+
+const size_t MAX_CACHED_COINBASES = 64;
+
+std::string coinbaseKey(const account_public_address_t &address, const binary_array_t &extraNonce)
+{
+  std::string key(reinterpret_cast<const char *>(&address), sizeof(address));
+  key.append(extraNonce.begin(), extraNonce.end());
+  return key;
+}
+
+} // namespace
+
+BlockTemplateCache::BlockTemplateCache(const Currency &currency, Logging::ILogger &log) : m_currency(currency),
+                                                                                          logger(log, "BlockTemplateCache"),
+                                                                                          m_hasBase(false),
+                                                                                          m_coinbaseSize(0)
+{
+}
+
+bool BlockTemplateCache::hasBase(const hash_t &previousBlockHash, time_t now) const
+{
+  return m_hasBase && m_base.previousBlockHash == previousBlockHash && now - m_base.createdAt < LIFETIME;
+}
+
+const BlockTemplateCache::Base &BlockTemplateCache::getBase() const
+{
+  assert(m_hasBase);
+  return m_base;
+}
+
+void BlockTemplateCache::setBase(Base &&base)
+{
+  m_base = std::move(base);
+  m_hasBase = true;
+  m_coinbaseSize = 0;
+  m_coinbases.clear();
+}
+
+void BlockTemplateCache::clear()
+{
+  m_hasBase = false;
+  m_coinbaseSize = 0;
+  m_coinbases.clear();
+}
+
+bool BlockTemplateCache::makeBlock(block_t &b, const account_public_address_t &address, const binary_array_t &extraNonce, time_t now)
+{
+  assert(m_hasBase);
+
+  std::string key = coinbaseKey(address, extraNonce);
+  auto it = m_coinbases.find(key);
+  if (it == m_coinbases.end())
+  {
+    transaction_t coinbase;
+    if (!constructCoinbase(address, extraNonce, coinbase))
+    {
+      return false;
+    }
+
+    if (m_coinbases.size() >= MAX_CACHED_COINBASES)
+    {
+      m_coinbases.clear();
+    }
+
+    it = m_coinbases.emplace(std::move(key), std::move(coinbase)).first;
+  }
+
+  b = boost::value_initialized<block_t>();
+  b.majorVersion = m_base.majorVersion;
+  b.minorVersion = m_base.minorVersion;
+  b.previousBlockHash = m_base.previousBlockHash;
+  b.timestamp = now;
+  b.baseTransaction = it->second;
+  b.transactionHashes = m_base.transactionHashes;
+  return true;
+}
+
+bool BlockTemplateCache::constructCoinbase(const account_public_address_t &address, const binary_array_t &extraNonce, transaction_t &coinbase)
+{
+  const size_t txs_size = m_base.transactionsSize;
+  size_t cumulative_size;
+
+  if (m_coinbaseSize != 0)
+  {
+    cumulative_size = txs_size + m_coinbaseSize;
+  }
+  else
+  {
+    /*
+       two-phase miner transaction generation: we don't know exact block size until we prepare block, but we don't know reward until we know
+       block size, so first miner transaction generated with fake amount of money, and with phase we know think we know expected block size
+       */
+    //make blocks coin-base tx looks close to real coinbase tx to get truthful blob size
+    bool r = m_currency.constructMinerTx(m_base.height, m_base.medianSize, m_base.alreadyGeneratedCoins, txs_size, m_base.fee, address, coinbase, extraNonce, 11);
+    if (!r)
+    {
+      logger(ERROR, BRIGHT_RED) << "Failed to construct miner tx, first chance";
+      return false;
+    }
+
+    cumulative_size = txs_size + BinaryArray::size(coinbase);
+  }
+
+  for (size_t try_count = 0; try_count != 10; ++try_count)
+  {
+    bool r = m_currency.constructMinerTx(m_base.height, m_base.medianSize, m_base.alreadyGeneratedCoins, cumulative_size, m_base.fee, address, coinbase, extraNonce, 11);
+
+    if (!(r))
+    {
+      logger(ERROR, BRIGHT_RED) << "Failed to construct miner tx, second chance";
+      return false;
+    }
+    size_t coinbase_blob_size = BinaryArray::size(coinbase);
+    if (coinbase_blob_size > cumulative_size - txs_size)
+    {
+      cumulative_size = txs_size + coinbase_blob_size;
+      continue;
+    }
+
+    if (coinbase_blob_size < cumulative_size - txs_size)
+    {
+      size_t delta = cumulative_size - txs_size - coinbase_blob_size;
+      coinbase.extra.insert(coinbase.extra.end(), delta, 0);
+      //here  could be 1 byte difference, because of extra field counter is varint, and it can become from 1-byte len to 2-bytes len.
+      if (cumulative_size != txs_size + BinaryArray::size(coinbase))
+      {
+        if (!(cumulative_size + 1 == txs_size + BinaryArray::size(coinbase)))
+        {
+          logger(ERROR, BRIGHT_RED) << "unexpected case: cumulative_size=" << cumulative_size << " + 1 is not equal txs_cumulative_size=" << txs_size << " + get_object_blobsize(b.baseTransaction)=" << BinaryArray::size(coinbase);
+          return false;
+        }
+        coinbase.extra.resize(coinbase.extra.size() - 1);
+        if (cumulative_size != txs_size + BinaryArray::size(coinbase))
+        {
+          //fuck, not lucky, -1 makes varint-counter size smaller, in that case we continue to grow with cumulative_size
+          logger(TRACE, BRIGHT_RED) << "Miner tx creation have no luck with delta_extra size = " << delta << " and " << delta - 1;
+          cumulative_size += delta - 1;
+          continue;
+        }
+        logger(DEBUGGING, BRIGHT_GREEN) << "Setting extra for block: " << coinbase.extra.size() << ", try_count=" << try_count;
+      }
+    }
+    if (!(cumulative_size == txs_size + BinaryArray::size(coinbase)))
+    {
+      logger(ERROR, BRIGHT_RED) << "unexpected case: cumulative_size=" << cumulative_size << " is not equal txs_cumulative_size=" << txs_size << " + get_object_blobsize(b.baseTransaction)=" << BinaryArray::size(coinbase);
+      return false;
+    }
+
+    m_coinbaseSize = cumulative_size - txs_size;
+    return true;
+  }
+
+  logger(ERROR, BRIGHT_RED) << "Failed to create_block_template with " << 10 << " tries";
+  return false;
+}
+
+} // namespace cryptonote
@@ -0,0 +1,70 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cryptonote/types.h"
+#include "cryptonote/core/currency.h"
+#include <logging/LoggerRef.h>
+
+namespace cryptonote
+{
+
+// Keeps the part of a block template that depends only on the chain tip and the pool, so that
+// get_block_template callers polling the same tip only pay for the coinbase of their address.
+class BlockTemplateCache
+{
+public:
+  struct Base
+  {
+    hash_t previousBlockHash;
+    uint64_t poolRevision;
+    uint32_t height;
+    difficulty_t difficulty;
+    uint8_t majorVersion;
+    uint8_t minorVersion;
+    size_t medianSize;
+    uint64_t alreadyGeneratedCoins;
+    std::vector<hash_t> transactionHashes;
+    size_t transactionsSize;
+    uint64_t fee;
+    time_t createdAt;
+  };
+
+  // A template is rebuilt at least this often even if neither the tip nor the pool changed,
+  // so transactions that become ready with time are not left out for long.
+  static const time_t LIFETIME = 60;
+
+  BlockTemplateCache(const Currency &currency, Logging::ILogger &log);
+
+  // True if a base built on top of previousBlockHash is cached and is not older than LIFETIME.
+  bool hasBase(const hash_t &previousBlockHash, time_t now) const;
+  const Base &getBase() const;
+  void setBase(Base &&base);
+  void clear();
+
+  // Fills b from the cached base with a coinbase paying to address. Coinbases are kept per
+  // address and extra nonce until the base changes.
+  bool makeBlock(block_t &b, const account_public_address_t &address, const binary_array_t &extraNonce, time_t now);
+
+private:
+  bool constructCoinbase(const account_public_address_t &address, const binary_array_t &extraNonce, transaction_t &coinbase);
+
+  const Currency &m_currency;
+  Logging::LoggerRef logger;
+
+  bool m_hasBase;
+  Base m_base;
+  // Blob size of the last coinbase made for the current base, 0 if none. Coinbases for other
+  // addresses come out the same size, which lets constructCoinbase skip the size search.
+  size_t m_coinbaseSize;
+  std::unordered_map<std::string, transaction_t> m_coinbases;
+};
+
+} // namespace cryptonote
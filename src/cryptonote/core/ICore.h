@@ -65,6 +65,8 @@ public:
   virtual bool getOutByMSigGIndex(uint64_t amount, uint64_t gindex, multi_signature_output_t& out) = 0;
   virtual ICryptonoteProtocol* get_protocol() = 0;
   virtual bool handle_incoming_tx(const binary_array_t& tx_blob, tx_verification_context_t& tvc, bool keeped_by_block) = 0; //Deprecated. Should be removed with CryptoNoteProtocolHandler.
+  // Relayed transactions, their ring signatures checked on several threads before they are added to the pool one by one.
+  virtual void handleIncomingTransactions(const std::vector<binary_array_t>& txBlobs, std::vector<tx_verification_context_t>& tvcs) = 0;
   virtual std::vector<transaction_t> getPoolTransactions() = 0;
   virtual bool getPoolChanges(const hash_t& tailBlockId, const std::vector<hash_t>& knownTxsIds,
                               std::vector<transaction_t>& addedTxs, std::vector<hash_t>& deletedTxsIds) = 0;
@@ -25,6 +25,7 @@
 #include "transaction/TransactionExtra.h"
 #include "cryptonote/core/account.h"
 #include "common/os.h"
+#include "common/ScopeExit.h"
 
 using namespace Logging;
 
@@ -263,21 +264,25 @@ namespace cryptonote
 
       for (unsigned i = 0; i < nthreads; ++i) {
         threads[i] = std::async(std::launch::async, [&, i]() {
-          hash_t h;
+          // the thread ends with the search, its hashing scratchpads go with it
+          Tools::ScopeExit freeHashState([] { slow_hash_free_state(); });
 
-          block_t lb(bl); // copy to local block
-
-          for (uint32_t nonce = startNonce + i; !found; nonce += nthreads) {
-            lb.nonce = nonce;
-
-            if (!Block::getLongHash(lb, h)) {
-              return;
-            }
+          BlockHashingBlob blob;
+          if (!blob.init(bl)) {
+            return;
+          }
 
-            if (check_hash(&h, diffic)) {
-              foundNonce = nonce;
-              found = true;
-              return;
+          const uint32_t step = static_cast<uint32_t>(BlockHashingBlob::MINING_HASH_COUNT) * nthreads;
+          for (uint32_t nonce = startNonce + i; !found; nonce += step) {
+            hash_t hashes[BlockHashingBlob::MINING_HASH_COUNT];
+            blob.getLongHashes(nonce, nthreads, BlockHashingBlob::MINING_HASH_COUNT, hashes);
+
+            for (size_t k = 0; k < BlockHashingBlob::MINING_HASH_COUNT; ++k) {
+              if (check_hash(&hashes[k], diffic)) {
+                foundNonce = nonce + static_cast<uint32_t>(k) * nthreads;
+                found = true;
+                return;
+              }
             }
           }
         });
@@ -293,11 +298,15 @@ namespace cryptonote
 
       return found;
     } else {
+      BlockHashingBlob blob;
+      if (!blob.init(bl)) {
+        return false;
+      }
+
       for (; bl.nonce != std::numeric_limits<uint32_t>::max(); bl.nonce++) {
         hash_t h;
-        if (!Block::getLongHash(bl, h)) {
-          return false;
-        }
+        blob.setNonce(bl.nonce);
+        blob.getLongHash(h);
 
         if (check_hash(&h, diffic)) {
           return true;
@@ -343,6 +352,7 @@ namespace cryptonote
     difficulty_t local_diff = 0;
     uint32_t local_template_ver = 0;
     block_t b;
+    BlockHashingBlob blob;
 
     while(!m_stop)
     {
@@ -360,6 +370,12 @@ namespace cryptonote
 
         local_template_ver = m_template_no;
         nonce = m_starter_nonce + th_local_index;
+
+        if (local_template_ver && !blob.init(b)) {
+          logger(ERROR) << "Failed to get block hashing blob";
+          m_stop = true;
+          continue;
+        }
       }
 
       if(!local_template_ver)//no any set_block_template call
@@ -369,16 +385,19 @@ namespace cryptonote
         continue;
       }
 
-      b.nonce = nonce;
-      hash_t h;
-      if (!m_stop && !Block::getLongHash(b, h)) {
-        logger(ERROR) << "Failed to get block long hash";
-        m_stop = true;
+      uint32_t threadsTotal = m_threads_total;
+      hash_t hashes[BlockHashingBlob::MINING_HASH_COUNT];
+      if (!m_stop) {
+        blob.getLongHashes(nonce, threadsTotal, BlockHashingBlob::MINING_HASH_COUNT, hashes);
       }
 
-      if (!m_stop && check_hash(&h, local_diff))
+      for (size_t i = 0; i < BlockHashingBlob::MINING_HASH_COUNT && !m_stop; ++i)
       {
+        if (!check_hash(&hashes[i], local_diff))
+          continue;
+
         //we lucky!
+        b.nonce = nonce + static_cast<uint32_t>(i) * threadsTotal;
         ++m_config.current_extra_message_index;
 
         logger(INFO, GREEN) << "Found block for difficulty: " << local_diff;
@@ -389,11 +408,14 @@ namespace cryptonote
           //success update, lets update config
           binary::save(os::getCoinFile(std::string(config::get().filenames.miner)), storeToJson(m_config));
         }
+
+        break;
       }
 
-      nonce += m_threads_total;
-      ++m_hashes;
+      nonce += static_cast<uint32_t>(BlockHashingBlob::MINING_HASH_COUNT) * threadsTotal;
+      m_hashes += BlockHashingBlob::MINING_HASH_COUNT;
     }
+    slow_hash_free_state();
     logger(INFO) << "Miner thread stopped ["<< th_local_index << "]";
     return true;
   }
@@ -0,0 +1,279 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "PoolSnapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#include "cryptonote/structures/array.hpp"
+
+namespace cryptonote
+{
+
+namespace
+{
+
+// Fewer transactions than this per thread are not worth starting one for.
+const size_t MIN_TRANSACTIONS_PER_THREAD = 64;
+
+// Calls work(i) for every i below count on all cores, false if one of the calls was.
+bool forEachInParallel(size_t count, const std::function<bool(size_t)> &work)
+{
+  size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count / MIN_TRANSACTIONS_PER_THREAD));
+  std::atomic<size_t> next(0);
+  std::atomic<bool> succeeded(true);
+  auto worker = [&]() {
+    for (size_t i = next++; i < count && succeeded; i = next++)
+    {
+      if (!work(i))
+      {
+        succeeded = false;
+      }
+    }
+  };
+
+  std::vector<std::future<void>> workers;
+  for (size_t i = 1; i < threadCount; ++i)
+  {
+    workers.push_back(std::async(std::launch::async, worker));
+  }
+
+  worker();
+  for (auto &w : workers)
+  {
+    w.get();
+  }
+
+  return succeeded;
+}
+
+template <class T>
+void write(std::ostream &stream, const T &value)
+{
+  stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// Reads the file contents in place, failing on anything past the end.
+class Cursor
+{
+public:
+  Cursor(const uint8_t *begin, const uint8_t *end) : m_position(begin), m_end(end)
+  {
+  }
+
+  template <class T>
+  bool read(T &value)
+  {
+    if (static_cast<size_t>(m_end - m_position) < sizeof(value))
+    {
+      return false;
+    }
+
+    std::memcpy(&value, m_position, sizeof(value));
+    m_position += sizeof(value);
+    return true;
+  }
+
+  bool skip(uint64_t size, const uint8_t *&skipped)
+  {
+    if (static_cast<uint64_t>(m_end - m_position) < size)
+    {
+      return false;
+    }
+
+    skipped = m_position;
+    m_position += size;
+    return true;
+  }
+
+  bool atEnd() const
+  {
+    return m_position == m_end;
+  }
+
+private:
+  const uint8_t *m_position;
+  const uint8_t *m_end;
+};
+
+// BinaryArray::from without copying the blob out of the file contents first.
+bool parseTransaction(const uint8_t *blob, size_t size, transaction_t &tx)
+{
+  try
+  {
+    char *begin = reinterpret_cast<char *>(const_cast<uint8_t *>(blob));
+    membuf mem(begin, begin + size);
+    std::istream istream(&mem);
+    Reader stream(istream);
+    BinaryInputStreamSerializer serializer(stream);
+    serialize(tx, serializer);
+    return stream.endOfStream();
+  }
+  catch (std::exception &)
+  {
+    return false;
+  }
+}
+
+} // namespace
+
+const uint8_t PoolSnapshot::VERSION;
+
+bool PoolSnapshot::save(const std::string &filename, const std::vector<const transaction_details_t *> &transactions, const std::unordered_map<hash_t, uint64_t> &recentlyDeleted)
+{
+  std::vector<binary_array_t> blobs(transactions.size());
+  if (!forEachInParallel(transactions.size(), [&](size_t i) { return BinaryArray::to(transactions[i]->tx, blobs[i]); }))
+  {
+    return false;
+  }
+
+  std::string temporaryFilename = filename + ".tmp";
+  {
+    std::ofstream file(temporaryFilename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (file.fail())
+    {
+      return false;
+    }
+
+    write(file, VERSION);
+    write(file, static_cast<uint64_t>(transactions.size()));
+    for (size_t i = 0; i < transactions.size(); ++i)
+    {
+      const transaction_details_t &details = *transactions[i];
+      write(file, details.id);
+      write(file, static_cast<uint64_t>(blobs[i].size()));
+      write(file, details.fee);
+      write(file, static_cast<uint64_t>(details.receiveTime));
+      write(file, details.maxUsedBlock.height);
+      write(file, details.maxUsedBlock.id);
+      write(file, details.lastFailedBlock.height);
+      write(file, details.lastFailedBlock.id);
+      write(file, static_cast<uint8_t>(details.keptByBlock));
+      file.write(reinterpret_cast<const char *>(blobs[i].data()), blobs[i].size());
+    }
+
+    write(file, static_cast<uint64_t>(recentlyDeleted.size()));
+    for (const auto &deleted : recentlyDeleted)
+    {
+      write(file, deleted.first);
+      write(file, deleted.second);
+    }
+
+    file.close();
+    if (file.fail())
+    {
+      return false;
+    }
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::rename(temporaryFilename, filename, ec);
+  return !ec;
+}
+
+bool PoolSnapshot::load(const std::string &filename, std::vector<transaction_details_t> &transactions, std::unordered_map<hash_t, uint64_t> &recentlyDeleted)
+{
+  std::vector<uint8_t> contents;
+  {
+    std::ifstream file(filename, std::ios_base::binary | std::ios_base::in | std::ios_base::ate);
+    if (file.fail())
+    {
+      return false;
+    }
+
+    std::streamoff size = file.tellg();
+    if (size <= 0)
+    {
+      return false;
+    }
+
+    contents.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(contents.data()), size))
+    {
+      return false;
+    }
+  }
+
+  Cursor cursor(contents.data(), contents.data() + contents.size());
+  uint8_t version;
+  uint64_t count;
+  if (!cursor.read(version) || version != VERSION || !cursor.read(count))
+  {
+    return false;
+  }
+
+  std::vector<transaction_details_t> loaded;
+  std::vector<const uint8_t *> blobs;
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    transaction_details_t details;
+    uint64_t blobSize;
+    uint64_t receiveTime;
+    uint8_t keptByBlock;
+    const uint8_t *blob;
+    if (!cursor.read(details.id) ||
+        !cursor.read(blobSize) ||
+        !cursor.read(details.fee) ||
+        !cursor.read(receiveTime) ||
+        !cursor.read(details.maxUsedBlock.height) ||
+        !cursor.read(details.maxUsedBlock.id) ||
+        !cursor.read(details.lastFailedBlock.height) ||
+        !cursor.read(details.lastFailedBlock.id) ||
+        !cursor.read(keptByBlock) ||
+        !cursor.skip(blobSize, blob))
+    {
+      return false;
+    }
+
+    details.blobSize = static_cast<size_t>(blobSize);
+    details.receiveTime = static_cast<time_t>(receiveTime);
+    details.keptByBlock = keptByBlock != 0;
+    loaded.push_back(std::move(details));
+    blobs.push_back(blob);
+  }
+
+  uint64_t deletedCount;
+  if (!cursor.read(deletedCount))
+  {
+    return false;
+  }
+
+  std::unordered_map<hash_t, uint64_t> deleted;
+  for (uint64_t i = 0; i < deletedCount; ++i)
+  {
+    hash_t id;
+    uint64_t time;
+    if (!cursor.read(id) || !cursor.read(time))
+    {
+      return false;
+    }
+
+    deleted[id] = time;
+  }
+
+  if (!cursor.atEnd())
+  {
+    return false;
+  }
+
+  if (!forEachInParallel(loaded.size(), [&](size_t i) { return parseTransaction(blobs[i], loaded[i].blobSize, loaded[i].tx); }))
+  {
+    return false;
+  }
+
+  transactions.swap(loaded);
+  recentlyDeleted.swap(deleted);
+  return true;
+}
+
+} // namespace cryptonote
@@ -0,0 +1,35 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cryptonote/types.h"
+
+namespace cryptonote
+{
+
+// The memory pool as stored in txPoolFileName(): a version byte and the transaction count, then for
+// every transaction a fixed size header (id, blob size, fee, receive time, check results) followed
+// by its blob as relayed, then the recently deleted ids with their deletion times.
+//
+// Nothing about a transaction has to be computed again on load; the file is read in one go and the
+// blobs are parsed where they lie, on all cores.
+class PoolSnapshot
+{
+public:
+  static const uint8_t VERSION = 2;
+
+  // Writes to a temporary file next to filename and renames it over filename, so that a crash in the
+  // middle leaves the previous snapshot in place.
+  static bool save(const std::string &filename, const std::vector<const transaction_details_t *> &transactions, const std::unordered_map<hash_t, uint64_t> &recentlyDeleted);
+  // False if the file is missing, damaged or of another version; nothing is loaded then.
+  static bool load(const std::string &filename, std::vector<transaction_details_t> &transactions, std::unordered_map<hash_t, uint64_t> &recentlyDeleted);
+};
+
+} // namespace cryptonote
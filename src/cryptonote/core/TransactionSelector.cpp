@@ -0,0 +1,200 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TransactionSelector.h"
+
+#include <algorithm>
+
+namespace cryptonote
+{
+
+namespace
+{
+
+// The knapsack chooses among this many candidates around where the greedy fill stops, half of
+// them taken by it and half not, with sizes rounded up to at most this many slots of the room.
+const size_t KNAPSACK_CANDIDATES = 32;
+const size_t KNAPSACK_SLOTS = 1024;
+
+} // namespace
+
+TransactionSelector::TransactionSelector(const Currency &currency, size_t medianSize, size_t maxCumulativeSize, uint64_t alreadyGeneratedCoins) : m_currency(currency),
+                                                                                                                                                     m_medianSize(medianSize),
+                                                                                                                                                     m_alreadyGeneratedCoins(alreadyGeneratedCoins)
+{
+  size_t reservedSize = m_currency.minerTxBlobReservedSize();
+  m_maxSize = std::min(2 * medianSize - reservedSize, maxCumulativeSize);
+
+  size_t fullRewardSize = std::max(medianSize, m_currency.blockGrantedFullRewardZone());
+  m_freeSize = std::min(fullRewardSize > reservedSize ? fullRewardSize - reservedSize : 0, m_maxSize);
+}
+
+void TransactionSelector::select(const std::vector<Candidate> &candidates, const AddFunction &add, size_t &totalSize, uint64_t &fee) const
+{
+  std::vector<bool> added(candidates.size(), false);
+  fillFreeZone(candidates, add, added, totalSize, fee);
+  fillPenaltyZone(candidates, add, added, totalSize, fee);
+}
+
+uint64_t TransactionSelector::getRevenue(size_t totalSize, uint64_t fee) const
+{
+  if (totalSize > m_maxSize)
+  {
+    return 0;
+  }
+
+  uint64_t reward;
+  int64_t emissionChange;
+  if (!m_currency.getBlockReward(m_medianSize, totalSize + m_currency.minerTxBlobReservedSize(), m_alreadyGeneratedCoins, fee, reward, emissionChange))
+  {
+    return 0;
+  }
+
+  return reward;
+}
+
+void TransactionSelector::fillFreeZone(const std::vector<Candidate> &candidates, const AddFunction &add, std::vector<bool> &added, size_t &totalSize, uint64_t &fee) const
+{
+  // where a greedy fill by fee per byte would stop ...
+  size_t end = 0;
+  for (size_t size = totalSize; end < candidates.size() && size + candidates[end].blobSize <= m_freeSize; ++end)
+  {
+    size += candidates[end].blobSize;
+  }
+
+  // ... take all but its last few ...
+  size_t tail = end == candidates.size() ? end : end - std::min(end, KNAPSACK_CANDIDATES / 2);
+  for (size_t i = 0; i < tail; ++i)
+  {
+    if (add(i))
+    {
+      added[i] = true;
+      totalSize += candidates[i].blobSize;
+      fee += candidates[i].fee;
+    }
+  }
+
+  // ... choose again among those and the ones after them ...
+  if (tail < candidates.size())
+  {
+    packFreeZone(candidates, tail, add, added, totalSize, fee);
+  }
+
+  // ... and add whatever is still small enough
+  for (size_t i = tail; i < candidates.size(); ++i)
+  {
+    if (!added[i] && totalSize + candidates[i].blobSize <= m_freeSize && add(i))
+    {
+      added[i] = true;
+      totalSize += candidates[i].blobSize;
+      fee += candidates[i].fee;
+    }
+  }
+}
+
+void TransactionSelector::packFreeZone(const std::vector<Candidate> &candidates, size_t first, const AddFunction &add, std::vector<bool> &added, size_t &totalSize, uint64_t &fee) const
+{
+  size_t room = m_freeSize - totalSize;
+  if (room == 0)
+  {
+    return;
+  }
+
+  std::vector<size_t> items;
+  for (size_t i = first; i < candidates.size() && items.size() < KNAPSACK_CANDIDATES; ++i)
+  {
+    if (candidates[i].fee != 0 && candidates[i].blobSize <= room)
+    {
+      items.push_back(i);
+    }
+  }
+
+  // what the greedy fill would take, in case rounding makes the knapsack do worse
+  std::vector<size_t> greedy;
+  uint64_t greedyFee = 0;
+  size_t greedySize = 0;
+  for (size_t i : items)
+  {
+    if (greedySize + candidates[i].blobSize <= room)
+    {
+      greedy.push_back(i);
+      greedySize += candidates[i].blobSize;
+      greedyFee += candidates[i].fee;
+    }
+  }
+
+  // sizes are rounded up to slots, so whatever is picked does fit
+  size_t slotSize = (room + KNAPSACK_SLOTS - 1) / KNAPSACK_SLOTS;
+  size_t capacity = room / slotSize;
+
+  std::vector<uint64_t> best(capacity + 1, 0);
+  std::vector<std::vector<bool>> taken(items.size(), std::vector<bool>(capacity + 1, false));
+  for (size_t k = 0; k < items.size(); ++k)
+  {
+    const Candidate &candidate = candidates[items[k]];
+    size_t weight = (candidate.blobSize + slotSize - 1) / slotSize;
+    for (size_t c = capacity; c >= weight && c > 0; --c)
+    {
+      if (best[c - weight] + candidate.fee > best[c])
+      {
+        best[c] = best[c - weight] + candidate.fee;
+        taken[k][c] = true;
+      }
+    }
+  }
+
+  std::vector<size_t> picked;
+  if (best[capacity] > greedyFee)
+  {
+    size_t c = capacity;
+    for (size_t k = items.size(); k > 0; --k)
+    {
+      if (taken[k - 1][c])
+      {
+        picked.push_back(items[k - 1]);
+        c -= (candidates[items[k - 1]].blobSize + slotSize - 1) / slotSize;
+      }
+    }
+
+    std::reverse(picked.begin(), picked.end());
+  }
+  else
+  {
+    picked.swap(greedy);
+  }
+
+  for (size_t i : picked)
+  {
+    if (add(i))
+    {
+      added[i] = true;
+      totalSize += candidates[i].blobSize;
+      fee += candidates[i].fee;
+    }
+  }
+}
+
+void TransactionSelector::fillPenaltyZone(const std::vector<Candidate> &candidates, const AddFunction &add, std::vector<bool> &added, size_t &totalSize, uint64_t &fee) const
+{
+  uint64_t revenue = getRevenue(totalSize, fee);
+  for (size_t i = 0; i < candidates.size(); ++i)
+  {
+    const Candidate &candidate = candidates[i];
+    if (added[i] || candidate.fee == 0 || totalSize + candidate.blobSize > m_maxSize)
+    {
+      continue;
+    }
+
+    uint64_t newRevenue = getRevenue(totalSize + candidate.blobSize, fee + candidate.fee);
+    if (newRevenue > revenue && add(i))
+    {
+      added[i] = true;
+      totalSize += candidate.blobSize;
+      fee += candidate.fee;
+      revenue = newRevenue;
+    }
+  }
+}
+
+} // namespace cryptonote
@@ -0,0 +1,60 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "cryptonote/core/currency.h"
+
+namespace cryptonote
+{
+
+// Picks the transactions of a block template so that the miner gets the most out of the block:
+// block reward plus fees, both cut by the penalty for going over the median size.
+//
+// Up to the full reward zone a block costs nothing, so it is filled by fee per byte, except that
+// the last few transactions a greedy fill would take are chosen again by a small knapsack. Past
+// the zone every byte is penalized; a transaction goes in only if the penalized reward grows.
+class TransactionSelector
+{
+public:
+  struct Candidate
+  {
+    size_t blobSize;
+    uint64_t fee;
+  };
+
+  // Tries to put candidate index into the template, false if it conflicts with what is there.
+  typedef std::function<bool(size_t index)> AddFunction;
+
+  TransactionSelector(const Currency &currency, size_t medianSize, size_t maxCumulativeSize, uint64_t alreadyGeneratedCoins);
+
+  // Candidates go best fee per byte first. totalSize and fee hold what the template already has
+  // (fusion transactions, say) and are increased by what gets added.
+  void select(const std::vector<Candidate> &candidates, const AddFunction &add, size_t &totalSize, uint64_t &fee) const;
+
+  // Reward for a block with transactions of the given size and fee, 0 if the block is too big.
+  uint64_t getRevenue(size_t totalSize, uint64_t fee) const;
+
+  // Transactions size that is not penalized.
+  size_t getFreeSize() const { return m_freeSize; }
+  // Transactions size no template goes over.
+  size_t getMaxSize() const { return m_maxSize; }
+
+private:
+  void fillFreeZone(const std::vector<Candidate> &candidates, const AddFunction &add, std::vector<bool> &added, size_t &totalSize, uint64_t &fee) const;
+  void packFreeZone(const std::vector<Candidate> &candidates, size_t first, const AddFunction &add, std::vector<bool> &added, size_t &totalSize, uint64_t &fee) const;
+  void fillPenaltyZone(const std::vector<Candidate> &candidates, const AddFunction &add, std::vector<bool> &added, size_t &totalSize, uint64_t &fee) const;
+
+  const Currency &m_currency;
+  size_t m_medianSize;
+  uint64_t m_alreadyGeneratedCoins;
+  size_t m_freeSize;
+  size_t m_maxSize;
+};
+
+} // namespace cryptonote
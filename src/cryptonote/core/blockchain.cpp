@@ -10,7 +10,6 @@
 #include <boost/foreach.hpp>
 #include "common/math.hpp"
 #include "common/str.h"
-#include "common/ShuffleGenerator.h"
 #include "stream/persistence.h"
 #include "rpc/CoreRpcServerCommandsDefinitions.h"
 #include "CryptoNoteTools.h"
@@ -37,6 +36,7 @@ m_tx_pool(tx_pool),
 m_current_block_cumul_sz_limit(0),
 m_is_in_checkpoint_zone(false),
 m_blocks(currency),
+m_difficultyWindow(currency.difficultyWindow(), currency.difficultyLag(), currency.timestampCheckWindow()),
 m_checkpoints(logger) {
 
   m_outputs.set_deleted_key(0);
@@ -146,6 +146,7 @@ bool Blockchain::init(bool load_existing) {
     loadBlockchainIndices();
   } else {
     m_blocks.clear();
+    m_difficultyWindow.clear();
   }
 
   if (m_blocks.empty()) {
@@ -188,6 +189,8 @@ void Blockchain::rebuildCache() {
   m_transactionMap.clear();
   m_spent_keys.clear();
   m_outputs.clear();
+  m_randomOutputIndex.clear();
+  m_difficultyWindow.clear();
   m_multisignatureOutputs.clear();
   for (uint32_t b = 0; b < m_blocks.size(); ++b) {
     if (b % 1000 == 0) {
@@ -261,6 +264,8 @@ bool Blockchain::resetAndSetGenesisBlock(const block_t& b) {
   m_spent_keys.clear();
   m_alternative_chains.clear();
   m_outputs.clear();
+  m_randomOutputIndex.clear();
+  m_difficultyWindow.clear();
 
   m_paymentIdIndex.clear();
   m_timestampIndex.clear();
@@ -361,19 +366,27 @@ bool Blockchain::getBlockHeight(const hash_t& blockId, uint32_t& blockHeight) {
 
 difficulty_t Blockchain::getDifficultyForNextBlock() {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-  std::vector<uint64_t> timestamps;
-  std::vector<difficulty_t> commulative_difficulties;
-  size_t offset = m_blocks.size() - std::min(m_blocks.size(), static_cast<uint64_t>(m_currency.difficultyBlocksCount()));
-  if (offset == 0) {
-    ++offset;
+  syncDifficultyWindow();
+  return m_currency.nextDifficultySorted(m_difficultyWindow.getDifficultyTimestamps(), m_difficultyWindow.getCumulativeDifficulties());
+}
+
+// The difficulty window follows pushBlock and popBlock; it is refilled from the blocks only
+// after the cache was rebuilt or a reorg popped more blocks than it keeps.
+void Blockchain::syncDifficultyWindow() {
+  if (m_difficultyWindow.height() == m_blocks.size() && m_difficultyWindow.isComplete()) {
+    return;
   }
 
-  for (; offset < m_blocks.size(); offset++) {
-    timestamps.push_back(m_blocks[offset].bl.timestamp);
-    commulative_difficulties.push_back(m_blocks[offset].cumulative_difficulty);
+  uint32_t height = static_cast<uint32_t>(m_blocks.size());
+  uint32_t count = static_cast<uint32_t>(std::min<size_t>(height,
+    std::max(m_currency.difficultyBlocksCount(), m_currency.timestampCheckWindow())));
+
+  m_difficultyWindow.reset(height - count);
+  for (uint32_t i = height - count; i < height; ++i) {
+    m_difficultyWindow.push({ m_blocks[i].bl.timestamp, m_blocks[i].cumulative_difficulty });
   }
 
-  return m_currency.nextDifficulty(timestamps, commulative_difficulties);
+  assert(m_difficultyWindow.isComplete());
 }
 
 uint64_t Blockchain::getCoinsInCirculation() {
@@ -880,45 +893,44 @@ uint32_t Blockchain::getAlternativeBlocksCount() {
   return static_cast<uint32_t>(m_alternative_chains.size());
 }
 
-bool Blockchain::add_out_to_get_random_outs(std::vector<std::pair<transaction_index_t, uint16_t>>& amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount& result_outs, uint64_t amount, size_t i) {
+size_t Blockchain::find_end_of_allowed_index(uint64_t amount) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-  const transaction_t& tx = transactionByIndex(amount_outs[i].first).tx;
-  if (!(tx.outputs.size() > amount_outs[i].second)) {
-    logger(ERROR, BRIGHT_RED) << "internal error: in global outs index, transaction out index="
-      << amount_outs[i].second << " more than transaction outputs = " << tx.outputs.size() << ", for tx id = " << BinaryArray::objectHash(tx); return false;
+  if (getHeight() < m_currency.minedMoneyUnlockWindow()) {
+    return 0;
   }
-  if (!(tx.outputs[amount_outs[i].second].target.type() == typeid(key_output_t))) { logger(ERROR, BRIGHT_RED) << "unknown tx out type"; return false; }
-
-  //check if transaction is unlocked
-  if (!is_tx_spendtime_unlocked(tx.unlockTime))
-    return false;
 
-  COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry& oen = *result_outs.outs.insert(result_outs.outs.end(), COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry());
-  oen.global_amount_index = static_cast<uint32_t>(i);
-  oen.out_key = boost::get<key_output_t>(tx.outputs[amount_outs[i].second].target).key;
-  return true;
+  return m_randomOutputIndex.countUpTo(amount, getHeight() - static_cast<uint32_t>(m_currency.minedMoneyUnlockWindow()));
 }
 
-size_t Blockchain::find_end_of_allowed_index(const std::vector<std::pair<transaction_index_t, uint16_t>>& amount_outs) {
+// The random output index is filled lazily: outputs pushed before an amount was first requested
+// are read from their transactions once, later ones are appended by pushTransaction.
+bool Blockchain::syncRandomOutputIndex(uint64_t amount, const std::vector<std::pair<transaction_index_t, uint16_t>>& amount_outs) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
-  if (amount_outs.empty()) {
-    return 0;
-  }
+  for (size_t i = m_randomOutputIndex.size(amount); i < amount_outs.size(); ++i) {
+    const transaction_t& tx = transactionByIndex(amount_outs[i].first).tx;
+    if (!(tx.outputs.size() > amount_outs[i].second)) {
+      logger(ERROR, BRIGHT_RED) << "internal error: in global outs index, transaction out index="
+        << amount_outs[i].second << " more than transaction outputs = " << tx.outputs.size() << ", for tx id = " << BinaryArray::objectHash(tx);
+      return false;
+    }
 
-  size_t i = amount_outs.size();
-  do {
-    --i;
-    if (amount_outs[i].first.block + m_currency.minedMoneyUnlockWindow() <= getHeight()) {
-      return i + 1;
+    const transaction_output_t& output = tx.outputs[amount_outs[i].second];
+    if (!(output.target.type() == typeid(key_output_t))) {
+      logger(ERROR, BRIGHT_RED) << "unknown tx out type";
+      return false;
     }
-  } while (i != 0);
 
-  return 0;
+    m_randomOutputIndex.push(amount, random_output_entry_t{ boost::get<key_output_t>(output.target).key, tx.unlockTime, amount_outs[i].first.block });
+  }
+
+  return true;
 }
 
 bool Blockchain::getRandomOutsByAmount(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
+  auto isUnlocked = [this](uint64_t unlockTime) { return is_tx_spendtime_unlocked(unlockTime); };
+
   for (uint64_t amount : req.amounts) {
     COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount& result_outs = *res.outs.insert(res.outs.end(), COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount());
     result_outs.amount = amount;
@@ -929,17 +941,17 @@ bool Blockchain::getRandomOutsByAmount(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_
       continue;//actually this is strange situation, wallet should use some real outs when it lookup for some mix, so, at least one out for this amount should exist
     }
 
-    std::vector<std::pair<transaction_index_t, uint16_t>>& amount_outs = it->second;
+    if (!syncRandomOutputIndex(amount, it->second)) {
+      return false;
+    }
+
     //it is not good idea to use top fresh outs, because it increases possibility of transaction canceling on split
     //lets find upper bound of not fresh outs
-    size_t up_index_limit = find_end_of_allowed_index(amount_outs);
-    if (!(up_index_limit <= amount_outs.size())) { logger(ERROR, BRIGHT_RED) << "internal error: find_end_of_allowed_index returned wrong index=" << up_index_limit << ", with amount_outs.size = " << amount_outs.size(); return false; }
-
-    if (up_index_limit > 0) {
-      ShuffleGenerator<size_t, crypto::random_engine<size_t>> generator(up_index_limit);
-      for (uint64_t j = 0; j < up_index_limit && result_outs.outs.size() < req.outs_count; ++j) {
-        add_out_to_get_random_outs(amount_outs, result_outs, amount, generator());
-      }
+    size_t up_index_limit = find_end_of_allowed_index(amount);
+    for (uint32_t i : m_randomOutputIndex.pickRandom(amount, up_index_limit, req.outs_count, isUnlocked)) {
+      COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry& oen = *result_outs.outs.insert(result_outs.outs.end(), COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry());
+      oen.global_amount_index = i;
+      oen.out_key = m_randomOutputIndex.get(amount, i).key;
     }
   }
   return true;
@@ -1103,6 +1115,81 @@ bool Blockchain::checkTransactionInputs(const transaction_t& tx, uint32_t& max_u
   return true;
 }
 
+bool Blockchain::getTransactionRings(const transaction_t& tx, transaction_rings_t& rings) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+
+  struct outputs_visitor {
+    std::vector<public_key_t>& m_keys;
+    Blockchain& m_bch;
+
+    bool handle_output(const transaction_t& tx, const transaction_output_t& out, size_t transactionOutputIndex) {
+      if (!m_bch.is_tx_spendtime_unlocked(tx.unlockTime) || out.target.type() != typeid(key_output_t)) {
+        return false;
+      }
+
+      m_keys.push_back(boost::get<key_output_t>(out.target).key);
+      return true;
+    }
+  };
+
+  if (tx.signatures.size() != tx.inputs.size()) {
+    return false;
+  }
+
+  uint32_t maxUsedHeight = 0;
+  rings.keys.clear();
+  rings.keys.reserve(tx.inputs.size());
+  for (size_t i = 0; i < tx.inputs.size(); ++i) {
+    if (tx.inputs[i].type() != typeid(key_input_t)) {
+      return false;
+    }
+
+    const key_input_t& in = boost::get<key_input_t>(tx.inputs[i]);
+    if (in.outputIndexes.empty() || have_tx_keyimg_as_spent(in.keyImage)) {
+      return false;
+    }
+
+    rings.keys.emplace_back();
+    outputs_visitor vi{ rings.keys.back(), *this };
+    if (!scanOutputKeysForIndexes(in, vi, &maxUsedHeight) || rings.keys.back().size() != in.outputIndexes.size() ||
+        tx.signatures[i].size() != in.outputIndexes.size()) {
+      return false;
+    }
+  }
+
+  if (!(maxUsedHeight < m_blocks.size())) {
+    return false;
+  }
+
+  rings.prefixHash = BinaryArray::objectHash(*static_cast<const transaction_prefix_t*>(&tx));
+  rings.maxUsedBlock.height = maxUsedHeight;
+  Block::getHash(m_blocks[maxUsedHeight].bl, rings.maxUsedBlock.id);
+  rings.checkSignatures = !m_is_in_checkpoint_zone;
+  return true;
+}
+
+bool Blockchain::checkRingSignatures(const transaction_t& tx, const transaction_rings_t& rings) {
+  if (!rings.checkSignatures) {
+    return true;
+  }
+
+  std::vector<const public_key_t*> keys;
+  for (size_t i = 0; i < rings.keys.size(); ++i) {
+    keys.clear();
+    for (const auto& key : rings.keys[i]) {
+      keys.push_back(&key);
+    }
+
+    const key_input_t& in = boost::get<key_input_t>(tx.inputs[i]);
+    if (!check_ring_signature((const uint8_t *)&rings.prefixHash, (const uint8_t *)&in.keyImage,
+        (const uint8_t *const *)keys.data(), keys.size(), (const uint8_t *)tx.signatures[i].data())) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool Blockchain::haveTransactionKeyImagesAsSpent(const transaction_t &tx) {
   for (const auto& in : tx.inputs) {
     if (in.type() == typeid(key_input_t)) {
@@ -1247,13 +1334,12 @@ bool Blockchain::check_block_timestamp_main(const block_t& b) {
     return false;
   }
 
-  std::vector<uint64_t> timestamps;
-  size_t offset = m_blocks.size() <= m_currency.timestampCheckWindow() ? 0 : m_blocks.size() - m_currency.timestampCheckWindow();
-  for (; offset != m_blocks.size(); ++offset) {
-    timestamps.push_back(m_blocks[offset].bl.timestamp);
+  syncDifficultyWindow();
+  if (m_difficultyWindow.getTimestampCount() < m_currency.timestampCheckWindow()) {
+    return true;
   }
 
-  return check_block_timestamp(std::move(timestamps), b);
+  return check_block_timestamp_median(m_difficultyWindow.getTimestampMedian(), b);
 }
 
 bool Blockchain::check_block_timestamp(std::vector<uint64_t> timestamps, const block_t& b) {
@@ -1261,8 +1347,10 @@ bool Blockchain::check_block_timestamp(std::vector<uint64_t> timestamps, const b
     return true;
   }
 
-  uint64_t median_ts = math::medianValue(timestamps);
+  return check_block_timestamp_median(math::medianValue(timestamps), b);
+}
 
+bool Blockchain::check_block_timestamp_median(uint64_t median_ts, const block_t& b) {
   if (b.timestamp < median_ts) {
     logger(INFO, BRIGHT_WHITE) <<
       "Timestamp of block with id: " << Block::getHash(b) << ", " << b.timestamp <<
@@ -1502,6 +1590,7 @@ bool Blockchain::pushBlock(const block_t& blockData, const std::vector<transacti
   }
 
   pushBlock(block);
+  m_tx_pool.on_blockchain_inc(m_blocks.size(), blockHash, transactions);
 
   auto block_processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - blockProcessingStart).count();
 
@@ -1526,6 +1615,10 @@ bool Blockchain::pushBlock(block_entry_t& block) {
   m_blocks.push_back(block);
   m_blockIndex.push(blockHash);
 
+  if (m_difficultyWindow.height() + 1 == m_blocks.size()) {
+    m_difficultyWindow.push({ block.bl.timestamp, block.cumulative_difficulty });
+  }
+
   m_timestampIndex.add(block.bl.timestamp, blockHash);
   m_generatedTransactionsIndex.add(block.bl);
 
@@ -1553,10 +1646,16 @@ void Blockchain::popBlock(const hash_t& blockHash) {
   m_timestampIndex.remove(m_blocks.back().bl.timestamp, blockHash);
   m_generatedTransactionsIndex.remove(m_blocks.back().bl);
 
+  if (m_difficultyWindow.height() == m_blocks.size()) {
+    m_difficultyWindow.pop();
+  }
+
   m_blocks.pop_back();
   m_blockIndex.pop();
 
   assert(m_blockIndex.size() == m_blocks.size());
+
+  m_tx_pool.on_blockchain_dec(m_blocks.size(), getTailId(), transactions);
 }
 
 bool Blockchain::pushTransaction(block_entry_t& block, const hash_t& transactionHash, transaction_index_t transactionIndex) {
@@ -1603,8 +1702,14 @@ bool Blockchain::pushTransaction(block_entry_t& block, const hash_t& transaction
   transaction.m_global_output_indexes.resize(transaction.tx.outputs.size());
   for (uint16_t output = 0; output < transaction.tx.outputs.size(); ++output) {
     if (transaction.tx.outputs[output].target.type() == typeid(key_output_t)) {
-      auto& amountOutputs = m_outputs[transaction.tx.outputs[output].amount];
+      uint64_t amount = transaction.tx.outputs[output].amount;
+      auto& amountOutputs = m_outputs[amount];
       transaction.m_global_output_indexes[output] = static_cast<uint32_t>(amountOutputs.size());
+      if (m_randomOutputIndex.size(amount) == amountOutputs.size()) {
+        m_randomOutputIndex.push(amount, random_output_entry_t{ boost::get<key_output_t>(transaction.tx.outputs[output].target).key,
+          transaction.tx.unlockTime, transactionIndex.block });
+      }
+
       amountOutputs.push_back(std::make_pair<>(transactionIndex, output));
     } else if (transaction.tx.outputs[output].target.type() == typeid(multi_signature_output_t)) {
       auto& amountOutputs = m_multisignatureOutputs[transaction.tx.outputs[output].amount];
@@ -1653,6 +1758,7 @@ void Blockchain::popTransaction(const transaction_t& transaction, const hash_t&
       }
 
       amountOutputs->second.pop_back();
+      m_randomOutputIndex.truncate(output.amount, amountOutputs->second.size());
       if (amountOutputs->second.empty()) {
         m_outputs.erase(amountOutputs);
       }
@@ -1944,6 +2050,20 @@ bool Blockchain::getBlockIdsByTimestamp(uint64_t timestampBegin, uint64_t timest
   return m_timestampIndex.find(timestampBegin, timestampEnd, blocksNumberLimit, hashes, blocksNumberWithinTimestamps);
 }
 
+bool Blockchain::getSyncSummaries(uint32_t startHeight, uint32_t count, std::vector<block_sync_summary_t>& summaries) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  if (startHeight >= m_blocks.size()) {
+    return false;
+  }
+
+  uint32_t end = static_cast<uint32_t>(std::min<uint64_t>(m_blocks.size(), static_cast<uint64_t>(startHeight) + count));
+  for (uint32_t height = startHeight; height < end; ++height) {
+    summaries.push_back(makeSyncSummary(m_blocks[height]));
+  }
+
+  return true;
+}
+
 bool Blockchain::getTransactionIdsByPaymentId(const hash_t& paymentId, std::vector<hash_t>& transactionHashes) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_paymentIdIndex.find(paymentId, transactionHashes);
@@ -40,6 +40,15 @@ namespace cryptonote {
 
   using cryptonote::block_info_t;
 
+  // The output keys each input of a transaction is signed against, copied out of the chain so that
+  // the ring signatures can be checked without holding its lock.
+  struct transaction_rings_t {
+    hash_t prefixHash;
+    std::vector<std::vector<public_key_t>> keys;
+    block_info_t maxUsedBlock;
+    bool checkSignatures;
+  };
+
   class Blockchain : public cryptonote::ITransactionValidator {
   public:
     Blockchain(const Currency& currency, TxMemoryPool& tx_pool, Logging::ILogger& logger);
@@ -74,6 +83,10 @@ namespace cryptonote {
     block_entry_t getBlock(uint32_t& height) {
       return m_blocks[height];
     }
+    // Valid until the next block is read, caller holds the blockchain lock
+    const block_entry_t& getBlockEntry(uint32_t height) {
+      return m_blocks[height];
+    }
 
     uint32_t getHeight(); //TODO rename to getCurrentBlockchainSize
     hash_t getTailId();
@@ -100,12 +113,17 @@ namespace cryptonote {
     bool getOrphanBlockIdsByHeight(uint32_t height, std::vector<hash_t>& blockHashes);
     bool getBlockIdsByTimestamp(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t blocksNumberLimit, std::vector<hash_t>& hashes, uint32_t& blocksNumberWithinTimestamps);
     bool isBlockInMainChain(const hash_t& blockId);
+    bool getSyncSummaries(uint32_t startHeight, uint32_t count, std::vector<block_sync_summary_t>& summaries);
 
     // Transaction Operations
     bool getTransactionIdsByPaymentId(const hash_t& paymentId, std::vector<hash_t>& transactionHashes);
     bool getGeneratedTransactionsNumber(uint32_t height, uint64_t& generatedTransactions);
     bool getBlockContainingTransaction(const hash_t& txId, hash_t& blockId, uint32_t& blockHeight);
     bool checkTransactionInputs(const transaction_t& tx, uint32_t& pmax_used_block_height, hash_t& max_used_block_id, block_info_t* tail = 0);
+    // Fails for anything but key inputs and for inputs the chain does not allow, leaving it to
+    // checkTransactionInputs to tell why.
+    bool getTransactionRings(const transaction_t& tx, transaction_rings_t& rings);
+    static bool checkRingSignatures(const transaction_t& tx, const transaction_rings_t& rings);
     bool getTransactionOutputGlobalIndexes(const hash_t& tx_id, std::vector<uint32_t>& indexs);
     size_t getTotalTransactions();
     bool haveTransaction(const hash_t &id);
@@ -214,6 +232,8 @@ namespace cryptonote {
     TimestampBlocksIndex m_timestampIndex;
     GeneratedTransactionsIndex m_generatedTransactionsIndex;
     OrphanBlocksIndex m_orthanBlocksIndex;
+    RandomOutputIndex m_randomOutputIndex;
+    DifficultyWindow m_difficultyWindow;
 
     IntrusiveLinkedList<MessageQueue<BlockchainMessage>> m_messageQueueList;
 
@@ -229,6 +249,8 @@ namespace cryptonote {
     bool is_tx_spendtime_unlocked(uint64_t unlock_time);
     bool check_block_timestamp_main(const block_t& b);
     bool check_block_timestamp(std::vector<uint64_t> timestamps, const block_t& b);
+    bool check_block_timestamp_median(uint64_t median_ts, const block_t& b);
+    void syncDifficultyWindow();
     uint64_t get_adjusted_time();
     bool complete_timestamps_vector(uint64_t start_height, std::vector<uint64_t>& timestamps);
     bool checkCumulativeBlockSize(const hash_t& blockId, size_t cumulativeBlockSize, uint64_t height);
@@ -246,9 +268,9 @@ namespace cryptonote {
     bool loadBlockchainIndices();
 
     // Transactions
-    size_t find_end_of_allowed_index(const std::vector<std::pair<transaction_index_t, uint16_t>>& amount_outs);
+    size_t find_end_of_allowed_index(uint64_t amount);
+    bool syncRandomOutputIndex(uint64_t amount, const std::vector<std::pair<transaction_index_t, uint16_t>>& amount_outs);
     bool validateInput(const multi_signature_input_t& input, const hash_t& transactionHash, const hash_t& transactionPrefixHash, const std::vector<signature_t>& transactionSignatures);
-    bool add_out_to_get_random_outs(std::vector<std::pair<transaction_index_t, uint16_t>>& amount_outs, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS_outs_for_amount& result_outs, uint64_t amount, size_t i);
     bool prevalidate_miner_transaction(const block_t& b, uint32_t height);
     bool validate_miner_transaction(const block_t& b, uint32_t height, size_t cumulativeBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee, uint64_t& reward, int64_t& emissionChange);
     const transaction_entry_t& transactionByIndex(transaction_index_t index);
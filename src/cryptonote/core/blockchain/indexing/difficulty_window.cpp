@@ -0,0 +1,259 @@
+#include "difficulty_window.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace cryptonote
+{
+
+namespace
+{
+  // blocks kept below what the window needs, so that short reorgs don't force a refill
+  const size_t POP_SLACK = 64;
+}
+
+DifficultyWindow::SortedRange::SortedRange() : begin(0), end(0)
+{
+}
+
+void DifficultyWindow::SortedRange::moveTo(const DifficultyWindow &window, uint32_t newBegin, uint32_t newEnd)
+{
+  if (newBegin >= newEnd)
+  {
+    sorted.clear();
+  }
+  else if (begin >= end || newBegin >= end || newEnd <= begin)
+  {
+    sorted.clear();
+    for (uint32_t height = newBegin; height < newEnd; ++height)
+    {
+      sorted.push_back(window.at(height).timestamp);
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+  }
+  else
+  {
+    for (uint32_t height = begin; height < newBegin; ++height)
+    {
+      remove(window.at(height).timestamp);
+    }
+
+    for (uint32_t height = newBegin; height < begin; ++height)
+    {
+      add(window.at(height).timestamp);
+    }
+
+    for (uint32_t height = newEnd; height < end; ++height)
+    {
+      remove(window.at(height).timestamp);
+    }
+
+    for (uint32_t height = end; height < newEnd; ++height)
+    {
+      add(window.at(height).timestamp);
+    }
+  }
+
+  begin = newBegin;
+  end = newEnd;
+}
+
+void DifficultyWindow::SortedRange::clear()
+{
+  begin = 0;
+  end = 0;
+  sorted.clear();
+}
+
+void DifficultyWindow::SortedRange::add(uint64_t timestamp)
+{
+  sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), timestamp), timestamp);
+}
+
+void DifficultyWindow::SortedRange::remove(uint64_t timestamp)
+{
+  auto it = std::lower_bound(sorted.begin(), sorted.end(), timestamp);
+  assert(it != sorted.end() && *it == timestamp);
+  sorted.erase(it);
+}
+
+DifficultyWindow::DifficultyWindow(size_t difficultyWindow, size_t difficultyLag, size_t timestampCheckWindow) : m_difficultyWindow(difficultyWindow),
+                                                                                                                  m_difficultyLag(difficultyLag),
+                                                                                                                  m_timestampCheckWindow(timestampCheckWindow),
+                                                                                                                  m_capacity(std::max(difficultyWindow + difficultyLag, timestampCheckWindow) + POP_SLACK),
+                                                                                                                  m_first(0),
+                                                                                                                  m_height(0),
+                                                                                                                  m_complete(true)
+{
+}
+
+void DifficultyWindow::push(const difficulty_window_entry_t &entry)
+{
+  m_entries.push_back(entry);
+  ++m_height;
+  updateRanges();
+  trim();
+}
+
+void DifficultyWindow::pop()
+{
+  assert(m_height > 0);
+  if (m_entries.empty())
+  {
+    reset(m_height - 1);
+    return;
+  }
+
+  // the popped entry stays until the ranges have let go of it
+  --m_height;
+  updateRanges();
+  m_entries.pop_back();
+}
+
+void DifficultyWindow::reset(uint32_t height)
+{
+  m_entries.clear();
+  m_first = height;
+  m_height = height;
+  updateRanges();
+}
+
+void DifficultyWindow::clear()
+{
+  reset(0);
+}
+
+uint32_t DifficultyWindow::height() const
+{
+  return m_height;
+}
+
+bool DifficultyWindow::isComplete() const
+{
+  return m_complete;
+}
+
+const std::vector<uint64_t> &DifficultyWindow::getDifficultyTimestamps() const
+{
+  assert(m_complete);
+  return m_difficultyTimestamps.get();
+}
+
+std::vector<difficulty_t> DifficultyWindow::getCumulativeDifficulties() const
+{
+  assert(m_complete);
+  std::vector<difficulty_t> difficulties;
+  difficulties.reserve(m_difficultyTimestamps.getEnd() - m_difficultyTimestamps.getBegin());
+  for (uint32_t height = m_difficultyTimestamps.getBegin(); height < m_difficultyTimestamps.getEnd(); ++height)
+  {
+    difficulties.push_back(at(height).cumulativeDifficulty);
+  }
+
+  return difficulties;
+}
+
+size_t DifficultyWindow::getTimestampCount() const
+{
+  assert(m_complete);
+  return m_checkTimestamps.get().size();
+}
+
+uint64_t DifficultyWindow::getTimestampMedian() const
+{
+  assert(m_complete);
+  const std::vector<uint64_t> &timestamps = m_checkTimestamps.get();
+  if (timestamps.empty())
+  {
+    return 0;
+  }
+
+  size_t n = timestamps.size() / 2;
+  if (timestamps.size() % 2)
+  {
+    return timestamps[n];
+  }
+
+  return (timestamps[n - 1] + timestamps[n]) / 2;
+}
+
+const difficulty_window_entry_t &DifficultyWindow::at(uint32_t height) const
+{
+  assert(height >= m_first && height - m_first < m_entries.size());
+  return m_entries[height - m_first];
+}
+
+uint32_t DifficultyWindow::requiredBegin() const
+{
+  uint32_t required = m_height;
+
+  uint32_t begin;
+  uint32_t end;
+  getDifficultyRange(begin, end);
+  if (begin < end)
+  {
+    required = std::min(required, begin);
+  }
+
+  getTimestampRange(begin, end);
+  if (begin < end)
+  {
+    required = std::min(required, begin);
+  }
+
+  return required;
+}
+
+// the blocks Blockchain::getDifficultyForNextBlock hands to next_difficulty: the last
+// difficultyBlocksCount ones without the genesis, of which only the first difficultyWindow are used
+void DifficultyWindow::getDifficultyRange(uint32_t &begin, uint32_t &end) const
+{
+  size_t offset = m_height - std::min<size_t>(m_height, m_difficultyWindow + m_difficultyLag);
+  if (offset == 0)
+  {
+    ++offset;
+  }
+
+  size_t length = m_height > offset ? m_height - offset : 0;
+  begin = static_cast<uint32_t>(offset);
+  end = static_cast<uint32_t>(offset + std::min(length, m_difficultyWindow));
+}
+
+void DifficultyWindow::getTimestampRange(uint32_t &begin, uint32_t &end) const
+{
+  begin = static_cast<uint32_t>(m_height - std::min<size_t>(m_height, m_timestampCheckWindow));
+  end = m_height;
+}
+
+void DifficultyWindow::updateRanges()
+{
+  if (m_first > requiredBegin())
+  {
+    m_complete = false;
+    m_difficultyTimestamps.clear();
+    m_checkTimestamps.clear();
+    return;
+  }
+
+  m_complete = true;
+
+  uint32_t begin;
+  uint32_t end;
+  getDifficultyRange(begin, end);
+  m_difficultyTimestamps.moveTo(*this, begin, end);
+
+  getTimestampRange(begin, end);
+  m_checkTimestamps.moveTo(*this, begin, end);
+}
+
+void DifficultyWindow::trim()
+{
+  uint32_t required = requiredBegin();
+  while (m_entries.size() > m_capacity && m_first < required)
+  {
+    m_entries.pop_front();
+    ++m_first;
+  }
+}
+
+} // namespace cryptonote
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "cryptonote/core/key.h"
+
+namespace cryptonote
+{
+
+  struct difficulty_window_entry_t
+  {
+    uint64_t timestamp;
+    difficulty_t cumulativeDifficulty;
+  };
+
+  // Timestamps and cumulative difficulties of the last blocks of the main chain, enough to compute
+  // the next difficulty and the timestamp median without reading blocks. The timestamps both use
+  // are kept sorted as blocks are pushed and popped. Popping more blocks than the slack it keeps
+  // leaves the window incomplete; the owner then refills it from the chain.
+  class DifficultyWindow
+  {
+  public:
+    DifficultyWindow(size_t difficultyWindow, size_t difficultyLag, size_t timestampCheckWindow);
+
+    // entry of the block at height()
+    void push(const difficulty_window_entry_t &entry);
+    void pop();
+    // empty window for a chain whose next block is at height
+    void reset(uint32_t height);
+    void clear();
+
+    // number of chain blocks the window follows
+    uint32_t height() const;
+    bool isComplete() const;
+
+    // next_difficulty inputs: the timestamps sorted, the cumulative difficulties in chain order
+    const std::vector<uint64_t> &getDifficultyTimestamps() const;
+    std::vector<difficulty_t> getCumulativeDifficulties() const;
+
+    // number and median of the last timestampCheckWindow timestamps
+    size_t getTimestampCount() const;
+    uint64_t getTimestampMedian() const;
+
+  private:
+    class SortedRange
+    {
+    public:
+      SortedRange();
+
+      // keeps timestamps of blocks [begin, end) sorted, adding and removing only what changed
+      void moveTo(const DifficultyWindow &window, uint32_t begin, uint32_t end);
+      void clear();
+      const std::vector<uint64_t> &get() const { return sorted; }
+      uint32_t getBegin() const { return begin; }
+      uint32_t getEnd() const { return end; }
+
+    private:
+      void add(uint64_t timestamp);
+      void remove(uint64_t timestamp);
+
+      uint32_t begin;
+      uint32_t end;
+      std::vector<uint64_t> sorted;
+    };
+
+    const difficulty_window_entry_t &at(uint32_t height) const;
+    uint32_t requiredBegin() const;
+    void getDifficultyRange(uint32_t &begin, uint32_t &end) const;
+    void getTimestampRange(uint32_t &begin, uint32_t &end) const;
+    void updateRanges();
+    void trim();
+
+    const size_t m_difficultyWindow;
+    const size_t m_difficultyLag;
+    const size_t m_timestampCheckWindow;
+    const size_t m_capacity;
+
+    uint32_t m_first;
+    uint32_t m_height;
+    std::deque<difficulty_window_entry_t> m_entries;
+    bool m_complete;
+    SortedRange m_difficultyTimestamps;
+    SortedRange m_checkTimestamps;
+  };
+
+} // namespace cryptonote
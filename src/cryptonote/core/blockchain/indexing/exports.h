@@ -4,3 +4,6 @@
 #include "timestamp_transaction.h"
 #include "generated_transaction.h"
 #include "orphan_block.h"
+#include "sync_summary.h"
+#include "random_output.h"
+#include "difficulty_window.h"
@@ -5,9 +5,13 @@
 namespace cryptonote
 {
   bool PaymentIdIndex::add(const transaction_t &transaction)
+  {
+    return add(transaction, BinaryArray::objectHash(transaction));
+  }
+
+  bool PaymentIdIndex::add(const transaction_t &transaction, const hash_t &transactionHash)
   {
     hash_t paymentId;
-    hash_t transactionHash = BinaryArray::objectHash(transaction);
     if (!BlockchainExplorerDataBuilder::getPaymentId(transaction, paymentId))
     {
       return false;
@@ -19,9 +23,13 @@ namespace cryptonote
   }
 
   bool PaymentIdIndex::remove(const transaction_t &transaction)
+  {
+    return remove(transaction, BinaryArray::objectHash(transaction));
+  }
+
+  bool PaymentIdIndex::remove(const transaction_t &transaction, const hash_t &transactionHash)
   {
     hash_t paymentId;
-    hash_t transactionHash = BinaryArray::objectHash(transaction);
     if (!BlockchainExplorerDataBuilder::getPaymentId(transaction, paymentId))
     {
       return false;
@@ -17,6 +17,9 @@ namespace cryptonote
 
     bool add(const transaction_t &transaction);
     bool remove(const transaction_t &transaction);
+    // For callers that already know the transaction hash, so the transaction is not serialized again.
+    bool add(const transaction_t &transaction, const hash_t &transactionHash);
+    bool remove(const transaction_t &transaction, const hash_t &transactionHash);
     bool find(const hash_t &paymentId, std::vector<hash_t> &transactionHashes);
     void clear();
 
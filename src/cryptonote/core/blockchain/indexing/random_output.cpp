@@ -0,0 +1,95 @@
+#include "random_output.h"
+
+#include <algorithm>
+#include "common/ShuffleGenerator.h"
+#include "cryptonote/crypto/crypto.h"
+
+namespace cryptonote
+{
+
+void RandomOutputIndex::push(uint64_t amount, const random_output_entry_t &entry)
+{
+  index[amount].push_back(entry);
+}
+
+void RandomOutputIndex::truncate(uint64_t amount, size_t count)
+{
+  auto it = index.find(amount);
+  if (it == index.end() || it->second.size() <= count)
+  {
+    return;
+  }
+
+  if (count == 0)
+  {
+    index.erase(it);
+  }
+  else
+  {
+    it->second.resize(count);
+  }
+}
+
+size_t RandomOutputIndex::size(uint64_t amount) const
+{
+  auto it = index.find(amount);
+  return it == index.end() ? 0 : it->second.size();
+}
+
+const random_output_entry_t &RandomOutputIndex::get(uint64_t amount, size_t globalIndex) const
+{
+  return index.at(amount).at(globalIndex);
+}
+
+size_t RandomOutputIndex::countUpTo(uint64_t amount, uint32_t maxBlock) const
+{
+  auto it = index.find(amount);
+  if (it == index.end())
+  {
+    return 0;
+  }
+
+  // outputs are appended block by block, so their blocks never decrease
+  auto end = std::upper_bound(it->second.begin(), it->second.end(), maxBlock, [](uint32_t block, const random_output_entry_t &entry) {
+    return block < entry.block;
+  });
+
+  return static_cast<size_t>(end - it->second.begin());
+}
+
+std::vector<uint32_t> RandomOutputIndex::pickRandom(uint64_t amount, size_t limit, uint64_t count, const std::function<bool(uint64_t)> &isUnlocked) const
+{
+  std::vector<uint32_t> picked;
+
+  auto it = index.find(amount);
+  if (it == index.end())
+  {
+    return picked;
+  }
+
+  const std::vector<random_output_entry_t> &outputs = it->second;
+  limit = std::min(limit, outputs.size());
+  if (limit == 0)
+  {
+    return picked;
+  }
+
+  ShuffleGenerator<size_t, crypto::random_engine<size_t>> generator(limit);
+  for (size_t j = 0; j < limit && picked.size() < count; ++j)
+  {
+    size_t i = generator();
+    if (isUnlocked(outputs[i].unlockTime))
+    {
+      picked.push_back(static_cast<uint32_t>(i));
+    }
+  }
+
+  return picked;
+}
+
+void RandomOutputIndex::clear()
+{
+  index.clear();
+}
+
+} // namespace cryptonote
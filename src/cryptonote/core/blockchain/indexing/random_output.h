@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "cryptonote/core/key.h"
+
+namespace cryptonote
+{
+
+  struct random_output_entry_t
+  {
+    public_key_t key;
+    uint64_t unlockTime;
+    uint32_t block;
+  };
+
+  // Key, unlock time and block of the key outputs of every amount, in global index order.
+  // Lets decoys be sampled without reading their transactions. An amount may hold only a
+  // prefix of its outputs, the owner extends it on demand and truncates it on pop.
+  class RandomOutputIndex
+  {
+  public:
+    RandomOutputIndex() = default;
+
+    void push(uint64_t amount, const random_output_entry_t &entry);
+    void truncate(uint64_t amount, size_t count);
+    size_t size(uint64_t amount) const;
+    const random_output_entry_t &get(uint64_t amount, size_t globalIndex) const;
+    // number of outputs of the amount created in blocks up to maxBlock
+    size_t countUpTo(uint64_t amount, uint32_t maxBlock) const;
+    // global indexes of up to count distinct random outputs among the first limit ones that pass isUnlocked
+    std::vector<uint32_t> pickRandom(uint64_t amount, size_t limit, uint64_t count, const std::function<bool(uint64_t)> &isUnlocked) const;
+    void clear();
+
+  private:
+    std::unordered_map<uint64_t, std::vector<random_output_entry_t>> index;
+  };
+
+} // namespace cryptonote
@@ -0,0 +1,59 @@
+#include "sync_summary.h"
+#include "cryptonote/core/transaction/TransactionExtra.h"
+#include "cryptonote/structures/array.hpp"
+#include "cryptonote/structures/block_entry.h"
+
+namespace cryptonote
+{
+
+namespace
+{
+
+void addTransaction(const transaction_entry_t &transaction, const hash_t &transactionHash, block_sync_summary_t &summary)
+{
+  transaction_sync_summary_t txSummary;
+
+  for (size_t i = 0; i < transaction.tx.outputs.size(); ++i)
+  {
+    const transaction_output_t &output = transaction.tx.outputs[i];
+    if (output.target.type() != typeid(key_output_t) || i >= transaction.m_global_output_indexes.size())
+    {
+      continue;
+    }
+
+    txSummary.outputIndexes.push_back(static_cast<uint16_t>(i));
+    txSummary.outputKeys.push_back(boost::get<key_output_t>(output.target).key);
+    txSummary.amounts.push_back(output.amount);
+    txSummary.globalIndexes.push_back(transaction.m_global_output_indexes[i]);
+  }
+
+  // Transactions without key outputs can't pay anybody, they aren't worth the bytes
+  if (txSummary.outputKeys.empty())
+  {
+    return;
+  }
+
+  txSummary.txHash = transactionHash;
+  txSummary.txPublicKey = getTransactionPublicKeyFromExtra(transaction.tx.extra);
+  summary.transactions.push_back(std::move(txSummary));
+}
+
+} // namespace
+
+block_sync_summary_t makeSyncSummary(const block_entry_t &block)
+{
+  block_sync_summary_t summary;
+  summary.blockHash = Block::getHash(block.bl);
+  summary.timestamp = block.bl.timestamp;
+
+  for (size_t i = 0; i < block.transactions.size(); ++i)
+  {
+    // transactions[0] is the miner transaction, the others follow block's transaction hashes
+    hash_t transactionHash = i == 0 ? BinaryArray::objectHash(block.bl.baseTransaction) : block.bl.transactionHashes[i - 1];
+    addTransaction(block.transactions[i], transactionHash, summary);
+  }
+
+  return summary;
+}
+
+} // namespace cryptonote
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "cryptonote/core/key.h"
+#include "cryptonote/protocol/definitions.h"
+#include "cryptonote/types.h"
+
+namespace cryptonote
+{
+
+  // Wallet sync summary of a main chain block. It is derived from the stored block whenever it is asked for rather than
+  // indexed, since it repeats every output key of the chain.
+  block_sync_summary_t makeSyncSummary(const block_entry_t &block);
+
+} // namespace cryptonote
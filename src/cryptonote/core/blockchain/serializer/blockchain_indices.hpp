@@ -51,7 +51,7 @@ namespace cryptonote
   Reader &operator>>(Reader &i, BlockchainIndicesSerializer &v)
   {
     config::config_t &data = config::get();
-    uint8_t version = data.storageVersions.blockcache_archive.major;
+    uint8_t version = data.storageVersions.blockcache_indices_archive.major;
     i >> version;
 
     // ignore old versions, do rebuild
@@ -75,7 +75,7 @@ namespace cryptonote
   Writer &operator<<(Writer &o, const BlockchainIndicesSerializer &v)
   {
     config::config_t &data = config::get();
-    uint8_t version = data.storageVersions.blockcache_archive.major;
+    uint8_t version = data.storageVersions.blockcache_indices_archive.major;
     o << version;
 
     // ignore old versions, do rebuild
@@ -4,7 +4,11 @@
 
 #include "core.h"
 
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <sstream>
+#include <thread>
 #include <unordered_set>
 #include "../CryptoNoteConfig.h"
 #include "../cryptonote/crypto/crypto.h"
@@ -52,11 +56,41 @@ private:
   friend class core;
 };
 
+// Releases the hashes a batch of incoming transactions has taken, also when checking or adding one throws
+class AdmissionGuard {
+public:
+  AdmissionGuard(std::mutex& lock, std::unordered_set<hash_t>& admitting) : m_lock(lock), m_admitting(admitting) {
+  }
+
+  ~AdmissionGuard() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (const auto& hash : m_hashes) {
+      m_admitting.erase(hash);
+    }
+  }
+
+  // false if another batch or an earlier transaction of this one already has the hash
+  bool take(const hash_t& hash) {
+    if (!m_admitting.insert(hash).second) {
+      return false;
+    }
+
+    m_hashes.push_back(hash);
+    return true;
+  }
+
+private:
+  std::mutex& m_lock;
+  std::unordered_set<hash_t>& m_admitting;
+  std::vector<hash_t> m_hashes;
+};
+
 core::core(const Currency& currency, ICryptonoteProtocol* pprotocol, Logging::ILogger& logger) :
 m_currency(currency),
 logger(logger, "core"),
 m_mempool(currency, m_blockchain, m_timeProvider, logger),
 m_blockchain(currency, m_mempool, logger),
+m_blockTemplateCache(currency, logger),
 m_miner(new miner(currency, *this, logger)),
 m_starter_message_showed(false) {
   set_cryptonote_protocol(pprotocol);
@@ -199,6 +233,103 @@ bool core::handle_incoming_tx(const binary_array_t& tx_blob, tx_verification_con
   return handleIncomingTransaction(tx, tx_hash, tx_blob.size(), tvc, keeped_by_block);
 }
 
+void core::handleIncomingTransactions(const std::vector<binary_array_t>& txBlobs, std::vector<tx_verification_context_t>& tvcs) {
+  struct admission_t {
+    size_t index;
+    transaction_t tx;
+    hash_t hash;
+    transaction_rings_t rings;
+    bool prepared;
+    bool signaturesValid;
+  };
+
+  tvcs.assign(txBlobs.size(), boost::value_initialized<tx_verification_context_t>());
+
+  std::vector<admission_t> admissions;
+  for (size_t i = 0; i < txBlobs.size(); ++i) {
+    if (txBlobs[i].size() > m_currency.maxTxSize()) {
+      logger(INFO) << "WRONG TRANSACTION BLOB, too big size " << txBlobs[i].size() << ", rejected";
+      tvcs[i].m_verifivation_failed = true;
+      continue;
+    }
+
+    admission_t admission;
+    hash_t prefixHash;
+    if (!parse_tx_from_blob(admission.tx, admission.hash, prefixHash, txBlobs[i])) {
+      logger(INFO) << "WRONG TRANSACTION BLOB, Failed to parse, rejected";
+      tvcs[i].m_verifivation_failed = true;
+      continue;
+    }
+
+    if (!checkIncomingTransaction(admission.tx, admission.hash, tvcs[i], false)) {
+      continue;
+    }
+
+    admission.index = i;
+    admission.prepared = false;
+    admission.signaturesValid = false;
+    admissions.push_back(std::move(admission));
+  }
+
+  // each transaction is taken once, whether it comes twice in the batch or another batch has it;
+  // the others are left as already known, so they are not relayed twice either
+  AdmissionGuard admissionGuard(m_admissionLock, m_admittingTransactions);
+  {
+    std::lock_guard<std::mutex> lock(m_admissionLock);
+    auto end = std::remove_if(admissions.begin(), admissions.end(), [&admissionGuard](const admission_t& admission) {
+      return !admissionGuard.take(admission.hash);
+    });
+
+    admissions.erase(end, admissions.end());
+  }
+
+  // the keys the signatures are checked against are copied out under the chain lock, one
+  // transaction at a time; anything unusual goes the usual way, under the locks
+  std::vector<admission_t*> checks;
+  for (auto& admission : admissions) {
+    if (!m_mempool.have_tx(admission.hash) && !m_blockchain.haveTransaction(admission.hash)) {
+      admission.prepared = m_blockchain.getTransactionRings(admission.tx, admission.rings);
+      if (admission.prepared) {
+        checks.push_back(&admission);
+      }
+    }
+  }
+
+  std::atomic<size_t> next(0);
+  auto check = [&checks, &next]() {
+    for (size_t i = next++; i < checks.size(); i = next++) {
+      checks[i]->signaturesValid = Blockchain::checkRingSignatures(checks[i]->tx, checks[i]->rings);
+    }
+  };
+
+  size_t nthreads = std::min<size_t>(std::thread::hardware_concurrency(), checks.size());
+  std::vector<std::future<void>> threads;
+  for (size_t i = 1; i < nthreads; ++i) {
+    threads.push_back(std::async(std::launch::async, check));
+  }
+
+  check();
+  for (auto& t : threads) {
+    t.wait();
+  }
+
+  // only key images are checked again under the locks, unless the chain changed under the signatures
+  for (const auto& admission : admissions) {
+    tx_verification_context_t& tvc = tvcs[admission.index];
+    size_t blobSize = txBlobs[admission.index].size();
+    if (!admission.prepared) {
+      add_new_tx(admission.tx, admission.hash, blobSize, tvc, false);
+    } else if (!admission.signaturesValid) {
+      logger(INFO) << "Failed to check ring signatures for tx " << admission.hash;
+      tvc.m_verifivation_failed = true;
+    } else {
+      add_new_tx(admission.tx, admission.hash, blobSize, tvc, false, &admission.rings.maxUsedBlock);
+    }
+
+    reportIncomingTransaction(admission.hash, tvc);
+  }
+}
+
 bool core::get_stat_info(core_state_info_t& st_inf) {
   st_inf.mining_speed = m_miner->get_speed();
   st_inf.alternative_blocks = m_blockchain.getAlternativeBlocksCount();
@@ -274,7 +405,7 @@ size_t core::get_blockchain_total_transactions() {
 //  return m_blockchain.get_outs(amount, pkeys);
 //}
 
-bool core::add_new_tx(const transaction_t& tx, const hash_t& tx_hash, size_t blob_size, tx_verification_context_t& tvc, bool keeped_by_block) {
+bool core::add_new_tx(const transaction_t& tx, const hash_t& tx_hash, size_t blob_size, tx_verification_context_t& tvc, bool keeped_by_block, const block_info_t* checkedMaxUsedBlock) {
   //Locking on m_mempool and m_blockchain closes possibility to add tx to memory pool which is already in blockchain 
   std::lock_guard<decltype(m_mempool)> lk(m_mempool);
   Locker lbs(m_blockchain.getMutex());;
@@ -289,89 +420,87 @@ bool core::add_new_tx(const transaction_t& tx, const hash_t& tx_hash, size_t blo
     return true;
   }
 
+  if (checkedMaxUsedBlock != nullptr) {
+    return m_mempool.add_tx(tx, tx_hash, blob_size, *checkedMaxUsedBlock, tvc);
+  }
+
   return m_mempool.add_tx(tx, tx_hash, blob_size, tvc, keeped_by_block);
 }
 
 bool core::get_block_template(block_t& b, const account_public_address_t& adr, difficulty_t& diffic, uint32_t& height, const binary_array_t& ex_nonce) {
-  size_t median_size;
-  uint64_t already_generated_coins;
-  config::config_t conf = config::get();
+  std::lock_guard<std::mutex> lock(m_blockTemplateLock);
+  time_t now = time(NULL);
+
+  // the pool revision is taken first: anything that changes the pool afterwards makes the cached template stale
+  uint64_t poolRevision = m_mempool.getRevision();
+  if (!m_blockTemplateCache.hasBase(get_tail_id(), now) || !patchBlockTemplate(poolRevision)) {
+    if (!buildBlockTemplate(poolRevision, now)) {
+      m_blockTemplateCache.clear();
+      return false;
+    }
+  }
+
+  const BlockTemplateCache::Base& base = m_blockTemplateCache.getBase();
+  height = base.height;
+  diffic = base.difficulty;
+  return m_blockTemplateCache.makeBlock(b, adr, ex_nonce, now);
+}
+
+bool core::buildBlockTemplate(uint64_t poolRevision, time_t now) {
+  BlockTemplateCache::Base base;
+  base.poolRevision = poolRevision;
+  base.createdAt = now;
 
   {
     Locker lbs(m_blockchain.getMutex());;
-    height = m_blockchain.getHeight();
-    diffic = m_blockchain.getDifficultyForNextBlock();
-    if (!(diffic)) {
+    base.height = m_blockchain.getHeight();
+    base.difficulty = m_blockchain.getDifficultyForNextBlock();
+    if (!(base.difficulty)) {
       logger(ERROR, BRIGHT_RED) << "difficulty overhead.";
       return false;
     }
 
-    b = boost::value_initialized<block_t>();
     const HardFork hf = HardFork(config::get().hardforks);
-    b.majorVersion = hf.getMajorVersion(height);
-    b.minorVersion = hf.getMinorVersion(height);
+    base.majorVersion = hf.getMajorVersion(base.height);
+    base.minorVersion = hf.getMinorVersion(base.height);
 
-    b.previousBlockHash = get_tail_id();
-    b.timestamp = time(NULL);
+    base.previousBlockHash = get_tail_id();
 
-    median_size = m_blockchain.getCurrentCumulativeBlocksizeLimit() / 2;
-    already_generated_coins = m_blockchain.getCoinsInCirculation();
+    base.medianSize = m_blockchain.getCurrentCumulativeBlocksizeLimit() / 2;
+    base.alreadyGeneratedCoins = m_blockchain.getCoinsInCirculation();
   }
 
-  size_t txs_size;
-  uint64_t fee;
-  if (!m_mempool.fill_block_template(b, median_size, m_currency.maxBlockCumulativeSize(height), already_generated_coins,
-    txs_size, fee)) {
+  block_t b;
+  if (!m_mempool.fill_block_template(b, base.medianSize, m_currency.maxBlockCumulativeSize(base.height), base.alreadyGeneratedCoins,
+    base.transactionsSize, base.fee)) {
     return false;
   }
 
-  /*
-     two-phase miner transaction generation: we don't know exact block size until we prepare block, but we don't know reward until we know
-     block size, so first miner transaction generated with fake amount of money, and with phase we know think we know expected block size
-     */
-  //make blocks coin-base tx looks close to real coinbase tx to get truthful blob size
-  bool r = m_currency.constructMinerTx(height, median_size, already_generated_coins, txs_size, fee, adr, b.baseTransaction, ex_nonce, 11);
-  if (!r) { 
-    logger(ERROR, BRIGHT_RED) << "Failed to construct miner tx, first chance"; 
-    return false; 
-  }
+  base.transactionHashes = std::move(b.transactionHashes);
+  m_blockTemplateCache.setBase(std::move(base));
+  return true;
+}
 
-  size_t cumulative_size = txs_size + BinaryArray::size(b.baseTransaction);
-  for (size_t try_count = 0; try_count != 10; ++try_count) {
-    r = m_currency.constructMinerTx(height, median_size, already_generated_coins, cumulative_size, fee, adr, b.baseTransaction, ex_nonce, 11);
+bool core::patchBlockTemplate(uint64_t poolRevision) {
+  const BlockTemplateCache::Base& cached = m_blockTemplateCache.getBase();
+  if (cached.poolRevision == poolRevision) {
+    return true;
+  }
 
-    if (!(r)) { logger(ERROR, BRIGHT_RED) << "Failed to construct miner tx, second chance"; return false; }
-    size_t coinbase_blob_size = BinaryArray::size(b.baseTransaction);
-    if (coinbase_blob_size > cumulative_size - txs_size) {
-      cumulative_size = txs_size + coinbase_blob_size;
-      continue;
-    }
+  std::vector<hash_t> addedIds;
+  if (!m_mempool.getAddedSince(cached.poolRevision, addedIds)) {
+    return false;
+  }
 
-    if (coinbase_blob_size < cumulative_size - txs_size) {
-      size_t delta = cumulative_size - txs_size - coinbase_blob_size;
-      b.baseTransaction.extra.insert(b.baseTransaction.extra.end(), delta, 0);
-      //here  could be 1 byte difference, because of extra field counter is varint, and it can become from 1-byte len to 2-bytes len.
-      if (cumulative_size != txs_size + BinaryArray::size(b.baseTransaction)) {
-        if (!(cumulative_size + 1 == txs_size + BinaryArray::size(b.baseTransaction))) { logger(ERROR, BRIGHT_RED) << "unexpected case: cumulative_size=" << cumulative_size << " + 1 is not equal txs_cumulative_size=" << txs_size << " + get_object_blobsize(b.baseTransaction)=" << BinaryArray::size(b.baseTransaction); return false; }
-        b.baseTransaction.extra.resize(b.baseTransaction.extra.size() - 1);
-        if (cumulative_size != txs_size + BinaryArray::size(b.baseTransaction)) {
-          //fuck, not lucky, -1 makes varint-counter size smaller, in that case we continue to grow with cumulative_size
-          logger(TRACE, BRIGHT_RED) <<
-            "Miner tx creation have no luck with delta_extra size = " << delta << " and " << delta - 1;
-          cumulative_size += delta - 1;
-          continue;
-        }
-        logger(DEBUGGING, BRIGHT_GREEN) <<
-          "Setting extra for block: " << b.baseTransaction.extra.size() << ", try_count=" << try_count;
-      }
-    }
-    if (!(cumulative_size == txs_size + BinaryArray::size(b.baseTransaction))) { logger(ERROR, BRIGHT_RED) << "unexpected case: cumulative_size=" << cumulative_size << " is not equal txs_cumulative_size=" << txs_size << " + get_object_blobsize(b.baseTransaction)=" << BinaryArray::size(b.baseTransaction); return false; }
-    return true;
+  BlockTemplateCache::Base base = cached;
+  if (!m_mempool.append_to_block_template(base.transactionHashes, addedIds, base.medianSize, m_currency.maxBlockCumulativeSize(base.height),
+    base.transactionsSize, base.fee)) {
+    return false;
   }
 
-  logger(ERROR, BRIGHT_RED) <<
-    "Failed to create_block_template with " << 10 << " tries";
-  return false;
+  base.poolRevision = poolRevision;
+  m_blockTemplateCache.setBase(std::move(base));
+  return true;
 }
 
 std::vector<hash_t> core::findBlockchainSupplement(const std::vector<hash_t>& remoteBlockIds, size_t maxCount,
@@ -463,6 +592,41 @@ void core::getPoolChanges(const std::vector<hash_t>& knownTxsIds, std::vector<tr
   assert(misses.empty());
 }
 
+bool core::getPoolChangesSince(const hash_t& tailBlockId, uint64_t knownPoolSequence, const std::vector<hash_t>& knownTxsIds,
+                               std::vector<transaction_t>& addedTxs, std::vector<hash_t>& deletedTxsIds, uint64_t& poolSequence, bool& isPoolDelta) {
+  std::vector<hash_t> addedTxsIds;
+  {
+    auto guard = m_mempool.obtainGuard();
+    isPoolDelta = knownPoolSequence != 0 && m_mempool.get_changes_since(knownPoolSequence, addedTxsIds, deletedTxsIds);
+    if (!isPoolDelta) {
+      m_mempool.get_difference(knownTxsIds, addedTxsIds, deletedTxsIds);
+    }
+
+    poolSequence = m_mempool.get_sequence();
+    std::vector<hash_t> misses;
+    m_mempool.getTransactions(addedTxsIds, addedTxs, misses);
+    assert(misses.empty());
+  }
+
+  return tailBlockId == m_blockchain.getTailId();
+}
+
+bool core::getPoolChangesLiteSince(const hash_t& tailBlockId, uint64_t knownPoolSequence, const std::vector<hash_t>& knownTxsIds,
+                                   std::vector<transaction_prefix_info_t>& addedTxs, std::vector<hash_t>& deletedTxsIds, uint64_t& poolSequence, bool& isPoolDelta) {
+  std::vector<transaction_t> added;
+  bool returnStatus = getPoolChangesSince(tailBlockId, knownPoolSequence, knownTxsIds, added, deletedTxsIds, poolSequence, isPoolDelta);
+
+  for (const auto& tx: added) {
+    transaction_prefix_info_t tpi;
+    tpi.txPrefix = tx;
+    tpi.txHash = BinaryArray::objectHash(tx);
+
+    addedTxs.push_back(std::move(tpi));
+  }
+
+  return returnStatus;
+}
+
 bool core::handle_incoming_block_blob(const binary_array_t& block_blob, block_verification_context_t& bvc, bool control_miner, bool relay_block) {
   if (block_blob.size() > m_currency.maxBlockBlobSize()) {
     logger(INFO) << "WRONG BLOCK BLOB, too big size " << block_blob.size() << ", rejected";
@@ -529,6 +693,14 @@ size_t core::get_pool_transactions_count() {
   return m_mempool.get_transactions_count();
 }
 
+size_t core::get_pool_transactions_size() {
+  return m_mempool.get_transactions_size();
+}
+
+uint64_t core::get_pool_evicted_transactions_count() {
+  return m_mempool.get_evicted_transactions_count();
+}
+
 bool core::have_block(const hash_t& id) {
   return m_blockchain.haveBlock(id);
 }
@@ -725,30 +897,53 @@ bool core::queryBlocksLite(const std::vector<hash_t>& knownBlockIds, uint64_t ti
   uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<block_short_info_t>& entries) {
   Locker lbs(m_blockchain.getMutex());;
 
-  resCurrentHeight = m_blockchain.getHeight();
-  resStartHeight = 0;
-  resFullOffset = 0;
-
-  if (!findStartAndFullOffsets(knownBlockIds, timestamp, resStartHeight, resFullOffset)) {
+  std::vector<hash_t> blockIds;
+  uint32_t blocksLeft;
+  if (!queryBlocksLiteIds(knownBlockIds, timestamp, resStartHeight, resCurrentHeight, resFullOffset, blockIds, blocksLeft)) {
     return false;
   }
 
-  std::vector<hash_t> blockIds = findIdsForShortBlocks(resStartHeight, resFullOffset);
-  entries.reserve(blockIds.size());
+  entries.reserve(blockIds.size() + blocksLeft);
 
   for (const auto& id : blockIds) {
     entries.push_back(block_short_info_t());
     entries.back().blockId = id;
   }
 
-  uint32_t blocksLeft = static_cast<uint32_t>(std::min(BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT - entries.size(), size_t(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)));
-
   if (blocksLeft == 0) {
     return true;
   }
 
+  return getShortBlocks(resFullOffset, blocksLeft, timestamp, NULL_HASH, entries);
+}
+
+bool core::queryBlocksLiteIds(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp, uint32_t& resStartHeight,
+  uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<hash_t>& blockIds, uint32_t& fullBlocksCount) {
+  Locker lbs(m_blockchain.getMutex());;
+
+  resCurrentHeight = m_blockchain.getHeight();
+  resStartHeight = 0;
+  resFullOffset = 0;
+
+  if (!findStartAndFullOffsets(knownBlockIds, timestamp, resStartHeight, resFullOffset)) {
+    return false;
+  }
+
+  blockIds = findIdsForShortBlocks(resStartHeight, resFullOffset);
+  fullBlocksCount = static_cast<uint32_t>(std::min(BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT - blockIds.size(), size_t(BLOCKS_SYNCHRONIZING_DEFAULT_COUNT)));
+
+  return true;
+}
+
+bool core::getShortBlocks(uint32_t height, uint32_t count, uint64_t timestamp, const hash_t& prevBlockId, std::vector<block_short_info_t>& entries) {
+  Locker lbs(m_blockchain.getMutex());;
+
+  if (prevBlockId != NULL_HASH && (height == 0 || m_blockchain.getBlockIdByHeight(height - 1) != prevBlockId)) {
+    return false;
+  }
+
   std::list<block_t> blocks;
-  m_blockchain.getBlocks(resFullOffset, blocksLeft, blocks);
+  m_blockchain.getBlocks(height, count, blocks);
 
   for (auto& b : blocks) {
     block_short_info_t item;
@@ -777,6 +972,26 @@ bool core::queryBlocksLite(const std::vector<hash_t>& knownBlockIds, uint64_t ti
   return true;
 }
 
+bool core::visitBlocks(uint32_t height, uint32_t count, const hash_t& prevBlockId, const std::function<void(const hash_t& blockId, const block_entry_t& entry)>& visitor) {
+  Locker lbs(m_blockchain.getMutex());
+
+  if (prevBlockId != NULL_HASH && (height == 0 || m_blockchain.getBlockIdByHeight(height - 1) != prevBlockId)) {
+    return false;
+  }
+
+  uint32_t end = std::min(height + count, m_blockchain.getHeight());
+  for (uint32_t h = height; h < end; ++h) {
+    hash_t blockId = m_blockchain.getBlockIdByHeight(h);
+    visitor(blockId, m_blockchain.getBlockEntry(h));
+  }
+
+  return true;
+}
+
+bool core::getSyncSummaries(uint32_t startHeight, uint32_t count, std::vector<block_sync_summary_t>& summaries) {
+  return m_blockchain.getSyncSummaries(startHeight, count, summaries);
+}
+
 bool core::getBackwardBlocksSizes(uint32_t fromHeight, std::vector<size_t>& sizes, size_t count) {
   return m_blockchain.getBackwardBlocksSize(fromHeight, sizes, count);
 }
@@ -918,6 +1133,16 @@ uint64_t core::getTotalGeneratedAmount() {
 }
 
 bool core::handleIncomingTransaction(const transaction_t& tx, const hash_t& txHash, size_t blobSize, tx_verification_context_t& tvc, bool keptByBlock) {
+  if (!checkIncomingTransaction(tx, txHash, tvc, keptByBlock)) {
+    return false;
+  }
+
+  bool r = add_new_tx(tx, txHash, blobSize, tvc, keptByBlock);
+  reportIncomingTransaction(txHash, tvc);
+  return r;
+}
+
+bool core::checkIncomingTransaction(const transaction_t& tx, const hash_t& txHash, tx_verification_context_t& tvc, bool keptByBlock) {
   if (!check_tx_syntax(tx)) {
     logger(INFO) << "WRONG TRANSACTION BLOB, Failed to check tx " << txHash << " syntax, rejected";
     tvc.m_verifivation_failed = true;
@@ -930,7 +1155,10 @@ bool core::handleIncomingTransaction(const transaction_t& tx, const hash_t& txHa
     return false;
   }
 
-  bool r = add_new_tx(tx, txHash, blobSize, tvc, keptByBlock);
+  return true;
+}
+
+void core::reportIncomingTransaction(const hash_t& txHash, const tx_verification_context_t& tvc) {
   if (tvc.m_verifivation_failed) {
     if (!tvc.m_tx_fee_too_small) {
       logger(ERROR) << "transaction_t verification failed: " << txHash;
@@ -945,8 +1173,6 @@ bool core::handleIncomingTransaction(const transaction_t& tx, const hash_t& txHa
     logger(DEBUGGING) << "tx added: " << txHash;
     poolUpdated();
   }
-
-  return r;
 }
 
 std::unique_ptr<IBlock> core::getBlock(const hash_t& blockId) {
@@ -3,11 +3,16 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #pragma once
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
 #include "p2p/NetNodeCommon.h"
 #include "cryptonote/protocol/handler_common.h"
 #include "currency.h"
 #include "tx_memory_pool.h"
 #include "blockchain.h"
+#include "BlockTemplateCache.h"
 #include "cryptonote/core/IMinerHandler.h"
 #include "command_line/MinerConfig.h"
 #include "ICore.h"
@@ -33,6 +38,7 @@ namespace cryptonote {
 
      bool on_idle() override;
      virtual bool handle_incoming_tx(const binary_array_t& tx_blob, tx_verification_context_t& tvc, bool keeped_by_block) override; //Deprecated. Should be removed with CryptoNoteProtocolHandler.
+     virtual void handleIncomingTransactions(const std::vector<binary_array_t>& txBlobs, std::vector<tx_verification_context_t>& tvcs) override;
      bool handle_incoming_block_blob(const binary_array_t& block_blob, block_verification_context_t& bvc, bool control_miner, bool relay_block) override;
      virtual ICryptonoteProtocol* get_protocol() override {return m_pprotocol;}
      const Currency& currency() const { return m_currency; }
@@ -96,6 +102,14 @@ namespace cryptonote {
        uint32_t& start_height, uint32_t& current_height, uint32_t& full_offset, std::vector<block_full_info_t>& entries) override;
     virtual bool queryBlocksLite(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp,
       uint32_t& resStartHeight, uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<block_short_info_t>& entries) override;
+    // Two halves of queryBlocksLite, so a caller can fetch full blocks in small batches without keeping the blockchain locked.
+    // getShortBlocks fails if block at height - 1 is no longer prevBlockId; null hash skips the check.
+    bool queryBlocksLiteIds(const std::vector<hash_t>& knownBlockIds, uint64_t timestamp, uint32_t& resStartHeight,
+      uint32_t& resCurrentHeight, uint32_t& resFullOffset, std::vector<hash_t>& blockIds, uint32_t& fullBlocksCount);
+    bool getShortBlocks(uint32_t height, uint32_t count, uint64_t timestamp, const hash_t& prevBlockId, std::vector<block_short_info_t>& entries);
+    // getShortBlocks without the copies: visitor gets id and stored entry of every block, with the blockchain locked.
+    bool visitBlocks(uint32_t height, uint32_t count, const hash_t& prevBlockId, const std::function<void(const hash_t& blockId, const block_entry_t& entry)>& visitor);
+    bool getSyncSummaries(uint32_t startHeight, uint32_t count, std::vector<block_sync_summary_t>& summaries);
     virtual hash_t getBlockIdByHeight(uint32_t height) override;
     void getTransactions(const std::vector<hash_t>& txs_ids, std::list<transaction_t>& txs, std::list<hash_t>& missed_txs, bool checkTxPool = false) override;
     virtual bool getBlockByHash(const hash_t &h, block_t &blk) override;
@@ -108,6 +122,8 @@ namespace cryptonote {
 
      std::vector<transaction_t> getPoolTransactions() override;
      size_t get_pool_transactions_count();
+     size_t get_pool_transactions_size();
+     uint64_t get_pool_evicted_transactions_count();
      size_t get_blockchain_total_transactions();
      //bool get_outs(uint64_t amount, std::list<public_key_t>& pkeys);
      virtual std::vector<hash_t> findBlockchainSupplement(const std::vector<hash_t>& remoteBlockIds, size_t maxCount,
@@ -131,12 +147,22 @@ namespace cryptonote {
                                   std::vector<transaction_prefix_info_t>& addedTxs, std::vector<hash_t>& deletedTxsIds) override;
      virtual void getPoolChanges(const std::vector<hash_t>& knownTxsIds, std::vector<transaction_t>& addedTxs,
                                  std::vector<hash_t>& deletedTxsIds) override;
+     // Same, but if the pool change log still covers knownPoolSequence only the changes made since are
+     // returned and knownTxsIds are not looked at; isPoolDelta tells which it was. poolSequence is
+     // where the caller is once the result is applied.
+     bool getPoolChangesSince(const hash_t& tailBlockId, uint64_t knownPoolSequence, const std::vector<hash_t>& knownTxsIds,
+                              std::vector<transaction_t>& addedTxs, std::vector<hash_t>& deletedTxsIds, uint64_t& poolSequence, bool& isPoolDelta);
+     bool getPoolChangesLiteSince(const hash_t& tailBlockId, uint64_t knownPoolSequence, const std::vector<hash_t>& knownTxsIds,
+                                  std::vector<transaction_prefix_info_t>& addedTxs, std::vector<hash_t>& deletedTxsIds, uint64_t& poolSequence, bool& isPoolDelta);
 
      uint64_t getNextBlockDifficulty();
      uint64_t getTotalGeneratedAmount();
 
    private:
-     bool add_new_tx(const transaction_t& tx, const hash_t& tx_hash, size_t blob_size, tx_verification_context_t& tvc, bool keeped_by_block);
+     // checkedMaxUsedBlock is given for transactions whose ring signatures were checked up to it
+     bool add_new_tx(const transaction_t& tx, const hash_t& tx_hash, size_t blob_size, tx_verification_context_t& tvc, bool keeped_by_block, const block_info_t* checkedMaxUsedBlock = nullptr);
+     bool checkIncomingTransaction(const transaction_t& tx, const hash_t& txHash, tx_verification_context_t& tvc, bool keptByBlock);
+     void reportIncomingTransaction(const hash_t& txHash, const tx_verification_context_t& tvc);
      bool load_state_data();
      bool parse_tx_from_blob(transaction_t& tx, hash_t& tx_hash, hash_t& tx_prefix_hash, const binary_array_t& blob);
      bool handle_incoming_block(const block_t& b, block_verification_context_t& bvc, bool control_miner, bool relay_block);
@@ -151,6 +177,8 @@ namespace cryptonote {
      bool check_tx_ring_signature(const key_input_t& tx, const hash_t& tx_prefix_hash, const std::vector<signature_t>& sig);
      bool is_tx_spendtime_unlocked(uint64_t unlock_time);
      bool update_miner_block_template();
+     bool buildBlockTemplate(uint64_t poolRevision, time_t now);
+     bool patchBlockTemplate(uint64_t poolRevision);
      bool on_update_blocktemplate_interval();
      bool check_tx_inputs_keyimages_diff(const transaction_t& tx);
      virtual void blockchainUpdated() override;
@@ -165,6 +193,12 @@ namespace cryptonote {
      cryptonote::RealTimeProvider m_timeProvider;
      TxMemoryPool m_mempool;
      Blockchain m_blockchain;
+     std::mutex m_blockTemplateLock;
+     // transactions being checked by handleIncomingTransactions, so that a transaction relayed by
+     // several peers at once is checked once
+     std::mutex m_admissionLock;
+     std::unordered_set<hash_t> m_admittingTransactions;
+     BlockTemplateCache m_blockTemplateCache;
      ICryptonoteProtocol* m_pprotocol;
      std::unique_ptr<miner> m_miner;
     //  std::string m_config_folder;
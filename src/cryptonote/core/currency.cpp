@@ -415,6 +415,22 @@ difficulty_t Currency::nextDifficulty(std::vector<uint64_t> timestamps,
                          (uint64_t *)&config);
 }
 
+difficulty_t Currency::nextDifficultySorted(const std::vector<uint64_t> &sortedTimestamps,
+                                            const std::vector<difficulty_t> &cumulativeDifficulties) const
+{
+  assert(sortedTimestamps.size() <= m_difficultyWindow);
+  assert(sortedTimestamps.size() == cumulativeDifficulties.size());
+
+  difficulty_config_t config;
+  config.window = m_difficultyWindow;
+  config.target = m_difficultyTarget;
+  config.cut = m_difficultyCut;
+  config.lag = m_difficultyLag;
+  return next_difficulty_sorted(sortedTimestamps.data(), sortedTimestamps.size(),
+                                cumulativeDifficulties.data(),
+                                (uint64_t *)&config);
+}
+
 size_t Currency::getApproximateMaximumInputCount(size_t transactionSize, size_t outputCount, size_t mixinCount) const
 {
   const size_t KEY_IMAGE_SIZE = sizeof(key_image_t);
@@ -477,6 +493,7 @@ CurrencyBuilder::CurrencyBuilder(const std::string &path, config::config_t &conf
   mempoolTxLiveTime(parameters::CRYPTONOTE_MEMPOOL_TX_LIVETIME);
   mempoolTxFromAltBlockLiveTime(parameters::CRYPTONOTE_MEMPOOL_TX_FROM_ALT_BLOCK_LIVETIME);
   numberOfPeriodsToForgetTxDeletedFromPool(parameters::CRYPTONOTE_NUMBER_OF_PERIODS_TO_FORGET_TX_DELETED_FROM_POOL);
+  mempoolMaxSize(parameters::CRYPTONOTE_MEMPOOL_MAX_SIZE);
 
   fusionTxMaxSize(parameters::FUSION_TX_MAX_SIZE);
   fusionTxMinInputCount(parameters::FUSION_TX_MIN_INPUT_COUNT);
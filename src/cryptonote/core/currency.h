@@ -62,6 +62,7 @@ public:
   uint64_t mempoolTxLiveTime() const { return m_mempoolTxLiveTime; }
   uint64_t mempoolTxFromAltBlockLiveTime() const { return m_mempoolTxFromAltBlockLiveTime; }
   uint64_t numberOfPeriodsToForgetTxDeletedFromPool() const { return m_numberOfPeriodsToForgetTxDeletedFromPool; }
+  size_t mempoolMaxSize() const { return m_mempoolMaxSize; }
 
   size_t fusionTxMaxSize() const { return m_fusionTxMaxSize; }
   size_t fusionTxMinInputCount() const { return m_fusionTxMinInputCount; }
@@ -124,6 +125,8 @@ public:
   bool parseAmount(const std::string& str, uint64_t& amount) const;
 
   difficulty_t nextDifficulty(std::vector<uint64_t> timestamps, std::vector<difficulty_t> cumulativeDifficulties) const;
+  // for at most difficultyWindow() timestamps that are already sorted
+  difficulty_t nextDifficultySorted(const std::vector<uint64_t> &sortedTimestamps, const std::vector<difficulty_t> &cumulativeDifficulties) const;
 
   size_t getApproximateMaximumInputCount(size_t transactionSize, size_t outputCount, size_t mixinCount) const;
   const config::config_t &getConfig() const {
@@ -179,6 +182,7 @@ private:
   uint64_t m_mempoolTxLiveTime;
   uint64_t m_mempoolTxFromAltBlockLiveTime;
   uint64_t m_numberOfPeriodsToForgetTxDeletedFromPool;
+  size_t m_mempoolMaxSize;
 
   size_t m_fusionTxMaxSize;
   size_t m_fusionTxMinInputCount;
@@ -249,6 +253,7 @@ public:
   CurrencyBuilder& mempoolTxLiveTime(uint64_t val) { m_currency.m_mempoolTxLiveTime = val; return *this; }
   CurrencyBuilder& mempoolTxFromAltBlockLiveTime(uint64_t val) { m_currency.m_mempoolTxFromAltBlockLiveTime = val; return *this; }
   CurrencyBuilder& numberOfPeriodsToForgetTxDeletedFromPool(uint64_t val) { m_currency.m_numberOfPeriodsToForgetTxDeletedFromPool = val; return *this; }
+  CurrencyBuilder& mempoolMaxSize(size_t val) { m_currency.m_mempoolMaxSize = val; return *this; }
 
   CurrencyBuilder& fusionTxMaxSize(size_t val) { m_currency.m_fusionTxMaxSize = val; return *this; }
   CurrencyBuilder& fusionTxMinInputCount(size_t val) { m_currency.m_fusionTxMinInputCount = val; return *this; }
@@ -20,6 +20,8 @@
 #include "CryptoNoteFormatUtils.h"
 #include "CryptoNoteTools.h"
 #include "CryptoNoteConfig.h"
+#include "PoolSnapshot.h"
+#include "TransactionSelector.h"
 #include "cryptonote/structures/array.hpp"
 #include "stream/transaction.h"
 #include "stream/set.hpp"
@@ -32,6 +34,26 @@ using namespace Logging;
 namespace cryptonote
 {
 
+  namespace
+  {
+    const size_t MAX_RECENTLY_ADDED_TRANSACTIONS = 1000;
+    const size_t MAX_RECENTLY_DELETED_TRANSACTIONS = 100000;
+    const size_t MAX_POOL_CHANGES = 100000;
+    // seconds an evicted transaction is refused while the pool has no room for it, so that relays
+    // of it don't evict and re-evict the pool's cheapest transactions
+    const uint64_t EVICTED_TRANSACTION_HOLD_TIME = 5 * 60;
+    // seconds between background snapshots, all a crash can lose of the pool
+    const unsigned SNAPSHOT_INTERVAL = 5 * 60;
+
+    // fee / blobSize < otherFee / otherBlobSize
+    bool paysLessPerByte(uint64_t fee, size_t blobSize, uint64_t otherFee, size_t otherBlobSize)
+    {
+      uint64_t hi, lo = mul128(fee, otherBlobSize, &hi);
+      uint64_t otherHi, otherLo = mul128(otherFee, blobSize, &otherHi);
+      return hi < otherHi || (hi == otherHi && lo < otherLo);
+    }
+  }
+
   //---------------------------------------------------------------------------------
   // BlockTemplate
   //---------------------------------------------------------------------------------
@@ -109,7 +131,16 @@ namespace cryptonote
                                m_validator(validator),
                                m_timeProvider(timeProvider),
                                m_txCheckInterval(60, timeProvider),
+                               m_snapshotInterval(SNAPSHOT_INTERVAL, timeProvider),
                                m_fee_index(boost::get<1>(m_transactions)),
+                               m_totalSize(0),
+                               m_evictedCount(0),
+                               m_revision(0),
+                               m_lastRemovalRevision(0),
+                               // sequence numbers handed out by an earlier run are older than any of this one
+                               m_firstSequence(static_cast<uint64_t>(timeProvider.now()) << 32),
+                               m_sequence(m_firstSequence),
+                               m_snapshotRevision(0),
                                logger(log, "txpool")
   {
   }
@@ -120,6 +151,16 @@ namespace cryptonote
   }
   //---------------------------------------------------------------------------------
   bool TxMemoryPool::add_tx(const transaction_t &tx, /*const hash_t& tx_prefix_hash,*/ const hash_t &id, size_t blobSize, tx_verification_context_t &tvc, bool keptByBlock)
+  {
+    return addTransaction(tx, id, blobSize, tvc, keptByBlock, block_info_t());
+  }
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::add_tx(const transaction_t &tx, const hash_t &id, size_t blobSize, const block_info_t &maxUsedBlock, tx_verification_context_t &tvc)
+  {
+    return addTransaction(tx, id, blobSize, tvc, false, maxUsedBlock);
+  }
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::addTransaction(const transaction_t &tx, const hash_t &id, size_t blobSize, tx_verification_context_t &tvc, bool keptByBlock, block_info_t maxUsedBlock)
   {
     if (!check_inputs_types_supported(tx))
     {
@@ -165,10 +206,17 @@ namespace cryptonote
       }
     }
 
-    block_info_t maxUsedBlock;
-
-    // check inputs
-    bool inputsValid = m_validator.checkTransactionInputs(tx, maxUsedBlock);
+    // check inputs; signatures checked before against a block still in the main chain are not checked again
+    bool inputsValid;
+    if (maxUsedBlock.empty())
+    {
+      inputsValid = m_validator.checkTransactionInputs(tx, maxUsedBlock);
+    }
+    else
+    {
+      block_info_t lastFailedBlock;
+      inputsValid = m_validator.checkTransactionInputs(tx, maxUsedBlock, lastFailedBlock) && !m_validator.haveSpentKeyImages(tx);
+    }
 
     if (!inputsValid)
     {
@@ -205,6 +253,24 @@ namespace cryptonote
       return true;
     }
 
+    if (!keptByBlock && isTransactionRecentlyEvicted(id, blobSize))
+    {
+      logger(DEBUGGING) << "Tx pool is still full for recently evicted transaction " << id << ". Ignore";
+      tvc.m_verifivation_failed = false;
+      tvc.m_should_be_relayed = false;
+      tvc.m_added_to_pool = false;
+      return true;
+    }
+
+    if (!keptByBlock && !makeRoom(blobSize, fee))
+    {
+      logger(INFO) << "Tx pool is full and transaction " << id << " pays no more per byte than what it holds. Ignore";
+      tvc.m_verifivation_failed = false;
+      tvc.m_should_be_relayed = false;
+      tvc.m_added_to_pool = false;
+      return true;
+    }
+
     // add to pool
     {
       transaction_details_t txd;
@@ -225,8 +291,17 @@ namespace cryptonote
         logger(ERROR, BRIGHT_RED) << "transaction already exists at inserting in memory pool";
         return false;
       }
-      m_paymentIdIndex.add(txd.tx);
-      m_timestampIndex.add(txd.receiveTime, txd.id);
+      m_paymentIdIndex.add(txd_p.first->tx, id);
+      m_timestampIndex.add(txd_p.first->receiveTime, id);
+      m_uncheckedTransactions.insert(id);
+      m_totalSize += blobSize;
+
+      ++m_revision;
+      m_recentlyAdded.emplace_back(m_revision, id);
+      if (m_recentlyAdded.size() > MAX_RECENTLY_ADDED_TRANSACTIONS)
+      {
+        m_recentlyAdded.pop_front();
+      }
     }
 
     tvc.m_added_to_pool = true;
@@ -275,6 +350,18 @@ namespace cryptonote
     return m_transactions.size();
   }
   //---------------------------------------------------------------------------------
+  size_t TxMemoryPool::get_transactions_size() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    return m_totalSize;
+  }
+  //---------------------------------------------------------------------------------
+  uint64_t TxMemoryPool::get_evicted_transactions_count() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    return m_evictedCount;
+  }
+  //---------------------------------------------------------------------------------
   void TxMemoryPool::get_transactions(std::list<transaction_t> &txs) const
   {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
@@ -284,46 +371,213 @@ namespace cryptonote
     }
   }
   //---------------------------------------------------------------------------------
-  void TxMemoryPool::get_difference(const std::vector<hash_t> &known_tx_ids, std::vector<hash_t> &new_tx_ids, std::vector<hash_t> &deleted_tx_ids) const
+  void TxMemoryPool::get_difference(const std::vector<hash_t> &known_tx_ids, std::vector<hash_t> &new_tx_ids, std::vector<hash_t> &deleted_tx_ids)
   {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
-    std::unordered_set<hash_t> ready_tx_ids;
-    for (const auto &tx : m_transactions)
+    updateReadiness();
+
+    std::unordered_set<hash_t> known_set(known_tx_ids.begin(), known_tx_ids.end());
+    for (const auto txd : m_readyTransactions)
     {
-      transaction_check_info_t checkInfo(tx);
-      if (is_transaction_ready_to_go(tx.tx, checkInfo))
+      if (known_set.erase(txd->id) == 0)
       {
-        ready_tx_ids.insert(tx.id);
+        new_tx_ids.push_back(txd->id);
       }
     }
 
-    std::unordered_set<hash_t> known_set(known_tx_ids.begin(), known_tx_ids.end());
-    for (auto it = ready_tx_ids.begin(), e = ready_tx_ids.end(); it != e;)
+    deleted_tx_ids.assign(known_set.begin(), known_set.end());
+  }
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::get_changes_since(uint64_t sequence, std::vector<hash_t> &new_tx_ids, std::vector<hash_t> &deleted_tx_ids)
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    updateReadiness();
+
+    if (sequence < m_firstSequence || sequence > m_sequence)
+    {
+      return false;
+    }
+
+    // the log is in sequence order, the last change of an id is what counts
+    auto it = std::upper_bound(m_changes.begin(), m_changes.end(), sequence, [](uint64_t value, const pool_change_t &change) {
+      return value < change.sequence;
+    });
+
+    std::unordered_map<hash_t, bool> net;
+    for (; it != m_changes.end(); ++it)
+    {
+      net[it->id] = it->added;
+    }
+
+    for (const auto &change : net)
+    {
+      (change.second ? new_tx_ids : deleted_tx_ids).push_back(change.first);
+    }
+
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  uint64_t TxMemoryPool::get_sequence()
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    updateReadiness();
+    return m_sequence;
+  }
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::on_blockchain_inc(uint64_t new_block_height, const hash_t &top_block_id, const std::vector<transaction_t> &transactions)
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+
+    // transactions spending what the block spent are double spends now
+    markSpendersUnchecked(transactions);
+
+    // transactions that refer to the block just added could not be used before it
+    std::vector<hash_t> waiting;
+    for (const auto &id : m_notReadyTransactions)
+    {
+      const auto &txd = *m_transactions.find(id);
+      if (!txd.maxUsedBlock.empty() && txd.maxUsedBlock.height + 1 == new_block_height)
+      {
+        waiting.push_back(id);
+      }
+    }
+
+    for (const auto &id : waiting)
+    {
+      markUnchecked(id);
+    }
+
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::on_blockchain_dec(uint64_t new_block_height, const hash_t &top_block_id, const std::vector<transaction_t> &transactions)
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+
+    // key images the block spent are free again
+    markSpendersUnchecked(transactions);
+
+    // so is every check made against the popped block
+    std::vector<hash_t> touched;
+    for (const auto txd : m_readyTransactions)
+    {
+      if (txd->maxUsedBlock.height >= new_block_height)
+      {
+        touched.push_back(txd->id);
+      }
+    }
+
+    for (const auto &id : m_notReadyTransactions)
     {
-      auto known_it = known_set.find(*it);
-      if (known_it != known_set.end())
+      const auto &txd = *m_transactions.find(id);
+      if ((!txd.maxUsedBlock.empty() && txd.maxUsedBlock.height >= new_block_height) ||
+          (!txd.lastFailedBlock.empty() && txd.lastFailedBlock.height >= new_block_height))
       {
-        known_set.erase(known_it);
-        it = ready_tx_ids.erase(it);
+        touched.push_back(id);
+      }
+    }
+
+    for (const auto &id : touched)
+    {
+      markUnchecked(id);
+    }
+
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  void TxMemoryPool::markUnchecked(const hash_t &id)
+  {
+    auto it = m_transactions.find(id);
+    if (it == m_transactions.end())
+    {
+      return;
+    }
+
+    m_readyTransactions.erase(&*it);
+    m_notReadyTransactions.erase(id);
+    m_uncheckedTransactions.insert(id);
+  }
+  //---------------------------------------------------------------------------------
+  void TxMemoryPool::markSpendersUnchecked(const std::vector<transaction_t> &transactions)
+  {
+    for (const auto &tx : transactions)
+    {
+      for (const auto &in : tx.inputs)
+      {
+        if (in.type() != typeid(key_input_t))
+        {
+          continue;
+        }
+
+        auto it = m_spent_key_images.find(boost::get<key_input_t>(in).keyImage);
+        if (it == m_spent_key_images.end())
+        {
+          continue;
+        }
+
+        for (const auto &id : it->second)
+        {
+          markUnchecked(id);
+        }
+      }
+    }
+  }
+  //---------------------------------------------------------------------------------
+  void TxMemoryPool::updateReadiness()
+  {
+    for (const auto &id : m_uncheckedTransactions)
+    {
+      auto it = m_transactions.find(id);
+      if (it == m_transactions.end())
+      {
+        continue;
+      }
+
+      transaction_check_info_t checkInfo(*it);
+      bool ready = is_transaction_ready_to_go(it->tx, checkInfo);
+
+      // update item state
+      m_transactions.modify(it, [&checkInfo](transaction_check_info_t &item) {
+        item = checkInfo;
+      });
+
+      if (ready)
+      {
+        m_readyTransactions.insert(&*it);
       }
       else
       {
-        ++it;
+        m_notReadyTransactions.insert(id);
       }
+
+      logChange(id, ready);
     }
 
-    new_tx_ids.assign(ready_tx_ids.begin(), ready_tx_ids.end());
-    deleted_tx_ids.assign(known_set.begin(), known_set.end());
+    m_uncheckedTransactions.clear();
   }
   //---------------------------------------------------------------------------------
-  bool TxMemoryPool::on_blockchain_inc(uint64_t new_block_height, const hash_t &top_block_id)
+  void TxMemoryPool::logChange(const hash_t &id, bool ready)
   {
-    return true;
+    bool changed = ready ? m_loggedTransactions.insert(id).second : m_loggedTransactions.erase(id) != 0;
+    if (!changed)
+    {
+      return;
+    }
+
+    m_changes.push_back({++m_sequence, id, ready});
+    if (m_changes.size() > MAX_POOL_CHANGES)
+    {
+      m_firstSequence = m_changes.front().sequence;
+      m_changes.pop_front();
+    }
   }
   //---------------------------------------------------------------------------------
-  bool TxMemoryPool::on_blockchain_dec(uint64_t new_block_height, const hash_t &top_block_id)
+  void TxMemoryPool::resetChanges()
   {
-    return true;
+    // whatever was logged is gone without a trace, so no caller can catch up from the log
+    m_loggedTransactions.clear();
+    m_changes.clear();
+    m_firstSequence = ++m_sequence;
   }
   //---------------------------------------------------------------------------------
   bool TxMemoryPool::have_tx(const hash_t &id) const
@@ -400,53 +654,131 @@ namespace cryptonote
     total_size = 0;
     fee = 0;
 
-    size_t max_total_size = 2 * median_size - m_currency.minerTxBlobReservedSize();
-    max_total_size = std::min(max_total_size, maxCumulativeSize);
+    updateReadiness();
 
     BlockTemplate blockTemplate;
 
-    for (auto it = m_fee_index.rbegin(); it != m_fee_index.rend() && it->fee == 0; ++it)
+    for (auto it = m_readyTransactions.rbegin(); it != m_readyTransactions.rend() && (*it)->fee == 0; ++it)
     {
-      const auto &txd = *it;
+      const auto &txd = **it;
 
       if (m_currency.fusionTxMaxSize() < total_size + txd.blobSize)
       {
         continue;
       }
 
-      transaction_check_info_t checkInfo(txd);
-      if (is_transaction_ready_to_go(txd.tx, checkInfo) && blockTemplate.addTransaction(txd.id, txd.tx))
+      if (blockTemplate.addTransaction(txd.id, txd.tx))
       {
         total_size += txd.blobSize;
       }
     }
 
-    for (auto i = m_fee_index.begin(); i != m_fee_index.end(); ++i)
+    std::vector<const transaction_details_t *> transactions(m_readyTransactions.begin(), m_readyTransactions.end());
+    std::vector<TransactionSelector::Candidate> candidates;
+    candidates.reserve(transactions.size());
+    for (const auto txd : transactions)
     {
-      const auto &txd = *i;
+      candidates.push_back({txd->blobSize, txd->fee});
+    }
+
+    TransactionSelector selector(m_currency, median_size, maxCumulativeSize, already_generated_coins);
+    selector.select(candidates, [&](size_t index) {
+      return blockTemplate.addTransaction(transactions[index]->id, transactions[index]->tx);
+    }, total_size, fee);
+
+    bl.transactionHashes = blockTemplate.getTransactions();
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::append_to_block_template(std::vector<hash_t> &txHashes, const std::vector<hash_t> &addedIds, size_t median_size,
+                                              size_t maxCumulativeSize, size_t &total_size, uint64_t &fee)
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+
+    // past the full reward zone it takes the whole selection to tell what pays, leave it to fill_block_template
+    size_t max_total_size = TransactionSelector(m_currency, median_size, maxCumulativeSize, 0).getFreeSize();
 
-      size_t blockSizeLimit = (txd.fee == 0) ? median_size : max_total_size;
-      if (blockSizeLimit < total_size + txd.blobSize)
+    updateReadiness();
+
+    BlockTemplate blockTemplate;
+    std::unordered_set<hash_t> included;
+    for (const auto &id : txHashes)
+    {
+      auto it = m_transactions.find(id);
+      if (it == m_transactions.end() || !blockTemplate.addTransaction(it->id, it->tx))
       {
-        continue;
+        return false;
       }
 
-      transaction_check_info_t checkInfo(txd);
-      bool ready = is_transaction_ready_to_go(txd.tx, checkInfo);
+      included.insert(id);
+    }
 
-      // update item state
-      m_fee_index.modify(i, [&checkInfo](transaction_check_info_t &item) {
-        item = checkInfo;
-      });
+    size_t newTotalSize = total_size;
+    uint64_t newFee = fee;
+    for (const auto &id : addedIds)
+    {
+      auto it = m_transactions.find(id);
+      if (it == m_transactions.end())
+      {
+        return false;
+      }
 
-      if (ready && blockTemplate.addTransaction(txd.id, txd.tx))
+      const auto &txd = *it;
+      if (included.count(id) != 0)
       {
-        total_size += txd.blobSize;
-        fee += txd.fee;
+        continue;
+      }
+
+      // fusion transactions have their own limits, leave them to fill_block_template
+      if (txd.fee == 0 || max_total_size < newTotalSize + txd.blobSize)
+      {
+        return false;
+      }
+
+      if (m_readyTransactions.count(&txd) != 0 && blockTemplate.addTransaction(txd.id, txd.tx))
+      {
+        newTotalSize += txd.blobSize;
+        newFee += txd.fee;
       }
     }
 
-    bl.transactionHashes = blockTemplate.getTransactions();
+    txHashes = blockTemplate.getTransactions();
+    total_size = newTotalSize;
+    fee = newFee;
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  uint64_t TxMemoryPool::getRevision() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    return m_revision;
+  }
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::getAddedSince(uint64_t revision, std::vector<hash_t> &addedIds) const
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+
+    if (m_lastRemovalRevision > revision)
+    {
+      return false;
+    }
+
+    if (revision == m_revision)
+    {
+      return true;
+    }
+
+    if (m_recentlyAdded.empty() || m_recentlyAdded.front().first > revision + 1)
+    {
+      return false;
+    }
+
+    for (auto it = m_recentlyAdded.rbegin(); it != m_recentlyAdded.rend() && it->first > revision; ++it)
+    {
+      addedIds.push_back(it->second);
+    }
+
+    std::reverse(addedIds.begin(), addedIds.end());
     return true;
   }
   //---------------------------------------------------------------------------------
@@ -454,13 +786,36 @@ namespace cryptonote
   {
     std::cout << "Tx Memory Pool init" << std::endl;
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
-    if (!read(*this, m_currency.txPoolFileName()))
+    std::vector<transaction_details_t> transactions;
+    std::unordered_map<hash_t, uint64_t> recentlyDeleted;
+    bool loaded = PoolSnapshot::load(m_currency.txPoolFileName(), transactions, recentlyDeleted);
+    if (loaded)
+    {
+      for (auto &details : transactions)
+      {
+        m_transactions.insert(std::move(details));
+      }
+
+      m_recentlyDeletedTransactions.swap(recentlyDeleted);
+    }
+    else
+    {
+      // saved before snapshots
+      loaded = read(*this, m_currency.txPoolFileName());
+    }
+
+    if (!loaded)
     {
       logger(ERROR) << "Failed to load memory pool from file " << m_currency.txPoolFileName();
 
       m_transactions.clear();
       m_spent_key_images.clear();
       m_spentOutputs.clear();
+      m_readyTransactions.clear();
+      m_notReadyTransactions.clear();
+      m_uncheckedTransactions.clear();
+      resetChanges();
+      m_totalSize = 0;
 
       m_paymentIdIndex.clear();
       m_timestampIndex.clear();
@@ -470,7 +825,10 @@ namespace cryptonote
       buildIndices();
     }
 
+    buildRecentlyDeletedOrder();
     removeExpiredTransactions();
+    shrinkToMaxSize();
+    m_snapshotRevision = m_revision;
 
     // Ignore deserialization error
     return true;
@@ -479,12 +837,16 @@ namespace cryptonote
   bool TxMemoryPool::deinit()
   {
     std::cout << "Tx Memory Pool deinit" << std::endl;
-    if (!std::file::exists(m_currency.txPoolFileName()))
+    waitForSnapshot();
+
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    std::vector<const transaction_details_t *> transactions;
+    for (const auto &details : m_transactions)
     {
-      std::file::create(m_currency.txPoolFileName());
+      transactions.push_back(&details);
     }
 
-    if (!save(*this, m_currency.txPoolFileName()))
+    if (!PoolSnapshot::save(m_currency.txPoolFileName(), transactions, m_recentlyDeletedTransactions))
     {
       logger(INFO) << "Failed to serialize memory pool to file " << m_currency.txPoolFileName();
     }
@@ -495,12 +857,65 @@ namespace cryptonote
     return true;
   }
 
+// the format before PoolSnapshot, still read by init
 #define CURRENT_MEMPOOL_ARCHIVE_VER 1
 
   //---------------------------------------------------------------------------------
   void TxMemoryPool::on_idle()
   {
     m_txCheckInterval.call([this]() { return removeExpiredTransactions(); });
+    m_snapshotInterval.call([this]() { return startSnapshot(); });
+  }
+
+  //---------------------------------------------------------------------------------
+  bool TxMemoryPool::startSnapshot()
+  {
+    if (m_snapshot.valid())
+    {
+      if (m_snapshot.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      {
+        return true;
+      }
+
+      waitForSnapshot();
+    }
+
+    // copied under the lock, serialized and written without it
+    auto transactions = std::make_shared<std::vector<transaction_details_t>>();
+    auto recentlyDeleted = std::make_shared<std::unordered_map<hash_t, uint64_t>>();
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+      if (m_revision == m_snapshotRevision)
+      {
+        return true;
+      }
+
+      m_snapshotRevision = m_revision;
+      transactions->assign(m_transactions.begin(), m_transactions.end());
+      *recentlyDeleted = m_recentlyDeletedTransactions;
+    }
+
+    std::string filename = m_currency.txPoolFileName();
+    m_snapshot = std::async(std::launch::async, [filename, transactions, recentlyDeleted]() {
+      std::vector<const transaction_details_t *> pointers;
+      for (const auto &details : *transactions)
+      {
+        pointers.push_back(&details);
+      }
+
+      return PoolSnapshot::save(filename, pointers, *recentlyDeleted);
+    });
+
+    return true;
+  }
+
+  //---------------------------------------------------------------------------------
+  void TxMemoryPool::waitForSnapshot()
+  {
+    if (m_snapshot.valid() && !m_snapshot.get())
+    {
+      logger(WARNING) << "Failed to write memory pool snapshot to " << m_currency.txPoolFileName();
+    }
   }
 
   //---------------------------------------------------------------------------------
@@ -512,12 +927,28 @@ namespace cryptonote
 
       uint64_t now = m_timeProvider.now();
 
-      for (auto it = m_recentlyDeletedTransactions.begin(); it != m_recentlyDeletedTransactions.end();)
+      while (!m_recentlyDeletedOrder.empty())
+      {
+        uint64_t elapsedTimeSinceDeletion = now - m_recentlyDeletedOrder.front().first;
+        if (elapsedTimeSinceDeletion <= m_currency.numberOfPeriodsToForgetTxDeletedFromPool() * m_currency.mempoolTxLiveTime())
+        {
+          break;
+        }
+
+        auto it = m_recentlyDeletedTransactions.find(m_recentlyDeletedOrder.front().second);
+        if (it != m_recentlyDeletedTransactions.end() && it->second == m_recentlyDeletedOrder.front().first)
+        {
+          m_recentlyDeletedTransactions.erase(it);
+        }
+
+        m_recentlyDeletedOrder.pop_front();
+      }
+
+      for (auto it = m_recentlyEvictedTransactions.begin(); it != m_recentlyEvictedTransactions.end();)
       {
-        uint64_t elapsedTimeSinceDeletion = now - it->second;
-        if (elapsedTimeSinceDeletion > m_currency.numberOfPeriodsToForgetTxDeletedFromPool() * m_currency.mempoolTxLiveTime())
+        if (now - it->second > EVICTED_TRANSACTION_HOLD_TIME)
         {
-          it = m_recentlyDeletedTransactions.erase(it);
+          it = m_recentlyEvictedTransactions.erase(it);
         }
         else
         {
@@ -533,7 +964,7 @@ namespace cryptonote
         if (remove)
         {
           logger(TRACE) << "Tx " << it->id << " removed from tx pool due to outdated, age: " << txAge;
-          m_recentlyDeletedTransactions.emplace(it->id, now);
+          addRecentlyDeletedTransaction(it->id, now);
           it = removeTransaction(it);
           somethingRemoved = true;
         }
@@ -555,11 +986,131 @@ namespace cryptonote
   TxMemoryPool::tx_container_t::iterator TxMemoryPool::removeTransaction(TxMemoryPool::tx_container_t::iterator i)
   {
     removeTransactionInputs(i->id, i->tx, i->keptByBlock);
-    m_paymentIdIndex.remove(i->tx);
+    m_readyTransactions.erase(&*i);
+    m_notReadyTransactions.erase(i->id);
+    m_uncheckedTransactions.erase(i->id);
+    logChange(i->id, false);
+    m_totalSize -= i->blobSize;
+    m_paymentIdIndex.remove(i->tx, i->id);
     m_timestampIndex.remove(i->receiveTime, i->id);
+
+    ++m_revision;
+    m_lastRemovalRevision = m_revision;
     return m_transactions.erase(i);
   }
 
+  bool TxMemoryPool::makeRoom(size_t blobSize, uint64_t fee)
+  {
+    size_t maxSize = m_currency.mempoolMaxSize();
+    if (m_totalSize + blobSize <= maxSize)
+    {
+      return true;
+    }
+
+    // cheapest first; transactions of alternative blocks are needed if the chain switches, they stay
+    std::vector<hash_t> evicted;
+    size_t size = m_totalSize;
+    for (auto it = m_fee_index.rbegin(); it != m_fee_index.rend() && size + blobSize > maxSize; ++it)
+    {
+      if (it->keptByBlock)
+      {
+        continue;
+      }
+
+      if (!paysLessPerByte(it->fee, it->blobSize, fee, blobSize))
+      {
+        return false;
+      }
+
+      evicted.push_back(it->id);
+      size -= it->blobSize;
+    }
+
+    if (size + blobSize > maxSize)
+    {
+      return false;
+    }
+
+    evictTransactions(evicted);
+    return true;
+  }
+
+  void TxMemoryPool::shrinkToMaxSize()
+  {
+    // collected first, removing them invalidates the fee index iterators
+    std::vector<hash_t> evicted;
+    size_t size = m_totalSize;
+    for (auto it = m_fee_index.rbegin(); it != m_fee_index.rend() && size > m_currency.mempoolMaxSize(); ++it)
+    {
+      if (!it->keptByBlock)
+      {
+        evicted.push_back(it->id);
+        size -= it->blobSize;
+      }
+    }
+
+    evictTransactions(evicted);
+  }
+
+  void TxMemoryPool::evictTransactions(const std::vector<hash_t> &ids)
+  {
+    uint64_t now = m_timeProvider.now();
+    for (const auto &id : ids)
+    {
+      logger(DEBUGGING) << "Tx " << id << " evicted from full tx pool";
+      m_recentlyEvictedTransactions[id] = now;
+      removeTransaction(m_transactions.find(id));
+      ++m_evictedCount;
+    }
+  }
+
+  bool TxMemoryPool::isTransactionRecentlyEvicted(const hash_t &id, size_t blobSize)
+  {
+    auto it = m_recentlyEvictedTransactions.find(id);
+    if (it == m_recentlyEvictedTransactions.end())
+    {
+      return false;
+    }
+
+    if (m_timeProvider.now() - it->second > EVICTED_TRANSACTION_HOLD_TIME || m_totalSize + blobSize <= m_currency.mempoolMaxSize())
+    {
+      m_recentlyEvictedTransactions.erase(it);
+      return false;
+    }
+
+    return true;
+  }
+
+  void TxMemoryPool::addRecentlyDeletedTransaction(const hash_t &id, uint64_t time)
+  {
+    m_recentlyDeletedTransactions[id] = time;
+    m_recentlyDeletedOrder.emplace_back(time, id);
+
+    while (m_recentlyDeletedOrder.size() > MAX_RECENTLY_DELETED_TRANSACTIONS)
+    {
+      auto it = m_recentlyDeletedTransactions.find(m_recentlyDeletedOrder.front().second);
+      if (it != m_recentlyDeletedTransactions.end() && it->second == m_recentlyDeletedOrder.front().first)
+      {
+        m_recentlyDeletedTransactions.erase(it);
+      }
+
+      m_recentlyDeletedOrder.pop_front();
+    }
+  }
+
+  void TxMemoryPool::buildRecentlyDeletedOrder()
+  {
+    m_recentlyDeletedOrder.clear();
+    for (const auto &entry : m_recentlyDeletedTransactions)
+    {
+      m_recentlyDeletedOrder.emplace_back(entry.second, entry.first);
+    }
+
+    std::sort(m_recentlyDeletedOrder.begin(), m_recentlyDeletedOrder.end(), [](const std::pair<uint64_t, hash_t> &lhs, const std::pair<uint64_t, hash_t> &rhs) {
+      return lhs.first < rhs.first;
+    });
+  }
+
   bool TxMemoryPool::removeTransactionInputs(const hash_t &tx_id, const transaction_t &tx, bool keptByBlock)
   {
     for (const auto &in : tx.inputs)
@@ -689,11 +1240,33 @@ namespace cryptonote
   void TxMemoryPool::buildIndices()
   {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
-    for (auto it = m_transactions.begin(); it != m_transactions.end(); it++)
+    // the payment id index parses the extra of every transaction, so both indices are built on
+    // threads of their own while the spent inputs are rebuilt here
+    auto paymentIds = std::async(std::launch::async, [this]() {
+      for (const auto &details : m_transactions)
+      {
+        m_paymentIdIndex.add(details.tx, details.id);
+      }
+    });
+    auto timestamps = std::async(std::launch::async, [this]() {
+      for (const auto &details : m_transactions)
+      {
+        m_timestampIndex.add(details.receiveTime, details.id);
+      }
+    });
+
+    m_totalSize = 0;
+    m_spent_key_images.clear();
+    m_spentOutputs.clear();
+    for (const auto &details : m_transactions)
     {
-      m_paymentIdIndex.add(it->tx);
-      m_timestampIndex.add(it->receiveTime, it->id);
+      m_totalSize += details.blobSize;
+      addTransactionInputs(details.id, details.tx, details.keptByBlock);
+      m_uncheckedTransactions.insert(details.id);
     }
+
+    paymentIds.get();
+    timestamps.get();
   }
 
   bool TxMemoryPool::getTransactionIdsByPaymentId(const hash_t &paymentId, std::vector<hash_t> &transactionIds)
@@ -726,6 +1299,10 @@ namespace cryptonote
     i >> temp;
     size = temp;
     v.m_transactions.clear();
+    v.m_readyTransactions.clear();
+    v.m_notReadyTransactions.clear();
+    v.m_uncheckedTransactions.clear();
+    v.resetChanges();
     while (size--)
     {
       transaction_details_t details;
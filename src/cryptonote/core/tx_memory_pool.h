@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <boost/utility.hpp>
 
@@ -63,21 +66,43 @@ namespace cryptonote
     bool have_tx(const hash_t &id) const;
     bool add_tx(const transaction_t &tx, const hash_t &id, size_t blobSize, tx_verification_context_t &tvc, bool keeped_by_block);
     bool add_tx(const transaction_t &tx, tx_verification_context_t &tvc, bool keeped_by_block);
+    // Adds a relayed transaction whose ring signatures were already checked against the main chain up
+    // to maxUsedBlock. They are not checked again while that block is in the main chain; key images are.
+    bool add_tx(const transaction_t &tx, const hash_t &id, size_t blobSize, const block_info_t &maxUsedBlock, tx_verification_context_t &tvc);
     //gets tx and remove it from pool
     bool take_tx(const hash_t &id, transaction_t &tx, size_t &blobSize, uint64_t &fee);
 
-    bool on_blockchain_inc(uint64_t new_block_height, const hash_t &top_block_id);
-    bool on_blockchain_dec(uint64_t new_block_height, const hash_t &top_block_id);
+    // Called by the blockchain with the transactions of the block pushed or popped; only the pool
+    // transactions these can change the readiness of are checked again.
+    bool on_blockchain_inc(uint64_t new_block_height, const hash_t &top_block_id, const std::vector<transaction_t> &transactions);
+    bool on_blockchain_dec(uint64_t new_block_height, const hash_t &top_block_id, const std::vector<transaction_t> &transactions);
 
     void lock() const;
     void unlock() const;
     std::unique_lock<std::recursive_mutex> obtainGuard() const;
 
     bool fill_block_template(block_t &bl, size_t median_size, size_t maxCumulativeSize, uint64_t already_generated_coins, size_t &total_size, uint64_t &fee);
+    // Adds ready transactions from addedIds to a template made by fill_block_template. Fails without
+    // touching the template if one of them does not fit in the full reward zone, so the caller can fall back to a full fill.
+    bool append_to_block_template(std::vector<hash_t> &txHashes, const std::vector<hash_t> &addedIds, size_t median_size, size_t maxCumulativeSize, size_t &total_size, uint64_t &fee);
+
+    // Changes with every transaction added to or removed from the pool.
+    uint64_t getRevision() const;
+    // Ids added after the given revision; fails if anything was removed since, or if it is too old to tell.
+    bool getAddedSince(uint64_t revision, std::vector<hash_t> &addedIds) const;
 
     void get_transactions(std::list<transaction_t> &txs) const;
-    void get_difference(const std::vector<hash_t> &known_tx_ids, std::vector<hash_t> &new_tx_ids, std::vector<hash_t> &deleted_tx_ids) const;
+    void get_difference(const std::vector<hash_t> &known_tx_ids, std::vector<hash_t> &new_tx_ids, std::vector<hash_t> &deleted_tx_ids);
+    // Ready transactions that became ready or stopped being so after the given sequence number,
+    // the net change for each; fails if the change log no longer goes back that far.
+    bool get_changes_since(uint64_t sequence, std::vector<hash_t> &new_tx_ids, std::vector<hash_t> &deleted_tx_ids);
+    // Sequence number of the last change of ready transactions, after checking those not checked yet.
+    uint64_t get_sequence();
     size_t get_transactions_count() const;
+    // Bytes of transaction blobs in the pool, kept under Currency::mempoolMaxSize by evicting the
+    // transactions paying the least per byte.
+    size_t get_transactions_size() const;
+    uint64_t get_evicted_transactions_count() const;
     std::string print_pool(bool short_format) const;
     void on_idle();
 
@@ -110,6 +135,18 @@ namespace cryptonote
                                   indexed_by<main_index_t, fee_index_t>>
         tx_container_t;
 
+    // transaction_priority_comparator_t order, ties broken by address so that the set is unique
+    struct ready_transaction_comparator_t
+    {
+      bool operator()(const transaction_details_t *lhs, const transaction_details_t *rhs) const
+      {
+        transaction_priority_comparator_t comparator;
+        return comparator(*lhs, *rhs) || (!comparator(*rhs, *lhs) && std::less<const transaction_details_t *>()(lhs, rhs));
+      }
+    };
+
+    typedef std::set<const transaction_details_t *, ready_transaction_comparator_t> ready_transactions_t;
+
     typedef std::pair<uint64_t, uint64_t> global_output_t;
     typedef std::set<global_output_t> global_output_container_t;
     typedef std::unordered_map<key_image_t, std::unordered_set<hash_t>> key_images_container_t;
@@ -119,15 +156,37 @@ namespace cryptonote
     bool haveSpentInputs(const transaction_t &tx) const;
     bool removeTransactionInputs(const hash_t &id, const transaction_t &tx, bool keptByBlock);
 
+    bool addTransaction(const transaction_t &tx, const hash_t &id, size_t blobSize, tx_verification_context_t &tvc, bool keptByBlock, block_info_t maxUsedBlock);
     tx_container_t::iterator removeTransaction(tx_container_t::iterator i);
     bool removeExpiredTransactions();
+    // Writes the pool on a background thread if it changed since the last snapshot and the last write is done.
+    bool startSnapshot();
+    void waitForSnapshot();
+    // Evicts transactions paying less per byte than fee / blobSize until blobSize more bytes fit.
+    bool makeRoom(size_t blobSize, uint64_t fee);
+    void shrinkToMaxSize();
+    // Removes the transactions as evicted. Unlike expired ones they are taken back as soon as the pool
+    // has room for them, or after a few minutes even if it has to evict for them again.
+    void evictTransactions(const std::vector<hash_t> &ids);
+    bool isTransactionRecentlyEvicted(const hash_t &id, size_t blobSize);
+    void addRecentlyDeletedTransaction(const hash_t &id, uint64_t time);
+    void buildRecentlyDeletedOrder();
     bool is_transaction_ready_to_go(const transaction_t &tx, transaction_check_info_t &txd) const;
 
+    // Checks the transactions whose readiness is unknown and files them as ready or not ready.
+    void updateReadiness();
+    void markUnchecked(const hash_t &id);
+    void markSpendersUnchecked(const std::vector<transaction_t> &transactions);
+    // Logs id as added or deleted if that differs from what was last logged for it.
+    void logChange(const hash_t &id, bool ready);
+    void resetChanges();
+
     void buildIndices();
 
     Tools::ObserverManager<ITxPoolObserver> m_observerManager;
     const cryptonote::Currency &m_currency;
     OnceInTimeInterval m_txCheckInterval;
+    OnceInTimeInterval m_snapshotInterval;
     mutable std::recursive_mutex m_transactions_lock;
     key_images_container_t m_spent_key_images;
     global_output_container_t m_spentOutputs;
@@ -139,6 +198,40 @@ namespace cryptonote
     tx_container_t m_transactions;
     tx_container_t::nth_index<1>::type &m_fee_index;
     std::unordered_map<hash_t, uint64_t> m_recentlyDeletedTransactions;
+    // deletion order of m_recentlyDeletedTransactions, to forget the oldest first when it is full
+    std::deque<std::pair<uint64_t, hash_t>> m_recentlyDeletedOrder;
+    // evicted for size -> eviction time, forgotten after a few minutes
+    std::unordered_map<hash_t, uint64_t> m_recentlyEvictedTransactions;
+    size_t m_totalSize;
+    uint64_t m_evictedCount;
+
+    // Every pool transaction is in exactly one of these. Ready ones are kept in fee-per-byte order
+    // so that templates are filled without going back to the blockchain.
+    ready_transactions_t m_readyTransactions;
+    std::unordered_set<hash_t> m_notReadyTransactions;
+    std::unordered_set<hash_t> m_uncheckedTransactions;
+
+    uint64_t m_revision;
+    uint64_t m_lastRemovalRevision;
+    std::deque<std::pair<uint64_t, hash_t>> m_recentlyAdded;
+
+    struct pool_change_t
+    {
+      uint64_t sequence;
+      hash_t id;
+      bool added;
+    };
+
+    // What get_difference callers were told: ids logged as added and not deleted since, and the
+    // log of that from m_firstSequence (exclusive) to m_sequence.
+    std::unordered_set<hash_t> m_loggedTransactions;
+    std::deque<pool_change_t> m_changes;
+    uint64_t m_firstSequence;
+    uint64_t m_sequence;
+
+    // m_revision as of the last snapshot started or loaded, and the write of the one started
+    uint64_t m_snapshotRevision;
+    std::future<bool> m_snapshot;
 
     Logging::LoggerRef logger;
 
@@ -65,6 +65,38 @@ namespace cryptonote
     }
   };
 
+  // Just enough of a transaction for a wallet to spot its incoming key outputs: no inputs, no signatures.
+  // Vectors are parallel, one element per key output, outputIndexes hold positions in the transaction.
+  struct transaction_sync_summary_t {
+    hash_t txHash;
+    public_key_t txPublicKey;
+    std::vector<uint16_t> outputIndexes;
+    std::vector<public_key_t> outputKeys;
+    std::vector<uint64_t> amounts;
+    std::vector<uint32_t> globalIndexes;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(txHash);
+      KV_MEMBER(txPublicKey);
+      serializeAsBinary(outputIndexes, "outputIndexes", s);
+      serializeAsBinary(outputKeys, "outputKeys", s);
+      serializeAsBinary(amounts, "amounts", s);
+      serializeAsBinary(globalIndexes, "globalIndexes", s);
+    }
+  };
+
+  struct block_sync_summary_t {
+    hash_t blockHash;
+    uint64_t timestamp;
+    std::vector<transaction_sync_summary_t> transactions;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(blockHash);
+      KV_MEMBER(timestamp);
+      KV_MEMBER(transactions);
+    }
+  };
+
   /************************************************************************/
   /*                                                                      */
   /************************************************************************/
@@ -276,9 +276,17 @@ int CryptoNoteProtocolHandler::handle_notify_new_transactions(int command, NOTIF
   if (context.m_state != CryptoNoteConnectionContext::state_normal)
     return 1;
 
-  for (auto tx_blob_it = arg.txs.begin(); tx_blob_it != arg.txs.end();) {
-    cryptonote::tx_verification_context_t tvc = boost::value_initialized<decltype(tvc)>();
-    m_core.handle_incoming_tx(IBinary::from(*tx_blob_it), tvc, false);
+  std::vector<binary_array_t> txBlobs;
+  txBlobs.reserve(arg.txs.size());
+  for (const auto& txBlob : arg.txs) {
+    txBlobs.push_back(IBinary::from(txBlob));
+  }
+
+  std::vector<cryptonote::tx_verification_context_t> tvcs;
+  m_core.handleIncomingTransactions(txBlobs, tvcs);
+
+  auto tx_blob_it = arg.txs.begin();
+  for (const auto& tvc : tvcs) {
     if (tvc.m_verifivation_failed) {
       logger(Logging::INFO) << context << "Tx verification failed";
     }
@@ -53,6 +53,45 @@ bool Block::getLongHash(const block_t& b, hash_t& res) {
   return true;
 }
 
+const size_t BlockHashingBlob::MINING_HASH_COUNT;
+
+bool BlockHashingBlob::init(const block_t& block) {
+  size_t headerSize;
+  if (!BinaryArray::size(static_cast<const block_header_t&>(block), headerSize) || !Block::getBlob(block, m_blob)) {
+    return false;
+  }
+
+  m_blobs.clear();
+  m_nonceOffset = headerSize - sizeof(block.nonce);
+  m_variant = HardFork(config::get().hardforks).getCNVariant(block);
+  return true;
+}
+
+void BlockHashingBlob::setNonce(uint32_t nonce) {
+  memcpy(&m_blob[m_nonceOffset], &nonce, sizeof(nonce));
+}
+
+void BlockHashingBlob::getLongHash(hash_t& res) const {
+  cn_slow_hash(m_blob.data(), m_blob.size(), (char *)&res, m_variant, 0);
+}
+
+void BlockHashingBlob::getLongHashes(uint32_t nonce, uint32_t step, size_t count, hash_t* res) {
+  assert(count <= SLOW_HASH_MULTI_MAX);
+  if (m_blobs.size() < count) {
+    m_blobs.resize(count, m_blob);
+  }
+
+  const void* data[SLOW_HASH_MULTI_MAX];
+  char* hashes[SLOW_HASH_MULTI_MAX];
+  for (size_t i = 0; i < count; ++i, nonce += step) {
+    memcpy(&m_blobs[i][m_nonceOffset], &nonce, sizeof(nonce));
+    data[i] = m_blobs[i].data();
+    hashes[i] = (char *)&res[i];
+  }
+
+  cn_slow_hash_multi(data, m_blob.size(), count, hashes, m_variant);
+}
+
 bool Block::getHash(const block_t& block, hash_t& hash) {
   binary_array_t ba;
   if (!Block::getBlob(block, ba)) {
@@ -32,4 +32,28 @@ namespace cryptonote
   private:
     block_entry_t m_block;
   };
+
+  // What Block::getLongHash hashes, prepared once per block template: the nonce is the last field of
+  // the header, so trying another one only patches those four bytes before the slow hash.
+  class BlockHashingBlob
+  {
+  public:
+    // Hashes miners compute at a time: two scratchpads per thread still fit the cache share of a
+    // core on most CPUs, more than that usually gets slower.
+    static const size_t MINING_HASH_COUNT = 2;
+
+    bool init(const block_t &block);
+    void setNonce(uint32_t nonce);
+    // Block::getLongHash of the block with the nonce last set
+    void getLongHash(hash_t &res) const;
+    // Block::getLongHash of the block with nonces nonce, nonce + step and so on, count of them (at
+    // most SLOW_HASH_MULTI_MAX) computed side by side by cn_slow_hash_multi.
+    void getLongHashes(uint32_t nonce, uint32_t step, size_t count, hash_t *res);
+
+  private:
+    binary_array_t m_blob;
+    std::vector<binary_array_t> m_blobs;
+    size_t m_nonceOffset;
+    int m_variant;
+  };
 } // namespace cryptonote
\ No newline at end of file
@@ -139,6 +139,7 @@ int main(int argc, char *argv[])
 
     //create objects and link them
     cryptonote::CurrencyBuilder currencyBuilder(coreConfig.getDir(), config::get(), logManager);
+    currencyBuilder.mempoolMaxSize(get_arg(vm, arg_mempool_max_size));
 
     try
     {
@@ -53,6 +53,12 @@ void HttpParser::receiveRequest(std::istream& stream, HttpRequest& request) {
 
 
 void HttpParser::receiveResponse(std::istream& stream, HttpResponse& response) {
+  std::string body;
+  receiveResponse(stream, response, [&body](const std::string& data) { body += data; });
+  response.setBody(body);
+}
+
+void HttpParser::receiveResponse(std::istream& stream, HttpResponse& response, const BodyHandler& bodyHandler) {
   std::string httpVersion;
   readWord(stream, httpVersion);
   
@@ -86,19 +92,24 @@ void HttpParser::receiveResponse(std::istream& stream, HttpResponse& response) {
   }
 
   response.addHeader(name, value);
-  auto headers = response.getHeaders();
+  const auto& headers = response.getHeaders();
+  auto it = headers.find("transfer-encoding");
+  if (it != headers.end() && it->second == "chunked") {
+    readChunkedBody(stream, bodyHandler);
+    return;
+  }
+
   size_t length = 0;
-  auto it = headers.find("content-length");
+  it = headers.find("content-length");
   if (it != headers.end()) {
     length = std::stoul(it->second);
   }
   
-  std::string body;
   if (length) {
+    std::string body;
     readBody(stream, body, length);
+    bodyHandler(body);
   }
-
-  response.setBody(body);
 }
 
 
@@ -208,4 +219,60 @@ void HttpParser::readBody(std::istream& stream, std::string& body, const size_t
   throwIfNotGood(stream);
 }
 
+void HttpParser::readChunkedBody(std::istream& stream, const BodyHandler& bodyHandler) {
+  std::string line;
+  std::string chunk;
+
+  for (;;) {
+    line.clear();
+    readLine(stream, line);
+
+    size_t chunkSize;
+    try {
+      chunkSize = std::stoul(line.substr(0, line.find(';')), nullptr, 16);
+    } catch (std::exception&) {
+      throw std::system_error(make_error_code(cryptonote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+    }
+
+    if (chunkSize == 0) {
+      break;
+    }
+
+    chunk.resize(chunkSize);
+    stream.read(&chunk[0], chunkSize);
+    throwIfNotGood(stream);
+
+    line.clear();
+    readLine(stream, line);
+    if (!line.empty()) {
+      throw std::system_error(make_error_code(cryptonote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+    }
+
+    bodyHandler(chunk);
+  }
+
+  //skip trailer headers
+  do {
+    line.clear();
+    readLine(stream, line);
+  } while (!line.empty());
+}
+
+void HttpParser::readLine(std::istream& stream, std::string& line) {
+  char c;
+
+  stream.get(c);
+  while (stream.good() && c != '\r') {
+    line += c;
+    stream.get(c);
+  }
+
+  throwIfNotGood(stream);
+
+  stream.get(c);
+  if (c != '\n') {
+    throw std::system_error(make_error_code(cryptonote::error::HttpParserErrorCodes::UNEXPECTED_SYMBOL));
+  }
+}
+
 }
@@ -5,6 +5,7 @@
 #ifndef HTTPPARSER_H_
 #define HTTPPARSER_H_
 
+#include <functional>
 #include <iostream>
 #include <map>
 #include <string>
@@ -16,10 +17,14 @@ namespace cryptonote {
 //Blocking HttpParser
 class HttpParser {
 public:
+  // Receives response body data as it arrives, one chunk at a time.
+  typedef std::function<void(const std::string& data)> BodyHandler;
+
   HttpParser() {};
 
   void receiveRequest(std::istream& stream, HttpRequest& request);
   void receiveResponse(std::istream& stream, HttpResponse& response);
+  void receiveResponse(std::istream& stream, HttpResponse& response, const BodyHandler& bodyHandler);
   static HttpResponse::HTTP_STATUS parseResponseStatusFromString(const std::string& status);
 private:
   void readWord(std::istream& stream, std::string& word);
@@ -27,6 +32,8 @@ private:
   bool readHeader(std::istream& stream, std::string& name, std::string& value);
   size_t getBodyLen(const HttpRequest::Headers& headers);
   void readBody(std::istream& stream, std::string& body, const size_t bodyLen);
+  void readChunkedBody(std::istream& stream, const BodyHandler& bodyHandler);
+  void readLine(std::istream& stream, std::string& line);
 };
 
 } //namespace cryptonote
@@ -5,9 +5,53 @@
 #include "HttpResponse.h"
 
 #include <stdexcept>
+#include <streambuf>
+#include <vector>
 
 namespace {
 
+const size_t STREAMED_CHUNK_SIZE = 16 * 1024;
+
+// Frames everything written through it as chunks of the underlying stream.
+class ChunkedStreambuf : public std::streambuf {
+public:
+  explicit ChunkedStreambuf(std::ostream& out) : out(out), buffer(STREAMED_CHUNK_SIZE) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+  }
+
+protected:
+  virtual int_type overflow(int_type ch) override {
+    writeChunk();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+  }
+
+  virtual int sync() override {
+    writeChunk();
+    return out ? 0 : -1;
+  }
+
+private:
+  void writeChunk() {
+    std::ptrdiff_t size = pptr() - pbase();
+    if (size > 0) {
+      out << std::hex << size << std::dec << "\r\n";
+      out.write(pbase(), size);
+      out << "\r\n";
+      out.flush();
+    }
+
+    setp(buffer.data(), buffer.data() + buffer.size());
+  }
+
+  std::ostream& out;
+  std::vector<char> buffer;
+};
+
 const char* getStatusString(cryptonote::HttpResponse::HTTP_STATUS status) {
   switch (status) {
   case cryptonote::HttpResponse::STATUS_200:
@@ -58,6 +102,10 @@ void HttpResponse::addHeader(const std::string& name, const std::string& value)
 }
 
 void HttpResponse::setBody(const std::string& b) {
+  chunkProducer = nullptr;
+  bodyWriter = nullptr;
+  headers.erase("Transfer-Encoding");
+
   body = b;
   if (!body.empty()) {
     headers["Content-Length"] = std::to_string(body.size());
@@ -66,6 +114,22 @@ void HttpResponse::setBody(const std::string& b) {
   }
 }
 
+void HttpResponse::setChunkedBody(const ChunkProducer& producer) {
+  body.clear();
+  headers.erase("Content-Length");
+  headers["Transfer-Encoding"] = "chunked";
+  bodyWriter = nullptr;
+  chunkProducer = producer;
+}
+
+void HttpResponse::setStreamedBody(const BodyWriter& writer) {
+  body.clear();
+  headers.erase("Content-Length");
+  headers["Transfer-Encoding"] = "chunked";
+  chunkProducer = nullptr;
+  bodyWriter = writer;
+}
+
 std::ostream& HttpResponse::printHttpResponse(std::ostream& os) const {
   os << "HTTP/1.1 " << getStatusString(status) << "\r\n";
 
@@ -74,7 +138,25 @@ std::ostream& HttpResponse::printHttpResponse(std::ostream& os) const {
   }
   os << "\r\n";
 
-  if (!body.empty()) {
+  if (chunkProducer) {
+    std::string chunk;
+    while (chunkProducer(chunk)) {
+      if (!chunk.empty()) {
+        os << std::hex << chunk.size() << std::dec << "\r\n" << chunk << "\r\n";
+        os.flush();
+        chunk.clear();
+      }
+    }
+
+    os << "0\r\n\r\n";
+  } else if (bodyWriter) {
+    ChunkedStreambuf chunkedBuffer(os);
+    std::ostream chunkedStream(&chunkedBuffer);
+    bodyWriter(chunkedStream);
+    chunkedStream.flush();
+
+    os << "0\r\n\r\n";
+  } else if (!body.empty()) {
     os << body;
   }
 
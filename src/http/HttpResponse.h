@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <ostream>
 #include <string>
 #include <map>
@@ -18,15 +19,24 @@ namespace cryptonote {
       STATUS_500
     };
 
+    // Fills the next chunk of a chunked body; returns false once the body is complete.
+    typedef std::function<bool(std::string& chunk)> ChunkProducer;
+    // Writes the whole body at once; the stream is sent out in chunks as its buffer fills up. An exception
+    // thrown by the writer leaves the body without its last chunk, the server then drops the connection.
+    typedef std::function<void(std::ostream& body)> BodyWriter;
+
     HttpResponse();
 
     void setStatus(HTTP_STATUS s);
     void addHeader(const std::string& name, const std::string& value);
     void setBody(const std::string& b);
+    void setChunkedBody(const ChunkProducer& producer);
+    void setStreamedBody(const BodyWriter& writer);
 
     const std::map<std::string, std::string>& getHeaders() const { return headers; }
     HTTP_STATUS getStatus() const { return status; }
     const std::string& getBody() const { return body; }
+    bool isChunked() const { return static_cast<bool>(chunkProducer) || static_cast<bool>(bodyWriter); }
 
   private:
     friend std::ostream& operator<<(std::ostream& os, const HttpResponse& resp);
@@ -35,6 +45,8 @@ namespace cryptonote {
     HTTP_STATUS status;
     std::map<std::string, std::string> headers;
     std::string body;
+    ChunkProducer chunkProducer;
+    BodyWriter bodyWriter;
   };
 
   inline std::ostream& operator<<(std::ostream& os, const HttpResponse& resp) {
@@ -9,6 +9,7 @@
 #include "cryptonote/crypto/crypto.h"
 #include "cryptonote/core/CryptoNoteFormatUtils.h"
 #include "cryptonote/structures/block_entry.h"
+#include "common/ScopeExit.h"
 #include <system/InterruptedException.h>
 
 namespace cryptonote {
@@ -84,31 +85,39 @@ void Miner::runWorkers(BlockMiningParameters blockMiningParameters, size_t threa
 }
 
 void Miner::workerFunc(const block_t& blockTemplate, difficulty_t difficulty, uint32_t nonceStep) {
+  // each worker runs on a thread of its own that ends with it, so its hashing scratchpads are freed here
+  Tools::ScopeExit freeHashState([] { slow_hash_free_state(); });
+
   try {
     block_t block = blockTemplate;
+    BlockHashingBlob blob;
+    if (!blob.init(block)) {
+      //error occured
+      m_logger(Logging::DEBUGGING) << "calculating long hash error occured";
+      m_state = MiningState::MINING_STOPPED;
+      return;
+    }
 
     while (m_state == MiningState::MINING_IN_PROGRESS) {
-      hash_t hash;
-      if (!Block::getLongHash(block, hash)) {
-        //error occured
-        m_logger(Logging::DEBUGGING) << "calculating long hash error occured";
-        m_state = MiningState::MINING_STOPPED;
-        return;
-      }
+      hash_t hashes[BlockHashingBlob::MINING_HASH_COUNT];
+      blob.getLongHashes(block.nonce, nonceStep, BlockHashingBlob::MINING_HASH_COUNT, hashes);
 
-      if (check_hash(&hash, difficulty)) {
-        m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
+      for (size_t i = 0; i < BlockHashingBlob::MINING_HASH_COUNT; ++i) {
+        if (check_hash(&hashes[i], difficulty)) {
+          m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
 
-        if (!setStateBlockFound()) {
-          m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+          if (!setStateBlockFound()) {
+            m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+            return;
+          }
+
+          m_block = block;
+          m_block.nonce += static_cast<uint32_t>(i) * nonceStep;
           return;
         }
-
-        m_block = block;
-        return;
       }
 
-      block.nonce += nonceStep;
+      block.nonce += static_cast<uint32_t>(BlockHashingBlob::MINING_HASH_COUNT) * nonceStep;
     }
   } catch (std::exception& e) {
     m_logger(Logging::ERROR) << "Miner got error: " << e.what();
@@ -12,7 +12,7 @@ namespace PaymentService {
 
 class NodeFactory {
 public:
-  static cryptonote::INode* createNode(const std::string& daemonAddress, uint16_t daemonPort);
+  static cryptonote::INode* createNode(const std::string& daemonAddress, uint16_t daemonPort, size_t connectionCount);
   static cryptonote::INode* createNodeStub();
 private:
   NodeFactory();
@@ -170,6 +170,18 @@ void GetTransactions::Response::serialize(cryptonote::ISerializer& serializer) {
   serializer(items, "items");
 }
 
+void GetTransactionsByPaymentId::Request::serialize(cryptonote::ISerializer& serializer) {
+  if (!serializer(paymentId, "paymentId")) {
+    throw RequestSerializationError();
+  }
+
+  serializer(addresses, "addresses");
+}
+
+void GetTransactionsByPaymentId::Response::serialize(cryptonote::ISerializer& serializer) {
+  serializer(items, "items");
+}
+
 void GetUnconfirmedTransactionHashes::Request::serialize(cryptonote::ISerializer& serializer) {
   serializer(addresses, "addresses");
 }
@@ -218,6 +230,22 @@ void SendTransaction::Response::serialize(cryptonote::ISerializer& serializer) {
   serializer(transactionHash, "transactionHash");
 }
 
+void SendTransactionResult::serialize(cryptonote::ISerializer& serializer) {
+  serializer(transactionHash, "transactionHash");
+  serializer(errorCode, "errorCode");
+  serializer(errorMessage, "errorMessage");
+}
+
+void SendTransactions::Request::serialize(cryptonote::ISerializer& serializer) {
+  if (!serializer(transactions, "transactions")) {
+    throw RequestSerializationError();
+  }
+}
+
+void SendTransactions::Response::serialize(cryptonote::ISerializer& serializer) {
+  serializer(results, "results");
+}
+
 void CreateDelayedTransaction::Request::serialize(cryptonote::ISerializer& serializer) {
   serializer(addresses, "addresses");
 
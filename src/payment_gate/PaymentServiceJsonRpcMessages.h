@@ -230,6 +230,21 @@ struct GetTransactions {
   };
 };
 
+struct GetTransactionsByPaymentId {
+  struct Request {
+    std::string paymentId;
+    std::vector<std::string> addresses;
+
+    void serialize(cryptonote::ISerializer& serializer);
+  };
+
+  struct Response {
+    std::vector<TransactionsInBlockRpcInfo> items;
+
+    void serialize(cryptonote::ISerializer& serializer);
+  };
+};
+
 struct GetUnconfirmedTransactionHashes {
   struct Request {
     std::vector<std::string> addresses;
@@ -272,6 +287,28 @@ struct SendTransaction {
   };
 };
 
+struct SendTransactionResult {
+  std::string transactionHash;
+  int32_t errorCode = 0;
+  std::string errorMessage;
+
+  void serialize(cryptonote::ISerializer& serializer);
+};
+
+struct SendTransactions {
+  struct Request {
+    std::vector<SendTransaction::Request> transactions;
+
+    void serialize(cryptonote::ISerializer& serializer);
+  };
+
+  struct Response {
+    std::vector<SendTransactionResult> results;
+
+    void serialize(cryptonote::ISerializer& serializer);
+  };
+};
+
 struct CreateDelayedTransaction {
   struct Request {
     std::vector<std::string> addresses;
@@ -25,11 +25,13 @@ PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher& sys
   handlers.emplace("getSpendKeys", jsonHandler<GetSpendKeys::Request, GetSpendKeys::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetSpendKeys, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getBalance", jsonHandler<GetBalance::Request, GetBalance::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetBalance, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getBlockHashes", jsonHandler<GetBlockHashes::Request, GetBlockHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetBlockHashes, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getTransactionHashes", jsonHandler<GetTransactionHashes::Request, GetTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
-  handlers.emplace("getTransactions", jsonHandler<GetTransactions::Request, GetTransactions::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactions, this, std::placeholders::_1, std::placeholders::_2)));
+  handlers.emplace("getTransactionHashes", streamingJsonHandler<GetTransactionHashes::Request, TransactionHashesInBlockRpcInfo>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
+  handlers.emplace("getTransactions", streamingJsonHandler<GetTransactions::Request, TransactionsInBlockRpcInfo>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactions, this, std::placeholders::_1, std::placeholders::_2)));
+  handlers.emplace("getTransactionsByPaymentId", streamingJsonHandler<GetTransactionsByPaymentId::Request, TransactionsInBlockRpcInfo>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransactionsByPaymentId, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getUnconfirmedTransactionHashes", jsonHandler<GetUnconfirmedTransactionHashes::Request, GetUnconfirmedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetUnconfirmedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getTransaction", jsonHandler<GetTransaction::Request, GetTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransaction, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("sendTransaction", jsonHandler<SendTransaction::Request, SendTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendTransaction, this, std::placeholders::_1, std::placeholders::_2)));
+  handlers.emplace("sendTransactions", jsonHandler<SendTransactions::Request, SendTransactions::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendTransactions, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("createDelayedTransaction", jsonHandler<CreateDelayedTransaction::Request, CreateDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getDelayedTransactionHashes", jsonHandler<GetDelayedTransactionHashes::Request, GetDelayedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetDelayedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("deleteDelayedTransaction", jsonHandler<DeleteDelayedTransaction::Request, DeleteDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleDeleteDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2)));
@@ -39,7 +41,7 @@ PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher& sys
   handlers.emplace("getAddresses", jsonHandler<GetAddresses::Request, GetAddresses::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetAddresses, this, std::placeholders::_1, std::placeholders::_2)));
 }
 
-void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) {
+void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp, ResultWriter& resultWriter) {
   try {
     prepareJsonResponse(req, resp);
 
@@ -71,7 +73,7 @@ void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue&
       params = req("params");
     }
 
-    it->second(params, resp);
+    it->second(params, resp, resultWriter);
   } catch (std::exception& e) {
     logger(Logging::WARNING) << "Error occurred while processing JsonRpc request: " << e.what();
     makeGenericErrorReponse(resp, e.what());
@@ -116,22 +118,26 @@ std::error_code PaymentServiceJsonRpcServer::handleGetBlockHashes(const GetBlock
   return service.getBlockHashes(request.firstBlockIndex, request.blockCount, response.blockHashes);
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetTransactionHashes(const GetTransactionHashes::Request& request, GetTransactionHashes::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetTransactionHashes(const GetTransactionHashes::Request& request, WalletService::TransactionHashesReader& reader) {
   if (!request.blockHash.empty()) {
-    return service.getTransactionHashes(request.addresses, request.blockHash, request.blockCount, request.paymentId, response.items);
+    return service.getTransactionHashes(request.addresses, request.blockHash, request.blockCount, request.paymentId, reader);
   } else {
-    return service.getTransactionHashes(request.addresses, request.firstBlockIndex, request.blockCount, request.paymentId, response.items);
+    return service.getTransactionHashes(request.addresses, request.firstBlockIndex, request.blockCount, request.paymentId, reader);
   }
 }
 
-std::error_code PaymentServiceJsonRpcServer::handleGetTransactions(const GetTransactions::Request& request, GetTransactions::Response& response) {
+std::error_code PaymentServiceJsonRpcServer::handleGetTransactions(const GetTransactions::Request& request, WalletService::TransactionsReader& reader) {
   if (!request.blockHash.empty()) {
-    return service.getTransactions(request.addresses, request.blockHash, request.blockCount, request.paymentId, response.items);
+    return service.getTransactions(request.addresses, request.blockHash, request.blockCount, request.paymentId, reader);
   } else {
-    return service.getTransactions(request.addresses, request.firstBlockIndex, request.blockCount, request.paymentId, response.items);
+    return service.getTransactions(request.addresses, request.firstBlockIndex, request.blockCount, request.paymentId, reader);
   }
 }
 
+std::error_code PaymentServiceJsonRpcServer::handleGetTransactionsByPaymentId(const GetTransactionsByPaymentId::Request& request, WalletService::TransactionsReader& reader) {
+  return service.getTransactionsByPaymentId(request.paymentId, request.addresses, reader);
+}
+
 std::error_code PaymentServiceJsonRpcServer::handleGetUnconfirmedTransactionHashes(const GetUnconfirmedTransactionHashes::Request& request, GetUnconfirmedTransactionHashes::Response& response) {
   return service.getUnconfirmedTransactionHashes(request.addresses, response.transactionHashes);
 }
@@ -144,6 +150,10 @@ std::error_code PaymentServiceJsonRpcServer::handleSendTransaction(const SendTra
   return service.sendTransaction(request, response.transactionHash);
 }
 
+std::error_code PaymentServiceJsonRpcServer::handleSendTransactions(const SendTransactions::Request& request, SendTransactions::Response& response) {
+  return service.sendTransactions(request, response.results);
+}
+
 std::error_code PaymentServiceJsonRpcServer::handleCreateDelayedTransaction(const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response) {
   return service.createDelayedTransaction(request, response.transactionHash);
 }
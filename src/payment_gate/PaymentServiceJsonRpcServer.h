@@ -4,35 +4,35 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 
 #include "common/JsonValue.h"
 #include "JsonRpcServer/JsonRpcServer.h"
 #include "PaymentServiceJsonRpcMessages.h"
+#include "WalletService.h"
 #include "serialization/JsonInputValueSerializer.h"
 #include "serialization/JsonOutputStreamSerializer.h"
 
 namespace PaymentService {
 
-class WalletService;
-
 class PaymentServiceJsonRpcServer : public cryptonote::JsonRpcServer {
 public:
   PaymentServiceJsonRpcServer(System::Dispatcher& sys, System::Event& stopEvent, WalletService& service, Logging::ILogger& loggerGroup);
   PaymentServiceJsonRpcServer(const PaymentServiceJsonRpcServer&) = delete;
 
 protected:
-  virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) override;
+  virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp, ResultWriter& resultWriter) override;
 
 private:
   WalletService& service;
   Logging::LoggerRef logger;
 
-  typedef std::function<void (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse)> HandlerFunction;
+  typedef std::function<void (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse, ResultWriter& resultWriter)> HandlerFunction;
 
   template <typename RequestType, typename ResponseType, typename RequestHandler>
   HandlerFunction jsonHandler(RequestHandler handler) {
-    return [handler] (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse) mutable {
+    return [handler] (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse, ResultWriter&) mutable {
       RequestType request;
       ResponseType response;
 
@@ -56,6 +56,47 @@ private:
     };
   }
 
+  // Same as jsonHandler, but for responses made of the "items" a range of blocks yields: the handler only checks the request
+  // and hands a reader over, each slice it reads is serialized straight into the http body before the next one is read.
+  template <typename RequestType, typename RpcBlock, typename RequestHandler>
+  HandlerFunction streamingJsonHandler(RequestHandler handler) {
+    return [handler] (const Common::JsonValue& jsonRpcParams, Common::JsonValue& jsonResponse, ResultWriter& resultWriter) mutable {
+      RequestType request;
+      std::function<bool(std::vector<RpcBlock>& blocks)> reader;
+
+      try {
+        cryptonote::JsonInputValueSerializer inputSerializer(const_cast<Common::JsonValue&>(jsonRpcParams));
+        serialize(request, inputSerializer);
+      } catch (std::exception&) {
+        makeGenericErrorReponse(jsonResponse, "Invalid Request", -32600);
+        return;
+      }
+
+      std::error_code ec = handler(request, reader);
+      if (ec) {
+        makeErrorResponse(ec, jsonResponse);
+        return;
+      }
+
+      resultWriter = [reader] (std::ostream& out) mutable {
+        cryptonote::JsonOutputStreamSerializer outputSerializer(out);
+        size_t size = 0;
+        outputSerializer.beginArray(size, "items");
+
+        std::vector<RpcBlock> blocks;
+        while (out && reader(blocks)) {
+          for (auto& block : blocks) {
+            outputSerializer(block, "");
+          }
+
+          blocks.clear();
+        }
+
+        outputSerializer.endArray();
+      };
+    };
+  }
+
   std::unordered_map<std::string, HandlerFunction> handlers;
 
   std::error_code handleReset(const Reset::Request& request, Reset::Response& response);
@@ -64,11 +105,13 @@ private:
   std::error_code handleGetSpendKeys(const GetSpendKeys::Request& request, GetSpendKeys::Response& response);
   std::error_code handleGetBalance(const GetBalance::Request& request, GetBalance::Response& response);
   std::error_code handleGetBlockHashes(const GetBlockHashes::Request& request, GetBlockHashes::Response& response);
-  std::error_code handleGetTransactionHashes(const GetTransactionHashes::Request& request, GetTransactionHashes::Response& response);
-  std::error_code handleGetTransactions(const GetTransactions::Request& request, GetTransactions::Response& response);
+  std::error_code handleGetTransactionHashes(const GetTransactionHashes::Request& request, WalletService::TransactionHashesReader& reader);
+  std::error_code handleGetTransactions(const GetTransactions::Request& request, WalletService::TransactionsReader& reader);
+  std::error_code handleGetTransactionsByPaymentId(const GetTransactionsByPaymentId::Request& request, WalletService::TransactionsReader& reader);
   std::error_code handleGetUnconfirmedTransactionHashes(const GetUnconfirmedTransactionHashes::Request& request, GetUnconfirmedTransactionHashes::Response& response);
   std::error_code handleGetTransaction(const GetTransaction::Request& request, GetTransaction::Response& response);
   std::error_code handleSendTransaction(const SendTransaction::Request& request, SendTransaction::Response& response);
+  std::error_code handleSendTransactions(const SendTransactions::Request& request, SendTransactions::Response& response);
   std::error_code handleCreateDelayedTransaction(const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response);
   std::error_code handleGetDelayedTransactionHashes(const GetDelayedTransactionHashes::Request& request, GetDelayedTransactionHashes::Response& response);
   std::error_code handleDeleteDelayedTransaction(const DeleteDelayedTransaction::Request& request, DeleteDelayedTransaction::Response& response);
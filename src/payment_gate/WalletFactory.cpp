@@ -21,8 +21,10 @@ WalletFactory::WalletFactory() {
 WalletFactory::~WalletFactory() {
 }
 
-cryptonote::IWallet* WalletFactory::createWallet(const cryptonote::Currency& currency, cryptonote::INode& node, System::Dispatcher& dispatcher) {
-  cryptonote::IWallet* wallet = new cryptonote::WalletGreen(dispatcher, currency, node);
+cryptonote::IWallet* WalletFactory::createWallet(const cryptonote::Currency& currency, cryptonote::INode& node, System::Dispatcher& dispatcher,
+  const cryptonote::DecoyCachePolicy& decoyCachePolicy) {
+  cryptonote::WalletGreen* wallet = new cryptonote::WalletGreen(dispatcher, currency, node);
+  wallet->setDecoyCachePolicy(decoyCachePolicy);
   return wallet;
 }
 
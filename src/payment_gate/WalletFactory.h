@@ -6,6 +6,7 @@
 
 #include "IWallet.h"
 #include "INode.h"
+#include "wallet/WalletDecoyCache.h"
 #include <system/Dispatcher.h>
 
 #include <string>
@@ -19,7 +20,8 @@ namespace PaymentService {
 
 class WalletFactory {
 public:
-  static cryptonote::IWallet* createWallet(const cryptonote::Currency& currency, cryptonote::INode& node, System::Dispatcher& dispatcher);
+  static cryptonote::IWallet* createWallet(const cryptonote::Currency& currency, cryptonote::INode& node, System::Dispatcher& dispatcher,
+    const cryptonote::DecoyCachePolicy& decoyCachePolicy = cryptonote::DecoyCachePolicy());
 private:
   WalletFactory();
   ~WalletFactory();
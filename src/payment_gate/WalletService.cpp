@@ -6,6 +6,8 @@
 
 
 #include <future>
+#include <iterator>
+#include <memory>
 #include <assert.h>
 #include <sstream>
 #include <unordered_set>
@@ -37,6 +39,11 @@ namespace PaymentService {
 
 namespace {
 
+// Blocks a range is read from the wallet in, one slice is written out before the next one is read
+const size_t BLOCKS_PER_READ = 100;
+
+const std::chrono::seconds WALLET_AUTOSAVE_INTERVAL(60);
+
 bool checkPaymentId(const std::string& paymentId) {
   if (paymentId.size() != 64) {
     return false;
@@ -290,6 +297,26 @@ std::vector<PaymentService::TransactionHashesInBlockRpcInfo> convertTransactions
   return transactionHashes;
 }
 
+// Collects what a blocks reader hands over, for callers that want the whole range at once.
+template <typename RpcBlock>
+std::error_code readAllBlocks(std::function<bool(std::vector<RpcBlock>&)>& reader, std::vector<RpcBlock>& result, Logging::LoggerRef logger) {
+  try {
+    std::vector<RpcBlock> blocks;
+    while (reader(blocks)) {
+      std::move(blocks.begin(), blocks.end(), std::back_inserter(result));
+      blocks.clear();
+    }
+  } catch (std::system_error& x) {
+    logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
+    return x.code();
+  } catch (std::exception& x) {
+    logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
+    return make_error_code(cryptonote::error::INTERNAL_WALLET_ERROR);
+  }
+
+  return std::error_code();
+}
+
 void validateAddresses(const std::vector<std::string>& addresses, const cryptonote::Currency& currency, Logging::LoggerRef logger) {
   for (const auto& address: addresses) {
     if (!Account::parseAddress(address)) {
@@ -408,13 +435,18 @@ WalletService::WalletService(const cryptonote::Currency& currency, System::Dispa
     logger(logger, "WalletService"),
     dispatcher(sys),
     readyEvent(dispatcher),
-    refreshContext(dispatcher)
+    refreshContext(dispatcher),
+    saveContext(dispatcher),
+    snapshotSize(0),
+    journalSize(0)
 {
   readyEvent.set();
 }
 
 WalletService::~WalletService() {
   if (inited) {
+    saveContext.interrupt();
+    saveContext.wait();
     wallet.stop();
     refreshContext.wait();
     wallet.shutdown();
@@ -426,15 +458,65 @@ void WalletService::init() {
   loadTransactionIdIndex();
 
   refreshContext.spawn([this] { refresh(); });
+  saveContext.spawn([this] { autoSave(); });
 
   inited = true;
 }
 
 void WalletService::saveWallet() {
   PaymentService::secureSaveWallet(wallet, config.walletFile, true, true);
+  snapshotSize = boost::filesystem::file_size(config.walletFile);
+  journalSize = 0;
   logger(Logging::INFO) << "Wallet is saved";
 }
 
+void WalletService::autoSave() {
+  for (;;) {
+    try {
+      System::Timer(dispatcher).sleep(WALLET_AUTOSAVE_INTERVAL);
+
+      System::EventLock lk(readyEvent);
+      saveChanges();
+    } catch (System::InterruptedException&) {
+      logger(Logging::DEBUGGING) << "autosave is stopped";
+      return;
+    } catch (std::exception& e) {
+      logger(Logging::WARNING) << "exception thrown in autoSave(): " << e.what();
+      snapshotSize = 0;
+    }
+  }
+}
+
+//appends transactions changed since the previous save to the wallet file. The file is rewritten instead
+//on the first save after start, when the wallet can't express its changes as a record, when the file was
+//changed by someone else, or when the appended records have grown larger than the snapshot they follow
+void WalletService::saveChanges() {
+  if (snapshotSize == 0 || journalSize > snapshotSize ||
+      boost::filesystem::file_size(config.walletFile) != snapshotSize + journalSize) {
+    saveWallet();
+    return;
+  }
+
+  std::ofstream walletFile(config.walletFile, std::ofstream::binary | std::ofstream::app);
+  if (!walletFile) {
+    throw std::runtime_error("Couldn't open wallet file " + config.walletFile);
+  }
+
+  if (!wallet.saveChanges(walletFile)) {
+    walletFile.close();
+    saveWallet();
+    return;
+  }
+
+  walletFile.flush();
+  if (!walletFile) {
+    throw std::runtime_error("Couldn't append changes to wallet file " + config.walletFile);
+  }
+
+  walletFile.close();
+  journalSize = boost::filesystem::file_size(config.walletFile) - snapshotSize;
+}
+
 void WalletService::loadWallet() {
   std::ifstream inputWalletFile;
   inputWalletFile.open(config.walletFile.c_str(), std::fstream::in | std::fstream::binary);
@@ -668,6 +750,41 @@ std::error_code WalletService::getViewKey(std::string& viewSecretKey) {
 
 std::error_code WalletService::getTransactionHashes(const std::vector<std::string>& addresses, const std::string& blockHashString,
   uint32_t blockCount, const std::string& paymentId, std::vector<TransactionHashesInBlockRpcInfo>& transactionHashes) {
+  TransactionHashesReader reader;
+  std::error_code ec = getTransactionHashes(addresses, blockHashString, blockCount, paymentId, reader);
+  return ec ? ec : readAllBlocks(reader, transactionHashes, logger);
+}
+
+std::error_code WalletService::getTransactionHashes(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
+  uint32_t blockCount, const std::string& paymentId, std::vector<TransactionHashesInBlockRpcInfo>& transactionHashes) {
+  TransactionHashesReader reader;
+  std::error_code ec = getTransactionHashes(addresses, firstBlockIndex, blockCount, paymentId, reader);
+  return ec ? ec : readAllBlocks(reader, transactionHashes, logger);
+}
+
+std::error_code WalletService::getTransactions(const std::vector<std::string>& addresses, const std::string& blockHashString,
+  uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactions) {
+  TransactionsReader reader;
+  std::error_code ec = getTransactions(addresses, blockHashString, blockCount, paymentId, reader);
+  return ec ? ec : readAllBlocks(reader, transactions, logger);
+}
+
+std::error_code WalletService::getTransactions(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
+  uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactions) {
+  TransactionsReader reader;
+  std::error_code ec = getTransactions(addresses, firstBlockIndex, blockCount, paymentId, reader);
+  return ec ? ec : readAllBlocks(reader, transactions, logger);
+}
+
+std::error_code WalletService::getTransactionsByPaymentId(const std::string& paymentId, const std::vector<std::string>& addresses,
+  std::vector<TransactionsInBlockRpcInfo>& transactions) {
+  TransactionsReader reader;
+  std::error_code ec = getTransactionsByPaymentId(paymentId, addresses, reader);
+  return ec ? ec : readAllBlocks(reader, transactions, logger);
+}
+
+std::error_code WalletService::getTransactionHashes(const std::vector<std::string>& addresses, const std::string& blockHashString,
+  uint32_t blockCount, const std::string& paymentId, TransactionHashesReader& reader) {
   try {
     System::EventLock lk(readyEvent);
     validateAddresses(addresses, currency, logger);
@@ -679,7 +796,8 @@ std::error_code WalletService::getTransactionHashes(const std::vector<std::strin
     TransactionsInBlockInfoFilter transactionFilter(addresses, paymentId);
     hash_t blockHash = parseHash(blockHashString, logger);
 
-    transactionHashes = getRpcTransactionHashes(blockHash, blockCount, transactionFilter);
+    reader = makeBlocksReader(getTransactions(blockHash, std::min<size_t>(blockCount, BLOCKS_PER_READ), transactionFilter), blockCount,
+      transactionFilter, &convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo);
   } catch (std::system_error& x) {
     logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
     return x.code();
@@ -692,7 +810,7 @@ std::error_code WalletService::getTransactionHashes(const std::vector<std::strin
 }
 
 std::error_code WalletService::getTransactionHashes(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
-  uint32_t blockCount, const std::string& paymentId, std::vector<TransactionHashesInBlockRpcInfo>& transactionHashes) {
+  uint32_t blockCount, const std::string& paymentId, TransactionHashesReader& reader) {
   try {
     System::EventLock lk(readyEvent);
     validateAddresses(addresses, currency, logger);
@@ -702,8 +820,9 @@ std::error_code WalletService::getTransactionHashes(const std::vector<std::strin
     }
 
     TransactionsInBlockInfoFilter transactionFilter(addresses, paymentId);
-    transactionHashes = getRpcTransactionHashes(firstBlockIndex, blockCount, transactionFilter);
 
+    reader = makeBlocksReader(getTransactions(firstBlockIndex, std::min<size_t>(blockCount, BLOCKS_PER_READ), transactionFilter), blockCount,
+      transactionFilter, &convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo);
   } catch (std::system_error& x) {
     logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
     return x.code();
@@ -716,7 +835,7 @@ std::error_code WalletService::getTransactionHashes(const std::vector<std::strin
 }
 
 std::error_code WalletService::getTransactions(const std::vector<std::string>& addresses, const std::string& blockHashString,
-  uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactions) {
+  uint32_t blockCount, const std::string& paymentId, TransactionsReader& reader) {
   try {
     System::EventLock lk(readyEvent);
     validateAddresses(addresses, currency, logger);
@@ -729,7 +848,8 @@ std::error_code WalletService::getTransactions(const std::vector<std::string>& a
 
     hash_t blockHash = parseHash(blockHashString, logger);
 
-    transactions = getRpcTransactions(blockHash, blockCount, transactionFilter);
+    reader = makeBlocksReader(getTransactions(blockHash, std::min<size_t>(blockCount, BLOCKS_PER_READ), transactionFilter), blockCount,
+      transactionFilter, &convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo);
   } catch (std::system_error& x) {
     logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
     return x.code();
@@ -742,7 +862,7 @@ std::error_code WalletService::getTransactions(const std::vector<std::string>& a
 }
 
 std::error_code WalletService::getTransactions(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
-  uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactions) {
+  uint32_t blockCount, const std::string& paymentId, TransactionsReader& reader) {
   try {
     System::EventLock lk(readyEvent);
     validateAddresses(addresses, currency, logger);
@@ -753,7 +873,43 @@ std::error_code WalletService::getTransactions(const std::vector<std::string>& a
 
     TransactionsInBlockInfoFilter transactionFilter(addresses, paymentId);
 
-    transactions = getRpcTransactions(firstBlockIndex, blockCount, transactionFilter);
+    reader = makeBlocksReader(getTransactions(firstBlockIndex, std::min<size_t>(blockCount, BLOCKS_PER_READ), transactionFilter), blockCount,
+      transactionFilter, &convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo);
+  } catch (std::system_error& x) {
+    logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
+    return x.code();
+  } catch (std::exception& x) {
+    logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
+    return make_error_code(cryptonote::error::INTERNAL_WALLET_ERROR);
+  }
+
+  return std::error_code();
+}
+
+std::error_code WalletService::getTransactionsByPaymentId(const std::string& paymentId, const std::vector<std::string>& addresses,
+  TransactionsReader& reader) {
+  try {
+    System::EventLock lk(readyEvent);
+    validateAddresses(addresses, currency, logger);
+    validatePaymentId(paymentId, logger);
+
+    // the wallet answers from its payment id index, only the addresses are left to filter
+    TransactionsInBlockInfoFilter transactionFilter(addresses, "");
+    std::vector<cryptonote::TransactionsInBlockInfo> allTransactions = wallet.getTransactionsByPaymentId(parsePaymentId(paymentId));
+
+    // the index hands all blocks over at once, there is no range to continue
+    auto blocks = std::make_shared<std::vector<TransactionsInBlockRpcInfo>>(
+      convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filterTransactions(allTransactions, transactionFilter)));
+    auto handedOver = std::make_shared<bool>(false);
+    reader = [blocks, handedOver] (std::vector<TransactionsInBlockRpcInfo>& result) {
+      if (*handedOver) {
+        return false;
+      }
+
+      result.swap(*blocks);
+      *handedOver = true;
+      return true;
+    };
   } catch (std::system_error& x) {
     logger(Logging::WARNING) << "Error while getting transactions: " << x.what();
     return x.code();
@@ -811,27 +967,7 @@ std::error_code WalletService::sendTransaction(const SendTransaction::Request& r
   try {
     System::EventLock lk(readyEvent);
 
-    validateAddresses(request.sourceAddresses, currency, logger);
-    validateAddresses(collectDestinationAddresses(request.transfers), currency, logger);
-    if (!request.changeAddress.empty()) {
-      validateAddresses({ request.changeAddress }, currency, logger);
-    }
-
-    cryptonote::TransactionParameters sendParams;
-    if (!request.paymentId.empty()) {
-      addPaymentIdToExtra(request.paymentId, sendParams.extra);
-    } else {
-      sendParams.extra = IBinary::to(hex::from(request.extra));
-    }
-
-    sendParams.sourceAddresses = request.sourceAddresses;
-    sendParams.destinations = convertWalletRpcOrdersToWalletOrders(request.transfers);
-    sendParams.fee = request.fee;
-    sendParams.mixIn = request.anonymity;
-    sendParams.unlockTimestamp = request.unlockTime;
-    sendParams.changeDestination = request.changeAddress;
-
-    size_t transactionId = wallet.transfer(sendParams);
+    size_t transactionId = wallet.transfer(makeSendParameters(request));
     transactionHash = hex::podTo(wallet.getTransaction(transactionId).hash);
 
     logger(Logging::DEBUGGING) << "transaction_t " << transactionHash << " has been sent";
@@ -846,6 +982,68 @@ std::error_code WalletService::sendTransaction(const SendTransaction::Request& r
   return std::error_code();
 }
 
+std::error_code WalletService::sendTransactions(const SendTransactions::Request& request, std::vector<SendTransactionResult>& results) {
+  try {
+    System::EventLock lk(readyEvent);
+
+    results.assign(request.transactions.size(), SendTransactionResult());
+    auto setError = [&results] (size_t item, const std::error_code& ec) {
+      results[item].errorCode = ec.value();
+      results[item].errorMessage = ec.message();
+    };
+
+    std::vector<cryptonote::TransactionParameters> batch;
+    std::vector<size_t> batchItems;
+    for (size_t i = 0; i < request.transactions.size(); ++i) {
+      try {
+        batch.push_back(makeSendParameters(request.transactions[i]));
+        batchItems.push_back(i);
+      } catch (std::system_error& x) {
+        setError(i, x.code());
+      }
+    }
+
+    std::vector<size_t> transactionIds;
+    try {
+      transactionIds = wallet.transfer(batch);
+    } catch (std::system_error& x) {
+      //the batch is sent as a whole or not at all, find out which transactions can't be sent
+      logger(Logging::WARNING) << "Error while sending transaction batch, sending one by one: " << x.what();
+
+      transactionIds.assign(batch.size(), WALLET_INVALID_TRANSACTION_ID);
+      for (size_t i = 0; i < batch.size(); ++i) {
+        try {
+          transactionIds[i] = wallet.transfer(batch[i]);
+        } catch (std::system_error& x) {
+          setError(batchItems[i], x.code());
+        }
+      }
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (transactionIds[i] == WALLET_INVALID_TRANSACTION_ID) {
+        continue;
+      }
+
+      cryptonote::WalletTransaction transaction = wallet.getTransaction(transactionIds[i]);
+      results[batchItems[i]].transactionHash = hex::podTo(transaction.hash);
+      if (transaction.state == cryptonote::WalletTransactionState::FAILED) {
+        setError(batchItems[i], make_error_code(cryptonote::error::TX_TRANSFER_IMPOSSIBLE));
+      } else {
+        logger(Logging::DEBUGGING) << "transaction_t " << results[batchItems[i]].transactionHash << " has been sent";
+      }
+    }
+  } catch (std::system_error& x) {
+    logger(Logging::WARNING) << "Error while sending transactions: " << x.what();
+    return x.code();
+  } catch (std::exception& x) {
+    logger(Logging::WARNING) << "Error while sending transactions: " << x.what();
+    return make_error_code(cryptonote::error::INTERNAL_WALLET_ERROR);
+  }
+
+  return std::error_code();
+}
+
 std::error_code WalletService::createDelayedTransaction(const CreateDelayedTransaction::Request& request, std::string& transactionHash) {
   try {
     System::EventLock lk(readyEvent);
@@ -1024,7 +1222,11 @@ void WalletService::refresh() {
 }
 
 void WalletService::reset() {
+  saveContext.interrupt();
+  saveContext.wait();
+
   PaymentService::secureSaveWallet(wallet, config.walletFile, false, false);
+  snapshotSize = 0;
   wallet.stop();
   wallet.shutdown();
   inited = false;
@@ -1047,8 +1249,35 @@ void WalletService::replaceWithNewWallet(const secret_key_t& viewSecretKey) {
   inited = true;
 }
 
-std::vector<cryptonote::TransactionsInBlockInfo> WalletService::getTransactions(const hash_t& blockHash, size_t blockCount) const {
-  std::vector<cryptonote::TransactionsInBlockInfo> result = wallet.getTransactions(blockHash, blockCount);
+cryptonote::TransactionParameters WalletService::makeSendParameters(const SendTransaction::Request& request) const {
+  validateAddresses(request.sourceAddresses, currency, logger);
+  validateAddresses(collectDestinationAddresses(request.transfers), currency, logger);
+  if (!request.changeAddress.empty()) {
+    validateAddresses({ request.changeAddress }, currency, logger);
+  }
+
+  cryptonote::TransactionParameters sendParams;
+  if (!request.paymentId.empty()) {
+    addPaymentIdToExtra(request.paymentId, sendParams.extra);
+  } else {
+    sendParams.extra = IBinary::to(hex::from(request.extra));
+  }
+
+  sendParams.sourceAddresses = request.sourceAddresses;
+  sendParams.destinations = convertWalletRpcOrdersToWalletOrders(request.transfers);
+  sendParams.fee = request.fee;
+  sendParams.mixIn = request.anonymity;
+  sendParams.unlockTimestamp = request.unlockTime;
+  sendParams.changeDestination = request.changeAddress;
+
+  return sendParams;
+}
+
+// with an address filter the wallet looks the transactions up in its address index instead of walking every block
+std::vector<cryptonote::TransactionsInBlockInfo> WalletService::getTransactions(const hash_t& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
+  std::vector<cryptonote::TransactionsInBlockInfo> result = filter.addresses.empty() ?
+    wallet.getTransactions(blockHash, blockCount) :
+    wallet.getTransactions(std::vector<std::string>(filter.addresses.begin(), filter.addresses.end()), blockHash, blockCount);
   if (result.empty()) {
     throw std::system_error(make_error_code(cryptonote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
   }
@@ -1056,8 +1285,10 @@ std::vector<cryptonote::TransactionsInBlockInfo> WalletService::getTransactions(
   return result;
 }
 
-std::vector<cryptonote::TransactionsInBlockInfo> WalletService::getTransactions(uint32_t firstBlockIndex, size_t blockCount) const {
-  std::vector<cryptonote::TransactionsInBlockInfo> result = wallet.getTransactions(firstBlockIndex, blockCount);
+std::vector<cryptonote::TransactionsInBlockInfo> WalletService::getTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
+  std::vector<cryptonote::TransactionsInBlockInfo> result = filter.addresses.empty() ?
+    wallet.getTransactions(firstBlockIndex, blockCount) :
+    wallet.getTransactions(std::vector<std::string>(filter.addresses.begin(), filter.addresses.end()), firstBlockIndex, blockCount);
   if (result.empty()) {
     throw std::system_error(make_error_code(cryptonote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
   }
@@ -1065,28 +1296,47 @@ std::vector<cryptonote::TransactionsInBlockInfo> WalletService::getTransactions(
   return result;
 }
 
-std::vector<TransactionHashesInBlockRpcInfo> WalletService::getRpcTransactionHashes(const hash_t& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<cryptonote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
-  std::vector<cryptonote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
-  return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
-}
+template <typename RpcBlock>
+std::function<bool(std::vector<RpcBlock>& blocks)> WalletService::makeBlocksReader(std::vector<cryptonote::TransactionsInBlockInfo>&& firstSlice,
+  size_t blockCount, const TransactionsInBlockInfoFilter& filter,
+  std::vector<RpcBlock> (*convert)(const std::vector<cryptonote::TransactionsInBlockInfo>&)) {
 
-std::vector<TransactionHashesInBlockRpcInfo> WalletService::getRpcTransactionHashes(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<cryptonote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
-  std::vector<cryptonote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
-  return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
-}
+  struct State {
+    std::vector<cryptonote::TransactionsInBlockInfo> slice;
+    hash_t lastBlockHash;
+    size_t blocksLeft;
+  };
 
-std::vector<TransactionsInBlockRpcInfo> WalletService::getRpcTransactions(const hash_t& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<cryptonote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
-  std::vector<cryptonote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
-  return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions);
-}
+  auto state = std::make_shared<State>();
+  state->blocksLeft = firstSlice.size() < std::min(blockCount, BLOCKS_PER_READ) ? 0 : blockCount - firstSlice.size();
+  state->slice = std::move(firstSlice);
+
+  return [this, state, filter, convert] (std::vector<RpcBlock>& blocks) {
+    if (state->slice.empty()) {
+      if (state->blocksLeft == 0) {
+        return false;
+      }
+
+      // continued from the last block handed over, the range ends early if the wallet's chain switched away from it
+      System::EventLock lk(readyEvent);
+      size_t count = std::min(state->blocksLeft, BLOCKS_PER_READ);
+      state->slice = filter.addresses.empty() ?
+        wallet.getTransactions(state->lastBlockHash, count + 1) :
+        wallet.getTransactions(std::vector<std::string>(filter.addresses.begin(), filter.addresses.end()), state->lastBlockHash, count + 1);
+      if (state->slice.size() <= 1) {
+        state->blocksLeft = 0;
+        return false;
+      }
+
+      state->slice.erase(state->slice.begin());
+      state->blocksLeft = state->slice.size() < count ? 0 : state->blocksLeft - count;
+    }
 
-std::vector<TransactionsInBlockRpcInfo> WalletService::getRpcTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<cryptonote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
-  std::vector<cryptonote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
-  return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions);
+    blocks = convert(filterTransactions(state->slice, filter));
+    state->lastBlockHash = state->slice.back().blockHash;
+    state->slice.clear();
+    return true;
+  };
 }
 
 } //namespace PaymentService
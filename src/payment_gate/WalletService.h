@@ -15,6 +15,7 @@
 #include "logging/LoggerRef.h"
 
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
@@ -58,9 +59,30 @@ public:
     uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactionHashes);
   std::error_code getTransactions(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
     uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactionHashes);
+  std::error_code getTransactionsByPaymentId(const std::string& paymentId, const std::vector<std::string>& addresses,
+    std::vector<TransactionsInBlockRpcInfo>& transactions);
+
+  // Fills blocks with the next slice of a requested range, false once the range is done. Errors are thrown.
+  typedef std::function<bool(std::vector<TransactionHashesInBlockRpcInfo>& blocks)> TransactionHashesReader;
+  typedef std::function<bool(std::vector<TransactionsInBlockRpcInfo>& blocks)> TransactionsReader;
+
+  // Same as the overloads above, but they only check the request and read the first slice; the rest is left to reader,
+  // so that a large range is never held at once
+  std::error_code getTransactionHashes(const std::vector<std::string>& addresses, const std::string& blockHash,
+    uint32_t blockCount, const std::string& paymentId, TransactionHashesReader& reader);
+  std::error_code getTransactionHashes(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
+    uint32_t blockCount, const std::string& paymentId, TransactionHashesReader& reader);
+  std::error_code getTransactions(const std::vector<std::string>& addresses, const std::string& blockHash,
+    uint32_t blockCount, const std::string& paymentId, TransactionsReader& reader);
+  std::error_code getTransactions(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
+    uint32_t blockCount, const std::string& paymentId, TransactionsReader& reader);
+  std::error_code getTransactionsByPaymentId(const std::string& paymentId, const std::vector<std::string>& addresses,
+    TransactionsReader& reader);
   std::error_code getTransaction(const std::string& transactionHash, TransactionRpcInfo& transaction);
   std::error_code getAddresses(std::vector<std::string>& addresses);
   std::error_code sendTransaction(const SendTransaction::Request& request, std::string& transactionHash);
+  //every transaction gets its own result, an invalid one doesn't stop the others
+  std::error_code sendTransactions(const SendTransactions::Request& request, std::vector<SendTransactionResult>& results);
   std::error_code createDelayedTransaction(const CreateDelayedTransaction::Request& request, std::string& transactionHash);
   std::error_code getDelayedTransactionHashes(std::vector<std::string>& transactionHashes);
   std::error_code deleteDelayedTransaction(const std::string& transactionHash);
@@ -72,19 +94,24 @@ private:
   void refresh();
   void reset();
 
+  void autoSave();
+  void saveChanges();
+
   void loadWallet();
   void loadTransactionIdIndex();
 
   void replaceWithNewWallet(const secret_key_t& viewSecretKey);
 
-  std::vector<cryptonote::TransactionsInBlockInfo> getTransactions(const hash_t& blockHash, size_t blockCount) const;
-  std::vector<cryptonote::TransactionsInBlockInfo> getTransactions(uint32_t firstBlockIndex, size_t blockCount) const;
+  cryptonote::TransactionParameters makeSendParameters(const SendTransaction::Request& request) const;
 
-  std::vector<TransactionHashesInBlockRpcInfo> getRpcTransactionHashes(const hash_t& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
-  std::vector<TransactionHashesInBlockRpcInfo> getRpcTransactionHashes(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
+  std::vector<cryptonote::TransactionsInBlockInfo> getTransactions(const hash_t& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
+  std::vector<cryptonote::TransactionsInBlockInfo> getTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
 
-  std::vector<TransactionsInBlockRpcInfo> getRpcTransactions(const hash_t& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
-  std::vector<TransactionsInBlockRpcInfo> getRpcTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
+  // Hands firstSlice over, then reads the rest of the blockCount blocks a slice at a time, each under the lock
+  template <typename RpcBlock>
+  std::function<bool(std::vector<RpcBlock>& blocks)> makeBlocksReader(std::vector<cryptonote::TransactionsInBlockInfo>&& firstSlice,
+    size_t blockCount, const TransactionsInBlockInfoFilter& filter,
+    std::vector<RpcBlock> (*convert)(const std::vector<cryptonote::TransactionsInBlockInfo>&));
 
   const cryptonote::Currency& currency;
   cryptonote::IWallet& wallet;
@@ -95,6 +122,9 @@ private:
   System::Dispatcher& dispatcher;
   System::Event readyEvent;
   System::ContextGroup refreshContext;
+  System::ContextGroup saveContext;
+  uint64_t snapshotSize; // size of the last full save, 0 if the file on disk has to be rewritten
+  uint64_t journalSize; // size of the changes appended to it since
 
   std::map<std::string, size_t> transactionIdIndex;
 };
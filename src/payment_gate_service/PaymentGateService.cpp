@@ -185,7 +185,8 @@ void PaymentGateService::runRpcProxy(Logging::LoggerRef& log) {
   std::unique_ptr<cryptonote::INode> node(
     PaymentService::NodeFactory::createNode(
       config.remoteNodeConfig.daemonHost, 
-      config.remoteNodeConfig.daemonPort));
+      config.remoteNodeConfig.daemonPort,
+      config.remoteNodeConfig.daemonConnections));
 
   runWalletService(currency, *node);
 }
@@ -196,7 +197,10 @@ void PaymentGateService::runWalletService(const cryptonote::Currency& currency,
     config.gateConfiguration.containerPassword
   };
 
-  std::unique_ptr<cryptonote::IWallet> wallet (WalletFactory::createWallet(currency, node, *dispatcher));
+  cryptonote::DecoyCachePolicy decoyCachePolicy;
+  decoyCachePolicy.outputsPerAmount = config.gateConfiguration.decoyCacheOutputs;
+
+  std::unique_ptr<cryptonote::IWallet> wallet (WalletFactory::createWallet(currency, node, *dispatcher, decoyCachePolicy));
 
   service = new PaymentService::WalletService(currency, *dispatcher, node, *wallet, walletConfiguration, logger);
   std::unique_ptr<PaymentService::WalletService> serviceGuard(service);
@@ -0,0 +1,197 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlocksStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "cryptonote/structures/array.hpp"
+
+namespace cryptonote {
+
+namespace {
+
+void appendUint32(std::string& out, uint32_t value) {
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+bool readUint32(const std::string& in, size_t& offset, uint32_t& value) {
+  if (in.size() - offset < sizeof(value)) {
+    return false;
+  }
+
+  value = 0;
+  for (size_t i = 0; i < sizeof(value); ++i) {
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(in[offset + i])) << (8 * i);
+  }
+
+  offset += sizeof(value);
+  return true;
+}
+
+bool readHash(const std::string& in, size_t& offset, hash_t& hash) {
+  if (in.size() - offset < sizeof(hash)) {
+    return false;
+  }
+
+  memcpy(&hash, in.data() + offset, sizeof(hash));
+  offset += sizeof(hash);
+  return true;
+}
+
+bool readBlob(const std::string& in, size_t& offset, binary_array_t& blob) {
+  uint32_t size;
+  if (!readUint32(in, offset, size) || in.size() - offset < size) {
+    return false;
+  }
+
+  blob.assign(in.begin() + offset, in.begin() + offset + size);
+  offset += size;
+  return true;
+}
+
+void appendBlob(std::string& out, const void* data, size_t size) {
+  appendUint32(out, static_cast<uint32_t>(size));
+  out.append(static_cast<const char*>(data), size);
+}
+
+}
+
+void appendStreamRecord(std::string& out, const std::string& record) {
+  if (record.empty()) {
+    throw std::invalid_argument("Stream record can't be empty");
+  }
+
+  appendUint32(out, static_cast<uint32_t>(record.size()));
+  out += record;
+}
+
+void appendStreamTerminator(std::string& out) {
+  appendUint32(out, 0);
+}
+
+std::string storeBlockRecord(const block_short_info_t& item) {
+  std::string record;
+  record.append(reinterpret_cast<const char*>(&item.blockId), sizeof(item.blockId));
+  appendBlob(record, item.block.data(), item.block.size());
+  appendUint32(record, static_cast<uint32_t>(item.txPrefixes.size()));
+
+  for (const auto& txp : item.txPrefixes) {
+    binary_array_t prefix = BinaryArray::to(txp.txPrefix);
+    record.append(reinterpret_cast<const char*>(&txp.txHash), sizeof(txp.txHash));
+    appendBlob(record, prefix.data(), prefix.size());
+  }
+
+  return record;
+}
+
+std::string storeBlockRecord(const hash_t& blockId, const block_entry_t& entry, bool full) {
+  std::string record;
+  record.append(reinterpret_cast<const char*>(&blockId), sizeof(blockId));
+  if (!full) {
+    appendUint32(record, 0);
+    appendUint32(record, 0);
+    return record;
+  }
+
+  // First stored transaction is the base one, the rest follow the block's transaction ids
+  size_t txCount = entry.bl.transactionHashes.size();
+  if (entry.transactions.size() != txCount + 1) {
+    throw std::runtime_error("Stored block doesn't match its transactions");
+  }
+
+  binary_array_t blob = BinaryArray::to(entry.bl);
+  appendBlob(record, blob.data(), blob.size());
+  appendUint32(record, static_cast<uint32_t>(txCount));
+
+  for (size_t i = 0; i < txCount; ++i) {
+    blob = BinaryArray::to(static_cast<const transaction_prefix_t&>(entry.transactions[i + 1].tx));
+    record.append(reinterpret_cast<const char*>(&entry.bl.transactionHashes[i]), sizeof(hash_t));
+    appendBlob(record, blob.data(), blob.size());
+  }
+
+  return record;
+}
+
+bool loadBlockRecord(const std::string& record, BlockShortEntry& entry) {
+  size_t offset = 0;
+  binary_array_t blob;
+  uint32_t txCount;
+
+  if (!readHash(record, offset, entry.blockHash) || !readBlob(record, offset, blob) || !readUint32(record, offset, txCount)) {
+    return false;
+  }
+
+  entry.hasBlock = !blob.empty();
+  if (entry.hasBlock && !BinaryArray::from(entry.block, blob)) {
+    return false;
+  }
+
+  entry.txsShortInfo.clear();
+  entry.txsShortInfo.reserve(std::min<size_t>(txCount, record.size() / sizeof(hash_t)));
+
+  for (uint32_t i = 0; i < txCount; ++i) {
+    TransactionShortInfo tsi;
+    if (!readHash(record, offset, tsi.txId) || !readBlob(record, offset, blob) || !BinaryArray::from(tsi.txPrefix, blob)) {
+      return false;
+    }
+
+    entry.txsShortInfo.push_back(std::move(tsi));
+  }
+
+  return offset == record.size();
+}
+
+BlocksStreamReader::BlocksStreamReader(const RecordHandler& handler) : m_handler(handler), m_finished(false) {
+}
+
+void BlocksStreamReader::feed(const std::string& data) {
+  if (m_finished) {
+    if (!data.empty()) {
+      throw std::runtime_error("Unexpected data after the end of blocks stream");
+    }
+
+    return;
+  }
+
+  m_buffer += data;
+
+  size_t offset = 0;
+  for (;;) {
+    size_t recordOffset = offset;
+    uint32_t size;
+    if (!readUint32(m_buffer, recordOffset, size)) {
+      break;
+    }
+
+    if (size == 0) {
+      m_finished = true;
+      if (recordOffset != m_buffer.size()) {
+        throw std::runtime_error("Unexpected data after the end of blocks stream");
+      }
+
+      offset = recordOffset;
+      break;
+    }
+
+    if (m_buffer.size() - recordOffset < size) {
+      break;
+    }
+
+    m_handler(m_buffer.substr(recordOffset, size));
+    offset = recordOffset + size;
+  }
+
+  m_buffer.erase(0, offset);
+}
+
+bool BlocksStreamReader::isFinished() const {
+  return m_finished;
+}
+
+}
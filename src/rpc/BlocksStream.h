@@ -0,0 +1,44 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "INode.h"
+#include "cryptonote/protocol/definitions.h"
+
+namespace cryptonote {
+
+// Body of /queryblocksstream.bin is a sequence of records. Every record is a 32-bit little-endian
+// length followed by that many bytes, an empty record ends the stream.
+void appendStreamRecord(std::string& out, const std::string& record);
+void appendStreamTerminator(std::string& out);
+
+// Block record holds block id, block blob and id and prefix blob of every transaction.
+// Blocks older than requested timestamp have only the id.
+std::string storeBlockRecord(const block_short_info_t& item);
+// The same record written straight from a stored block: transaction ids are taken from the block and prefixes
+// are serialized from the stored transactions, nothing is copied or hashed again.
+std::string storeBlockRecord(const hash_t& blockId, const block_entry_t& entry, bool full);
+bool loadBlockRecord(const std::string& record, BlockShortEntry& entry);
+
+class BlocksStreamReader {
+public:
+  typedef std::function<void(const std::string& record)> RecordHandler;
+
+  explicit BlocksStreamReader(const RecordHandler& handler);
+
+  // Throws std::runtime_error if data follows the terminating record
+  void feed(const std::string& data);
+  bool isFinished() const;
+
+private:
+  RecordHandler m_handler;
+  std::string m_buffer;
+  bool m_finished;
+};
+
+}
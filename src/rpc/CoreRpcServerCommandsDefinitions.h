@@ -95,10 +95,12 @@ struct COMMAND_RPC_GET_POOL_CHANGES {
   struct request {
     hash_t tailBlockId;
     std::vector<hash_t> knownTxsIds;
+    uint64_t poolSequence; // poolSequence of the last response, 0 if none
 
     void serialize(ISerializer &s) {
       KV_MEMBER(tailBlockId)
       serializeAsBinary(knownTxsIds, "knownTxsIds", s);
+      KV_MEMBER(poolSequence)
     }
   };
 
@@ -106,12 +108,16 @@ struct COMMAND_RPC_GET_POOL_CHANGES {
     bool isTailBlockActual;
     std::vector<binary_array_t> addedTxs;          // Added transactions blobs
     std::vector<hash_t> deletedTxsIds; // IDs of not found transactions
+    uint64_t poolSequence;
+    bool isPoolDelta; // changes since the request poolSequence, not the difference with knownTxsIds
     std::string status;
 
     void serialize(ISerializer &s) {
       KV_MEMBER(isTailBlockActual)
       KV_MEMBER(addedTxs)
       serializeAsBinary(deletedTxsIds, "deletedTxsIds", s);
+      KV_MEMBER(poolSequence)
+      KV_MEMBER(isPoolDelta)
       KV_MEMBER(status)
     }
   };
@@ -121,10 +127,12 @@ struct COMMAND_RPC_GET_POOL_CHANGES_LITE {
   struct request {
     hash_t tailBlockId;
     std::vector<hash_t> knownTxsIds;
+    uint64_t poolSequence; // poolSequence of the last response, 0 if none
 
     void serialize(ISerializer &s) {
       KV_MEMBER(tailBlockId)
       serializeAsBinary(knownTxsIds, "knownTxsIds", s);
+      KV_MEMBER(poolSequence)
     }
   };
 
@@ -132,12 +140,16 @@ struct COMMAND_RPC_GET_POOL_CHANGES_LITE {
     bool isTailBlockActual;
     std::vector<transaction_prefix_info_t> addedTxs;          // Added transactions blobs
     std::vector<hash_t> deletedTxsIds; // IDs of not found transactions
+    uint64_t poolSequence;
+    bool isPoolDelta; // changes since the request poolSequence, not the difference with knownTxsIds
     std::string status;
 
     void serialize(ISerializer &s) {
       KV_MEMBER(isTailBlockActual)
       KV_MEMBER(addedTxs)
       serializeAsBinary(deletedTxsIds, "deletedTxsIds", s);
+      KV_MEMBER(poolSequence)
+      KV_MEMBER(isPoolDelta)
       KV_MEMBER(status)
     }
   };
@@ -267,6 +279,8 @@ struct COMMAND_RPC_GET_INFO {
     uint64_t difficulty;
     uint64_t tx_count;
     uint64_t tx_pool_size;
+    uint64_t tx_pool_bytes;
+    uint64_t tx_pool_evicted;
     uint64_t outgoing_connections_count;
     uint64_t incoming_connections_count;
     uint64_t white_peerlist_size;
@@ -286,6 +300,8 @@ struct COMMAND_RPC_GET_INFO {
       KV_MEMBER(difficulty)
       KV_MEMBER(tx_count)
       KV_MEMBER(tx_pool_size)
+      KV_MEMBER(tx_pool_bytes)
+      KV_MEMBER(tx_pool_evicted)
       KV_MEMBER(outgoing_connections_count)
       KV_MEMBER(incoming_connections_count)
       KV_MEMBER(white_peerlist_size)
@@ -675,6 +691,50 @@ struct COMMAND_RPC_QUERY_BLOCKS_LITE {
   };
 };
 
+// Same query as COMMAND_RPC_QUERY_BLOCKS_LITE, answered as a chunked stream of records:
+// the response below comes first, then one record per block, then an empty record.
+struct COMMAND_RPC_QUERY_BLOCKS_STREAM {
+  typedef COMMAND_RPC_QUERY_BLOCKS_LITE::request request;
+
+  struct response {
+    std::string status;
+    uint64_t startHeight;
+    uint64_t currentHeight;
+    uint64_t fullOffset;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(startHeight)
+      KV_MEMBER(currentHeight)
+      KV_MEMBER(fullOffset)
+    }
+  };
+};
+
+struct COMMAND_RPC_GET_SYNC_SUMMARIES {
+  struct request {
+    uint32_t startHeight;
+    uint32_t count;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(startHeight)
+      KV_MEMBER(count)
+    }
+  };
+
+  struct response {
+    std::string status;
+    uint32_t currentHeight;
+    std::vector<block_sync_summary_t> summaries;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(currentHeight)
+      KV_MEMBER(summaries)
+    }
+  };
+};
+
 struct COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES {
   struct request {
     std::vector<hash_t> blockHashes;
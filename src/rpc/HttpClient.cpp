@@ -4,7 +4,6 @@
 
 #include "HttpClient.h"
 
-#include <http/HttpParser.h>
 #include <system/Ipv4Resolver.h>
 #include <system/Ipv4Address.h>
 #include <system/TcpConnector.h>
@@ -22,6 +21,12 @@ HttpClient::~HttpClient() {
 }
 
 void HttpClient::request(const HttpRequest &req, HttpResponse &res) {
+  std::string body;
+  request(req, res, [&body](const std::string& data) { body += data; });
+  res.setBody(body);
+}
+
+void HttpClient::request(const HttpRequest &req, HttpResponse &res, const HttpParser::BodyHandler& bodyHandler) {
   if (!m_connected) {
     connect();
   }
@@ -31,7 +36,7 @@ void HttpClient::request(const HttpRequest &req, HttpResponse &res) {
     HttpParser parser;
     stream << req;
     stream.flush();
-    parser.receiveResponse(stream, res);
+    parser.receiveResponse(stream, res, bodyHandler);
   } catch (const std::exception &) {
     disconnect();
     throw;
@@ -6,6 +6,7 @@
 
 #include <memory>
 
+#include <http/HttpParser.h>
 #include <http/HttpRequest.h>
 #include <http/HttpResponse.h>
 #include <system/TcpConnection.h>
@@ -26,6 +27,7 @@ public:
   HttpClient(System::Dispatcher& dispatcher, const std::string& address, uint16_t port);
   ~HttpClient();
   void request(const HttpRequest& req, HttpResponse& res);
+  void request(const HttpRequest& req, HttpResponse& res, const HttpParser::BodyHandler& bodyHandler);
   
   bool isConnected() const;
 
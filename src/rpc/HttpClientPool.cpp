@@ -0,0 +1,69 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "HttpClientPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace cryptonote {
+
+HttpClientPool::Lease::Lease(HttpClientPool& pool) : m_pool(pool), m_client(pool.acquire()) {
+}
+
+HttpClientPool::Lease::~Lease() {
+  m_pool.release(m_client);
+}
+
+HttpClientPool::HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t size) :
+  m_clientReleased(dispatcher) {
+  assert(size > 0);
+
+  m_clients.reserve(size);
+  m_idleClients.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    m_clients.emplace_back(new HttpClient(dispatcher, address, port));
+    m_idleClients.push_back(m_clients.back().get());
+  }
+
+  m_clientReleased.set();
+}
+
+bool HttpClientPool::isConnected() const {
+  for (const auto& client : m_clients) {
+    if (client->isConnected()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+HttpClient& HttpClientPool::acquire() {
+  while (m_idleClients.empty()) {
+    m_clientReleased.wait();
+  }
+
+  // prefer connections that are already established
+  auto it = std::find_if(m_idleClients.rbegin(), m_idleClients.rend(), [](const HttpClient* client) { return client->isConnected(); });
+  if (it == m_idleClients.rend()) {
+    it = m_idleClients.rbegin();
+  }
+
+  HttpClient* client = *it;
+  m_idleClients.erase(std::next(it).base());
+  if (m_idleClients.empty()) {
+    m_clientReleased.clear();
+  }
+
+  return *client;
+}
+
+void HttpClientPool::release(HttpClient& client) {
+  m_idleClients.push_back(&client);
+  m_clientReleased.set();
+}
+
+}
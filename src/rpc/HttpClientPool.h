@@ -0,0 +1,53 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <system/Event.h>
+
+#include "HttpClient.h"
+
+namespace cryptonote {
+
+// Fixed set of persistent connections to one host, shared by the contexts of a single dispatcher.
+// A context that finds every connection busy waits until one is returned to the pool.
+class HttpClientPool {
+public:
+  class Lease {
+  public:
+    explicit Lease(HttpClientPool& pool);
+    ~Lease();
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    HttpClient& client() { return m_client; }
+
+  private:
+    HttpClientPool& m_pool;
+    HttpClient& m_client;
+  };
+
+  HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t size);
+  HttpClientPool(const HttpClientPool&) = delete;
+  HttpClientPool& operator=(const HttpClientPool&) = delete;
+
+  size_t size() const { return m_clients.size(); }
+  size_t idleCount() const { return m_idleClients.size(); }
+
+  // true if at least one connection is established
+  bool isConnected() const;
+
+private:
+  HttpClient& acquire();
+  void release(HttpClient& client);
+
+  std::vector<std::unique_ptr<HttpClient>> m_clients;
+  std::vector<HttpClient*> m_idleClients;
+  System::Event m_clientReleased;
+};
+
+}
@@ -23,6 +23,7 @@
 
 #include "p2p/NetNode.h"
 
+#include "BlocksStream.h"
 #include "CoreRpcServerErrorCodes.h"
 #include "JsonRpc.h"
 #include "version.h"
@@ -44,6 +45,94 @@ static inline void serialize(COMMAND_RPC_GET_BLOCKS_FAST::response& response, IS
 
 namespace {
 
+const size_t BLOCK_IDS_STREAM_BATCH_SIZE = 1000;
+const uint32_t BLOCKS_STREAM_BATCH_SIZE = 10;
+const uint32_t SYNC_SUMMARIES_MAX_COUNT = 1000;
+
+// Produces /queryblocksstream.bin body. Blocks are fetched in small batches and the blockchain lock is released
+// before a batch is written to the socket, so a slow client doesn't stall the core.
+class BlocksStreamProducer {
+public:
+  BlocksStreamProducer(core& c, const COMMAND_RPC_QUERY_BLOCKS_STREAM::response& header, std::vector<hash_t>&& blockIds,
+    uint32_t fullOffset, uint32_t fullBlocksCount, uint64_t timestamp) :
+    m_core(&c), m_header(header), m_blockIds(std::move(blockIds)), m_idIndex(0), m_height(fullOffset),
+    m_blocksLeft(fullBlocksCount), m_timestamp(timestamp), m_headerSent(false), m_finished(false) {
+    m_prevBlockId = m_blockIds.empty() ? NULL_HASH : m_blockIds.back();
+  }
+
+  bool operator()(std::string& chunk) {
+    if (m_finished) {
+      return false;
+    }
+
+    if (!m_headerSent) {
+      m_headerSent = true;
+      appendStreamRecord(chunk, storeToBinaryKeyValue(m_header));
+      if (m_header.status != CORE_RPC_STATUS_OK) {
+        finish(chunk);
+      }
+
+      return true;
+    }
+
+    if (m_idIndex < m_blockIds.size()) {
+      size_t end = std::min(m_idIndex + BLOCK_IDS_STREAM_BATCH_SIZE, m_blockIds.size());
+      for (; m_idIndex < end; ++m_idIndex) {
+        block_short_info_t item;
+        item.blockId = m_blockIds[m_idIndex];
+        appendStreamRecord(chunk, storeBlockRecord(item));
+      }
+
+      return true;
+    }
+
+    if (m_blocksLeft > 0) {
+      uint32_t count = std::min(m_blocksLeft, BLOCKS_STREAM_BATCH_SIZE);
+      uint32_t visited = 0;
+      hash_t prevBlockId = m_prevBlockId;
+
+      // Records are written from the stored blocks while the chain is locked, the socket is written after that.
+      // Stops early if the chain has been switched since previous batch or its end is reached, client asks again
+      bool result = m_core->visitBlocks(m_height, count, prevBlockId, [&](const hash_t& blockId, const block_entry_t& entry) {
+        appendStreamRecord(chunk, storeBlockRecord(blockId, entry, entry.bl.timestamp >= m_timestamp));
+        m_prevBlockId = blockId;
+        ++visited;
+      });
+
+      if (result && visited == count) {
+        m_height += count;
+        m_blocksLeft -= count;
+      } else {
+        m_blocksLeft = 0;
+      }
+
+      if (m_blocksLeft > 0) {
+        return true;
+      }
+    }
+
+    finish(chunk);
+    return true;
+  }
+
+private:
+  void finish(std::string& chunk) {
+    appendStreamTerminator(chunk);
+    m_finished = true;
+  }
+
+  core* m_core;
+  COMMAND_RPC_QUERY_BLOCKS_STREAM::response m_header;
+  std::vector<hash_t> m_blockIds;
+  size_t m_idIndex;
+  uint32_t m_height;
+  uint32_t m_blocksLeft;
+  uint64_t m_timestamp;
+  hash_t m_prevBlockId;
+  bool m_headerSent;
+  bool m_finished;
+};
+
 template <typename Command>
 RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
   return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
@@ -86,6 +175,8 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false } },
   { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false } },
   { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false } },
+  { "/queryblocksstream.bin", { std::bind(&RpcServer::on_query_blocks_stream, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), false } },
+  { "/getsyncsummaries.bin", { binMethod<COMMAND_RPC_GET_SYNC_SUMMARIES>(&RpcServer::on_get_sync_summaries), false } },
   { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false } },
   { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false } },
   { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
@@ -268,6 +359,47 @@ bool RpcServer::on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::reques
   return true;
 }
 
+bool RpcServer::on_query_blocks_stream(const HttpRequest& request, HttpResponse& response) {
+  boost::value_initialized<COMMAND_RPC_QUERY_BLOCKS_STREAM::request> req;
+  if (!loadFromBinaryKeyValue(static_cast<COMMAND_RPC_QUERY_BLOCKS_STREAM::request&>(req), request.getBody())) {
+    return false;
+  }
+
+  const COMMAND_RPC_QUERY_BLOCKS_STREAM::request& query = req;
+  std::vector<hash_t> blockIds;
+  uint32_t startHeight = 0;
+  uint32_t currentHeight = 0;
+  uint32_t fullOffset = 0;
+  uint32_t fullBlocksCount = 0;
+  bool result = m_core.queryBlocksLiteIds(query.blockIds, query.timestamp, startHeight, currentHeight, fullOffset, blockIds, fullBlocksCount);
+
+  COMMAND_RPC_QUERY_BLOCKS_STREAM::response header;
+  header.startHeight = startHeight;
+  header.currentHeight = currentHeight;
+  header.fullOffset = fullOffset;
+  if (result) {
+    header.status = CORE_RPC_STATUS_OK;
+  } else {
+    header.status = "Failed to perform query";
+    blockIds.clear();
+    fullBlocksCount = 0;
+  }
+
+  response.setChunkedBody(BlocksStreamProducer(m_core, header, std::move(blockIds), fullOffset, fullBlocksCount, query.timestamp));
+  return true;
+}
+
+bool RpcServer::on_get_sync_summaries(const COMMAND_RPC_GET_SYNC_SUMMARIES::request& req, COMMAND_RPC_GET_SYNC_SUMMARIES::response& res) {
+  res.currentHeight = m_core.get_current_blockchain_height();
+  if (!m_core.getSyncSummaries(req.startHeight, std::min(req.count, SYNC_SUMMARIES_MAX_COUNT), res.summaries)) {
+    res.status = "Failed to get sync summaries";
+    return false;
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
 bool RpcServer::on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response& res) {
   std::vector<uint32_t> outputIndexes;
   if (!m_core.get_tx_outputs_gindexs(req.txid, outputIndexes)) {
@@ -313,7 +445,7 @@ bool RpcServer::on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOU
 bool RpcServer::onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& req, COMMAND_RPC_GET_POOL_CHANGES::response& rsp) {
   rsp.status = CORE_RPC_STATUS_OK;
   std::vector<cryptonote::transaction_t> addedTransactions;
-  rsp.isTailBlockActual = m_core.getPoolChanges(req.tailBlockId, req.knownTxsIds, addedTransactions, rsp.deletedTxsIds);
+  rsp.isTailBlockActual = m_core.getPoolChangesSince(req.tailBlockId, req.poolSequence, req.knownTxsIds, addedTransactions, rsp.deletedTxsIds, rsp.poolSequence, rsp.isPoolDelta);
   for (auto& tx : addedTransactions) {
     binary_array_t txBlob;
     if (!BinaryArray::to(tx, txBlob)) {
@@ -329,7 +461,7 @@ bool RpcServer::onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& re
 
 bool RpcServer::onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::request& req, COMMAND_RPC_GET_POOL_CHANGES_LITE::response& rsp) {
   rsp.status = CORE_RPC_STATUS_OK;
-  rsp.isTailBlockActual = m_core.getPoolChangesLite(req.tailBlockId, req.knownTxsIds, rsp.addedTxs, rsp.deletedTxsIds);
+  rsp.isTailBlockActual = m_core.getPoolChangesLiteSince(req.tailBlockId, req.poolSequence, req.knownTxsIds, rsp.addedTxs, rsp.deletedTxsIds, rsp.poolSequence, rsp.isPoolDelta);
 
   return true;
 }
@@ -354,6 +486,8 @@ bool RpcServer::on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RP
   res.difficulty = m_core.getNextBlockDifficulty();
   res.tx_count = m_core.get_blockchain_total_transactions() - res.height; //without coinbase
   res.tx_pool_size = m_core.get_pool_transactions_count();
+  res.tx_pool_bytes = m_core.get_pool_transactions_size();
+  res.tx_pool_evicted = m_core.get_pool_evicted_transactions_count();
   res.alt_blocks_count = m_core.get_alternative_blocks_count();
   uint64_t total_conn = m_p2p.get_connections_count();
   res.outgoing_connections_count = m_p2p.get_outgoing_connections_count();
@@ -17,24 +17,49 @@ std::ostream& operator<<(std::ostream& out, const JsonOutputStreamSerializer& en
 }
 }
 
-namespace {
+JsonOutputStreamSerializer::JsonOutputStreamSerializer() : root(JsonValue::OBJECT), stream(nullptr) {
+  chain.push_back(&root);
+}
 
-template <typename T>
-void insertOrPush(JsonValue& js, Common::StringView name, const T& value) {
-  if (js.isArray()) {
-    js.pushBack(JsonValue(value));
-  } else {
-    js.insert(std::string(name), JsonValue(value));
-  }
+JsonOutputStreamSerializer::JsonOutputStreamSerializer(std::ostream& stream) : root(JsonValue::OBJECT), stream(&stream) {
+  scopes.push_back({ false, true });
+  stream << '{';
 }
 
+JsonOutputStreamSerializer::~JsonOutputStreamSerializer() {
+  // scopes are left open when a serialization was cut short by an exception, the output is dropped then anyway
+  if (stream != nullptr && scopes.size() == 1) {
+    *stream << '}';
+  }
 }
 
-JsonOutputStreamSerializer::JsonOutputStreamSerializer() : root(JsonValue::OBJECT) {
-  chain.push_back(&root);
+void JsonOutputStreamSerializer::writeName(Common::StringView name) {
+  assert(!scopes.empty());
+  StreamScope& scope = scopes.back();
+  if (!scope.isEmpty) {
+    *stream << ',';
+  }
+
+  scope.isEmpty = false;
+  if (!scope.isArray) {
+    *stream << '"' << std::string(name) << "\":";
+  }
 }
 
-JsonOutputStreamSerializer::~JsonOutputStreamSerializer() {
+template<typename T>
+void JsonOutputStreamSerializer::write(Common::StringView name, const T& value) {
+  if (stream != nullptr) {
+    writeName(name);
+    *stream << JsonValue(value);
+    return;
+  }
+
+  JsonValue& js = *chain.back();
+  if (js.isArray()) {
+    js.pushBack(JsonValue(value));
+  } else {
+    js.insert(std::string(name), JsonValue(value));
+  }
 }
 
 ISerializer::SerializerType JsonOutputStreamSerializer::type() const {
@@ -42,6 +67,13 @@ ISerializer::SerializerType JsonOutputStreamSerializer::type() const {
 }
 
 bool JsonOutputStreamSerializer::beginObject(Common::StringView name) {
+  if (stream != nullptr) {
+    writeName(name);
+    *stream << '{';
+    scopes.push_back({ false, true });
+    return true;
+  }
+
   JsonValue& parent = *chain.back();
   JsonValue obj(JsonValue::OBJECT);
 
@@ -55,11 +87,25 @@ bool JsonOutputStreamSerializer::beginObject(Common::StringView name) {
 }
 
 void JsonOutputStreamSerializer::endObject() {
+  if (stream != nullptr) {
+    assert(scopes.size() > 1);
+    scopes.pop_back();
+    *stream << '}';
+    return;
+  }
+
   assert(!chain.empty());
   chain.pop_back();
 }
 
 bool JsonOutputStreamSerializer::beginArray(size_t& size, Common::StringView name) {
+  if (stream != nullptr) {
+    writeName(name);
+    *stream << '[';
+    scopes.push_back({ true, true });
+    return true;
+  }
+
   JsonValue val(JsonValue::ARRAY);
   JsonValue& res = chain.back()->insert(std::string(name), val);
   chain.push_back(&res);
@@ -67,6 +113,13 @@ bool JsonOutputStreamSerializer::beginArray(size_t& size, Common::StringView nam
 }
 
 void JsonOutputStreamSerializer::endArray() {
+  if (stream != nullptr) {
+    assert(scopes.size() > 1);
+    scopes.pop_back();
+    *stream << ']';
+    return;
+  }
+
   assert(!chain.empty());
   chain.pop_back();
 }
@@ -97,27 +150,27 @@ bool JsonOutputStreamSerializer::operator()(int32_t& value, Common::StringView n
 }
 
 bool JsonOutputStreamSerializer::operator()(int64_t& value, Common::StringView name) {
-  insertOrPush(*chain.back(), name, value);
+  write(name, value);
   return true;
 }
 
 bool JsonOutputStreamSerializer::operator()(double& value, Common::StringView name) {
-  insertOrPush(*chain.back(), name, value);
+  write(name, value);
   return true;
 }
 
 bool JsonOutputStreamSerializer::operator()(std::string& value, Common::StringView name) {
-  insertOrPush(*chain.back(), name, value);
+  write(name, value);
   return true;
 }
 
 bool JsonOutputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
-  insertOrPush(*chain.back(), name, static_cast<int64_t>(value));
+  write(name, static_cast<int64_t>(value));
   return true;
 }
 
 bool JsonOutputStreamSerializer::operator()(bool& value, Common::StringView name) {
-  insertOrPush(*chain.back(), name, value);
+  write(name, value);
   return true;
 }
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <iostream>
+#include <vector>
 #include "../common/JsonValue.h"
 #include "ISerializer.h"
 
@@ -13,6 +14,9 @@ namespace cryptonote {
 class JsonOutputStreamSerializer : public ISerializer {
 public:
   JsonOutputStreamSerializer();
+  // Writes json text straight to the stream instead of building a JsonValue; the root object
+  // is opened here and closed by the destructor. getValue() stays empty in this mode.
+  explicit JsonOutputStreamSerializer(std::ostream& stream);
   virtual ~JsonOutputStreamSerializer();
 
   SerializerType type() const override;
@@ -48,8 +52,20 @@ public:
   friend std::ostream& operator<<(std::ostream& out, const JsonOutputStreamSerializer& enumerator);
 
 private:
+  struct StreamScope {
+    bool isArray;
+    bool isEmpty;
+  };
+
+  template<typename T>
+  void write(Common::StringView name, const T& value);
+  void writeName(Common::StringView name);
+
   Common::JsonValue root;
   std::vector<Common::JsonValue*> chain;
+
+  std::ostream* stream;
+  std::vector<StreamScope> scopes;
 };
 
 }
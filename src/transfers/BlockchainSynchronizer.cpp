@@ -4,11 +4,14 @@
 
 #include "BlockchainSynchronizer.h"
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <sstream>
 #include <unordered_set>
 
+#include "common/BlockingQueue.h"
+#include "common/ScopeExit.h"
 #include "cryptonote/core/transaction/TransactionApi.h"
 #include "cryptonote/core/CryptoNoteFormatUtils.h"
 
@@ -16,6 +19,11 @@ using namespace crypto;
 
 namespace {
 
+// Downloaded blocks are handed to consumers in slices, so transactions of only one slice are parsed at a time
+const size_t BLOCKS_PROCESSING_BATCH_SIZE = 100;
+// Received batches waiting for the consumers; the node stops reading while the queue is full
+const size_t BLOCKS_STREAM_QUEUE_SIZE = 3;
+
 inline std::vector<uint8_t> stringToVector(const std::string& s) {
   std::vector<uint8_t> vec(
     reinterpret_cast<const uint8_t*>(s.data()),
@@ -332,31 +340,63 @@ BlockchainSynchronizer::GetBlocksRequest BlockchainSynchronizer::getCommonHistor
 }
 
 void BlockchainSynchronizer::startBlockchainSync() {
-  GetBlocksResponse response;
   GetBlocksRequest req = getCommonHistory();
 
   try {
     if (!req.knownBlocks.empty()) {
+      // Consumers may query the node themselves, so batches are processed here rather than on the node's thread,
+      // while the node keeps receiving the next ones. A full queue holds the download back.
+      BlockingQueue<GetBlocksResponse> batches(BLOCKS_STREAM_QUEUE_SIZE);
       auto queryBlocksCompleted = std::promise<std::error_code>();
       auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
 
-      m_node.queryBlocks(
+      // The node writes to both until its callback, which has to be waited for even if processing throws
+      Tools::ScopeExit waitForQueryBlocks([&batches, &queryBlocksWaitFuture] {
+        batches.close();
+        if (queryBlocksWaitFuture.valid()) {
+          queryBlocksWaitFuture.wait();
+        }
+      });
+
+      m_node.streamBlocks(
         std::move(req.knownBlocks),
         req.syncStart.timestamp,
-        response.newBlocks,
-        response.startHeight,
-        [&queryBlocksCompleted](std::error_code ec) {
+        [&batches](uint32_t startHeight, std::vector<BlockShortEntry>&& blocks) {
+          GetBlocksResponse batch;
+          batch.startHeight = startHeight;
+          batch.newBlocks = std::move(blocks);
+          batches.push(std::move(batch));
+        },
+        [&queryBlocksCompleted, &batches](std::error_code ec) {
+          batches.close();
           auto detachedPromise = std::move(queryBlocksCompleted);
           detachedPromise.set_value(ec);
         });
 
+      UpdateConsumersResult result = UpdateConsumersResult::nothingChanged;
+      uint32_t processedBlockCount = 0;
+      bool received = false;
+      GetBlocksResponse batch;
+      while (batches.pop(batch)) {
+        if (!received) {
+          processedBlockCount = batch.startHeight;
+          received = true;
+        }
+
+        if (result != UpdateConsumersResult::errorOccurred && !checkIfShouldStop()) {
+          processBlocks(batch, result, processedBlockCount);
+        }
+
+        batch.newBlocks.clear();
+      }
+
       std::error_code ec = queryBlocksWaitFuture.get();
 
-      if (ec) {
+      if (ec && result != UpdateConsumersResult::errorOccurred) {
         setFutureStateIf(State::idle, [this] { return m_futureState != State::stopped; });
         m_observerManager.notify(&IBlockchainSynchronizerObserver::synchronizationCompleted, ec);
       } else {
-        processBlocks(response);
+        completeBlocksProcessing(result, processedBlockCount);
       }
     }
   } catch (std::exception&) {
@@ -365,44 +405,63 @@ void BlockchainSynchronizer::startBlockchainSync() {
   }
 }
 
-void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
-  BlockchainInterval interval;
-  interval.startHeight = response.startHeight;
-  std::vector<CompleteBlock> blocks;
+void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response, UpdateConsumersResult& result, uint32_t& processedBlockCount) {
+  for (size_t offset = 0; offset < response.newBlocks.size() && result != UpdateConsumersResult::errorOccurred; offset += BLOCKS_PROCESSING_BATCH_SIZE) {
+    BlockchainInterval interval;
+    interval.startHeight = response.startHeight + static_cast<uint32_t>(offset);
+    std::vector<CompleteBlock> blocks;
+
+    size_t end = std::min(offset + BLOCKS_PROCESSING_BATCH_SIZE, response.newBlocks.size());
+    for (size_t i = offset; i < end; ++i) {
+      if (checkIfShouldStop()) {
+        break;
+      }
+
+      auto& block = response.newBlocks[i];
+      CompleteBlock completeBlock;
+      completeBlock.blockHash = block.blockHash;
+      interval.blocks.push_back(completeBlock.blockHash);
+      if (block.hasBlock) {
+        completeBlock.block = std::move(block.block);
+        completeBlock.transactions.push_back(createTransactionPrefix(completeBlock.block->baseTransaction));
+
+        try {
+          for (const auto& txShortInfo : block.txsShortInfo) {
+            completeBlock.transactions.push_back(createTransactionPrefix(txShortInfo.txPrefix, reinterpret_cast<const hash_t&>(txShortInfo.txId)));
+          }
+        } catch (std::exception&) {
+          result = UpdateConsumersResult::errorOccurred;
+          return;
+        }
+
+        block.txsShortInfo.clear();
+        block.txsShortInfo.shrink_to_fit();
+      }
+
+      blocks.push_back(std::move(completeBlock));
+    }
 
-  for (auto& block : response.newBlocks) {
     if (checkIfShouldStop()) {
       break;
     }
 
-    CompleteBlock completeBlock;
-    completeBlock.blockHash = block.blockHash;
-    interval.blocks.push_back(completeBlock.blockHash);
-    if (block.hasBlock) {
-      completeBlock.block = std::move(block.block);
-      completeBlock.transactions.push_back(createTransactionPrefix(completeBlock.block->baseTransaction));
+    std::unique_lock<std::mutex> lk(m_consumersMutex);
+    auto sliceResult = updateConsumers(interval, blocks);
+    lk.unlock();
 
-      try {
-        for (const auto& txShortInfo : block.txsShortInfo) {
-          completeBlock.transactions.push_back(createTransactionPrefix(txShortInfo.txPrefix, reinterpret_cast<const hash_t&>(txShortInfo.txId)));
-        }
-      } catch (std::exception&) {
-        setFutureStateIf(State::idle, [this] { return m_futureState != State::stopped; });
-        m_observerManager.notify(&IBlockchainSynchronizerObserver::synchronizationCompleted, std::make_error_code(std::errc::invalid_argument));
-        return;
-      }
+    if (sliceResult != UpdateConsumersResult::nothingChanged) {
+      result = sliceResult;
     }
 
-    blocks.push_back(std::move(completeBlock));
+    processedBlockCount = interval.startHeight + static_cast<uint32_t>(blocks.size());
+    if (!blocks.empty()) {
+      lastBlockId = blocks.back().blockHash;
+    }
   }
+}
 
-  uint32_t processedBlockCount = response.startHeight + static_cast<uint32_t>(response.newBlocks.size());
+void BlockchainSynchronizer::completeBlocksProcessing(UpdateConsumersResult result, uint32_t processedBlockCount) {
   if (!checkIfShouldStop()) {
-    response.newBlocks.clear();
-    std::unique_lock<std::mutex> lk(m_consumersMutex);
-    auto result = updateConsumers(interval, blocks);
-    lk.unlock();
-
     switch (result) {
     case UpdateConsumersResult::errorOccurred:
       if (setFutureStateIf(State::idle, [this] { return m_futureState != State::stopped; })) {
@@ -425,10 +484,6 @@ void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
         std::max(m_node.getKnownBlockCount(), m_node.getLocalBlockCount()));
       break;
     }
-
-    if (!blocks.empty()) {
-      lastBlockId = blocks.back().blockHash;
-    }
   }
 
   if (checkIfShouldStop()) { //Sic!
@@ -90,7 +90,8 @@ private:
   void startPoolSync();
   void startBlockchainSync();
 
-  void processBlocks(GetBlocksResponse& response);
+  void processBlocks(GetBlocksResponse& response, UpdateConsumersResult& result, uint32_t& processedBlockCount);
+  void completeBlocksProcessing(UpdateConsumersResult result, uint32_t processedBlockCount);
   UpdateConsumersResult updateConsumers(const BlockchainInterval& interval, const std::vector<CompleteBlock>& blocks);
   std::error_code processPoolTxs(GetPoolResponse& response);
   std::error_code getPoolSymmetricDifferenceSync(GetPoolRequest&& request, GetPoolResponse& response);
@@ -40,17 +40,10 @@ void checkOutputKey(
 
 void findMyOutputs(
   const ITransactionReader& tx,
-  const secret_key_t& viewSecretKey,
+  const key_derivation_t& derivation,
   const std::unordered_set<public_key_t>& spendKeys,
   std::unordered_map<public_key_t, std::vector<uint32_t>>& outputs) {
 
-  auto txPublicKey = tx.getTransactionPublicKey();
-  key_derivation_t derivation;
-
-  if (!generate_key_derivation((const uint8_t*)&txPublicKey, (const uint8_t*)&viewSecretKey, (uint8_t*)&derivation)) {
-    return;
-  }
-
   size_t keyIndex = 0;
   size_t outputCount = tx.getOutputCount();
 
@@ -79,6 +72,22 @@ void findMyOutputs(
   }
 }
 
+void findMyOutputs(
+  const ITransactionReader& tx,
+  const secret_key_t& viewSecretKey,
+  const std::unordered_set<public_key_t>& spendKeys,
+  std::unordered_map<public_key_t, std::vector<uint32_t>>& outputs) {
+
+  auto txPublicKey = tx.getTransactionPublicKey();
+  key_derivation_t derivation;
+
+  if (!generate_key_derivation((const uint8_t*)&txPublicKey, (const uint8_t*)&viewSecretKey, (uint8_t*)&derivation)) {
+    return;
+  }
+
+  findMyOutputs(tx, derivation, spendKeys, outputs);
+}
+
 std::vector<hash_t> getBlockHashes(const cryptonote::CompleteBlock* blocks, size_t count) {
   std::vector<hash_t> result;
   result.reserve(count);
@@ -192,11 +201,15 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
     workers = 2;
   }
 
-  BlockingQueue<Tx> inputQueue(workers * 2);
+  // transactions are handed to workers in batches so key derivations can be computed together
+  BlockingQueue<std::vector<Tx>> inputQueue(workers * 2);
 
   std::atomic<bool> stopProcessing(false);
 
   auto pushingThread = std::async(std::launch::async, [&] {
+    std::vector<Tx> batch;
+    batch.reserve(DERIVATION_BATCH_SIZE);
+
     for( uint32_t i = 0; i < count && !stopProcessing; ++i) {
       const auto& block = blocks[i].block;
 
@@ -222,29 +235,60 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t startH
         }
 
         Tx item = { blockInfo, tx.get() };
-        inputQueue.push(item);
+        batch.push_back(item);
+        if (batch.size() == DERIVATION_BATCH_SIZE) {
+          inputQueue.push(std::move(batch));
+          batch.clear();
+          batch.reserve(DERIVATION_BATCH_SIZE);
+        }
+
         ++blockInfo.transactionIndex;
       }
     }
 
+    if (!batch.empty()) {
+      inputQueue.push(std::move(batch));
+    }
+
     inputQueue.close();
   });
 
   auto processingFunction = [&] {
-    Tx item;
+    std::vector<Tx> batch;
+    std::vector<public_key_t> txPublicKeys;
+    std::vector<key_derivation_t> derivations;
+    std::vector<int> derived;
     std::error_code ec;
-    while (!stopProcessing && inputQueue.pop(item)) {
-      PreprocessedTx output;
-      static_cast<Tx&>(output) = item;
+    while (!stopProcessing && inputQueue.pop(batch)) {
+      txPublicKeys.clear();
+      for (const auto& item : batch) {
+        txPublicKeys.push_back(item.tx->getTransactionPublicKey());
+      }
+
+      derivations.resize(batch.size());
+      derived.resize(batch.size());
+      generate_key_derivations((const uint8_t*)txPublicKeys.data(), txPublicKeys.size(), (const uint8_t*)&m_viewSecret,
+        (uint8_t*)derivations.data(), derived.data());
+
+      for (size_t i = 0; i < batch.size(); ++i) {
+        PreprocessedTx output;
+        static_cast<Tx&>(output) = batch[i];
+
+        if (derived[i]) {
+          ec = preprocessOutputs(batch[i].blockInfo, *batch[i].tx, derivations[i], output);
+          if (ec) {
+            stopProcessing = true;
+            break;
+          }
+        }
+
+        std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
+        preprocessedTransactions.push_back(std::move(output));
+      }
 
-      ec = preprocessOutputs(item.blockInfo, *item.tx, output);
       if (ec) {
-        stopProcessing = true;
         break;
       }
-
-      std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-      preprocessedTransactions.push_back(std::move(output));
     }
     return ec;
   };
@@ -417,7 +461,18 @@ std::error_code createTransfers(
 std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info) {
   std::unordered_map<public_key_t, std::vector<uint32_t>> outputs;
   findMyOutputs(tx, m_viewSecret, m_spendKeys, outputs);
+  return preprocessOutputs(blockInfo, tx, outputs, info);
+}
+
+std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
+  const key_derivation_t& derivation, PreprocessInfo& info) {
+  std::unordered_map<public_key_t, std::vector<uint32_t>> outputs;
+  findMyOutputs(tx, derivation, m_spendKeys, outputs);
+  return preprocessOutputs(blockInfo, tx, outputs, info);
+}
 
+std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
+  const std::unordered_map<public_key_t, std::vector<uint32_t>>& outputs, PreprocessInfo& info) {
   if (outputs.empty()) {
     return std::error_code();
   }
@@ -56,7 +56,14 @@ private:
     std::vector<uint32_t> globalIdxs;
   };
 
+  // number of transactions whose key derivations are computed in one generate_key_derivations call
+  static const size_t DERIVATION_BATCH_SIZE = 64;
+
   std::error_code preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info);
+  std::error_code preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
+    const key_derivation_t& derivation, PreprocessInfo& info);
+  std::error_code preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
+    const std::unordered_map<public_key_t, std::vector<uint32_t>>& outputs, PreprocessInfo& info);
   std::error_code processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx);
   void processTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, const PreprocessInfo& info);
   void processOutputs(const TransactionBlockInfo& blockInfo, TransfersSubscription& sub, const ITransactionReader& tx,
@@ -191,6 +191,10 @@ namespace {
   TransferIteratorList<TIterator> createTransferIteratorList(const std::pair<TIterator, TIterator>& itPair) {
     return TransferIteratorList<TIterator>(itPair.first, itPair.second);
   }
+
+  size_t balanceIndex(output_type_t type) {
+    return static_cast<size_t>(type);
+  }
 }
 
 
@@ -265,6 +269,8 @@ TransfersContainer::TransfersContainer(const Currency& currency, size_t transact
   m_currentHeight(0),
   m_currency(currency),
   m_transactionSpendableAge(transactionSpendableAge) {
+  std::fill(std::begin(m_unconfirmedBalance), std::end(m_unconfirmedBalance), 0);
+  std::fill(std::begin(m_unlockedBalance), std::end(m_unlockedBalance), 0);
 }
 
 bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const ITransactionReader& tx,
@@ -347,8 +353,8 @@ bool TransfersContainer::addTransactionOutputs(const TransactionBlockInfo& block
 
     if (transferIsUnconfirmed) {
       auto result = m_unconfirmedTransfers.emplace(std::move(info));
-      (void)result; // Disable unused warning
       assert(result.second);
+      addToBalance(*result.first);
     } else {
       if (info.type == output_type_t::Multisignature) {
         SpentOutputDescriptor descriptor(transfer);
@@ -359,8 +365,8 @@ bool TransfersContainer::addTransactionOutputs(const TransactionBlockInfo& block
       }
 
       auto result = m_availableTransfers.emplace(std::move(info));
-      (void)result; // Disable unused warning
       assert(result.second);
+      addToBalance(*result.first);
     }
 
     if (info.type == output_type_t::Key) {
@@ -420,6 +426,7 @@ bool TransfersContainer::addTransactionInputs(const TransactionBlockInfo& block,
       assert(spendingTransferIt->keyImage == input.keyImage);
       copyToSpent(block, tx, i, *spendingTransferIt);
       // erase from available outputs
+      removeFromBalance(*spendingTransferIt);
       outputDescriptorIndex.erase(spendingTransferIt);
       updateTransfersVisibility(input.keyImage);
 
@@ -433,6 +440,7 @@ bool TransfersContainer::addTransactionInputs(const TransactionBlockInfo& block,
       if (availableOutputIt != outputDescriptorIndex.end()) {
         copyToSpent(block, tx, i, *availableOutputIt);
         // erase from available outputs
+        removeFromBalance(*availableOutputIt);
         outputDescriptorIndex.erase(availableOutputIt);
 
         inputsAdded = true;
@@ -505,9 +513,10 @@ bool TransfersContainer::markTransactionConfirmed(const TransactionBlockInfo& bl
     }
 
     auto result = m_availableTransfers.emplace(std::move(transfer));
-    (void)result; // Disable unused warning
     assert(result.second);
+    addToBalance(*result.first);
 
+    removeFromBalance(*transferIt);
     transferIt = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(transferIt);
 
     if (transfer.type == output_type_t::Key) {
@@ -540,6 +549,7 @@ void TransfersContainer::deleteTransactionTransfers(const hash_t& transactionHas
 
     auto result = m_availableTransfers.emplace(static_cast<const TransactionOutputInformationEx&>(*it));
     assert(result.second);
+    addToBalance(*result.first);
     it = spendingTransactionIndex.erase(it);
 
     if (result.first->type == output_type_t::Key) {
@@ -549,6 +559,7 @@ void TransfersContainer::deleteTransactionTransfers(const hash_t& transactionHas
 
   auto unconfirmedTransfersRange = m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
   for (auto it = unconfirmedTransfersRange.first; it != unconfirmedTransfersRange.second;) {
+    removeFromBalance(*it);
     if (it->type == output_type_t::Key) {
       key_image_t keyImage = it->keyImage;
       it = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(it);
@@ -561,6 +572,7 @@ void TransfersContainer::deleteTransactionTransfers(const hash_t& transactionHas
   auto& transactionTransfersIndex = m_availableTransfers.get<ContainingTransactionIndex>();
   auto transactionTransfersRange = transactionTransfersIndex.equal_range(transactionHash);
   for (auto it = transactionTransfersRange.first; it != transactionTransfersRange.second;) {
+    removeFromBalance(*it);
     if (it->type == output_type_t::Key) {
       key_image_t keyImage = it->keyImage;
     it = transactionTransfersIndex.erase(it);
@@ -626,6 +638,8 @@ std::vector<hash_t> TransfersContainer::detach(uint32_t height) {
 
   // TODO: notification on detach
   m_currentHeight = height == 0 ? 0 : height - 1;
+  // Going back in height can lock transfers again
+  rebuildBalance();
 
   return deletedTransactions;
 }
@@ -659,6 +673,15 @@ void TransfersContainer::updateTransfersVisibility(const key_image_t& keyImage)
   size_t spentCount = std::distance(spentRange.first, spentRange.second);
   assert(spentCount == 0 || spentCount == 1);
 
+  // replace() keeps elements in place, so both ranges stay valid while visibility changes
+  for (auto it = unconfirmedRange.first; it != unconfirmedRange.second; ++it) {
+    removeFromBalance(*it);
+  }
+
+  for (auto it = availableRange.first; it != availableRange.second; ++it) {
+    removeFromBalance(*it);
+  }
+
   if (spentCount > 0) {
     updateVisibility(unconfirmedIndex, unconfirmedRange, false);
     updateVisibility(availableIndex, availableRange, false);
@@ -677,6 +700,106 @@ void TransfersContainer::updateTransfersVisibility(const key_image_t& keyImage)
   } else {
     updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
   }
+
+  for (auto it = unconfirmedRange.first; it != unconfirmedRange.second; ++it) {
+    addToBalance(*it);
+  }
+
+  for (auto it = availableRange.first; it != availableRange.second; ++it) {
+    addToBalance(*it);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ * \pre transfer is stored in m_unconfirmedTransfers or m_availableTransfers.
+ */
+void TransfersContainer::addToBalance(const TransactionOutputInformationEx& transfer) {
+  if (!transfer.visible) {
+    return;
+  }
+
+  if (transfer.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+    m_unconfirmedBalance[balanceIndex(transfer.type)] += transfer.amount;
+  } else if (getTransferState(transfer) == IncludeStateUnlocked) {
+    m_unlockedBalance[balanceIndex(transfer.type)] += transfer.amount;
+  } else {
+    m_maturingTransfers.insert(&transfer);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ * \pre transfer is stored in m_unconfirmedTransfers or m_availableTransfers.
+ */
+void TransfersContainer::removeFromBalance(const TransactionOutputInformationEx& transfer) {
+  if (!transfer.visible) {
+    return;
+  }
+
+  if (transfer.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+    assert(m_unconfirmedBalance[balanceIndex(transfer.type)] >= transfer.amount);
+    m_unconfirmedBalance[balanceIndex(transfer.type)] -= transfer.amount;
+  } else if (m_maturingTransfers.erase(&transfer) == 0) {
+    assert(m_unlockedBalance[balanceIndex(transfer.type)] >= transfer.amount);
+    m_unlockedBalance[balanceIndex(transfer.type)] -= transfer.amount;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::rebuildBalance() {
+  std::fill(std::begin(m_unconfirmedBalance), std::end(m_unconfirmedBalance), 0);
+  std::fill(std::begin(m_unlockedBalance), std::end(m_unlockedBalance), 0);
+  m_maturingTransfers.clear();
+
+  for (const auto& t : m_unconfirmedTransfers) {
+    addToBalance(t);
+  }
+
+  for (const auto& t : m_availableTransfers) {
+    addToBalance(t);
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::unlockMaturedTransfers() const {
+  for (auto it = m_maturingTransfers.begin(); it != m_maturingTransfers.end();) {
+    const TransactionOutputInformationEx& transfer = **it;
+    if (getTransferState(transfer) == IncludeStateUnlocked) {
+      m_unlockedBalance[balanceIndex(transfer.type)] += transfer.amount;
+      it = m_maturingTransfers.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * Walks all transfers, used to cross-check the running balance in debug builds.
+ * \pre m_mutex is locked.
+ */
+uint64_t TransfersContainer::scanBalance(uint32_t flags) const {
+  uint64_t amount = 0;
+
+  for (const auto& t : m_availableTransfers) {
+    if (t.visible && isIncluded(t, flags)) {
+      amount += t.amount;
+    }
+  }
+
+  if ((flags & IncludeStateLocked) != 0) {
+    for (const auto& t : m_unconfirmedTransfers) {
+      if (t.visible && isIncluded(t.type, IncludeStateLocked, flags)) {
+        amount += t.amount;
+      }
+    }
+  }
+
+  return amount;
 }
 
 bool TransfersContainer::advanceHeight(uint32_t height) {
@@ -702,22 +825,26 @@ size_t TransfersContainer::transactionsCount() const {
 
 uint64_t TransfersContainer::balance(uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
+  unlockMaturedTransfers();
+
   uint64_t amount = 0;
+  for (auto type : { output_type_t::Key, output_type_t::Multisignature }) {
+    if (isIncluded(type, IncludeStateUnlocked, flags)) {
+      amount += m_unlockedBalance[balanceIndex(type)];
+    }
 
-  for (const auto& t : m_availableTransfers) {
-    if (t.visible && isIncluded(t, flags)) {
-      amount += t.amount;
+    if (isIncluded(type, IncludeStateLocked, flags)) {
+      amount += m_unconfirmedBalance[balanceIndex(type)];
     }
   }
 
-  if ((flags & IncludeStateLocked) != 0) {
-    for (const auto& t : m_unconfirmedTransfers) {
-      if (t.visible && isIncluded(t.type, IncludeStateLocked, flags)) {
-        amount += t.amount;
-      }
+  for (const auto* t : m_maturingTransfers) {
+    if (isIncluded(*t, flags)) {
+      amount += t->amount;
     }
   }
 
+  assert(amount == scanBalance(flags));
   return amount;
 }
 
@@ -905,6 +1032,7 @@ void TransfersContainer::load(std::istream& in) {
   m_unconfirmedTransfers = std::move(unconfirmedTransfers);
   m_availableTransfers = std::move(availableTransfers);
   m_spentTransfers = std::move(spentTransfers);
+  rebuildBalance();
 }
 
 bool TransfersContainer::isSpendTimeUnlocked(uint64_t unlockTime) const {
@@ -920,17 +1048,18 @@ bool TransfersContainer::isSpendTimeUnlocked(uint64_t unlockTime) const {
   return false;
 }
 
-bool TransfersContainer::isIncluded(const TransactionOutputInformationEx& info, uint32_t flags) const {
-  uint32_t state;
+uint32_t TransfersContainer::getTransferState(const TransactionOutputInformationEx& info) const {
   if (info.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT || !isSpendTimeUnlocked(info.unlockTime)) {
-    state = IncludeStateLocked;
+    return IncludeStateLocked;
   } else if (m_currentHeight < info.blockHeight + m_transactionSpendableAge) {
-    state = IncludeStateSoftLocked;
+    return IncludeStateSoftLocked;
   } else {
-    state = IncludeStateUnlocked;
+    return IncludeStateUnlocked;
   }
+}
 
-  return isIncluded(info.type, state, flags);
+bool TransfersContainer::isIncluded(const TransactionOutputInformationEx& info, uint32_t flags) const {
+  return isIncluded(info.type, getTransferState(info), flags);
 }
 
 bool TransfersContainer::isIncluded(output_type_t type, uint32_t state, uint32_t flags) {
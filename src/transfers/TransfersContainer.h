@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 
 #include <boost/multi_index_container.hpp>
@@ -254,10 +255,17 @@ private:
   bool addTransactionInputs(const TransactionBlockInfo& block, const ITransactionReader& tx);
   void deleteTransactionTransfers(const hash_t& transactionHash);
   bool isSpendTimeUnlocked(uint64_t unlockTime) const;
+  uint32_t getTransferState(const TransactionOutputInformationEx& info) const;
   bool isIncluded(const TransactionOutputInformationEx& info, uint32_t flags) const;
   static bool isIncluded(output_type_t type, uint32_t state, uint32_t flags);
   void updateTransfersVisibility(const key_image_t& keyImage);
 
+  void addToBalance(const TransactionOutputInformationEx& transfer);
+  void removeFromBalance(const TransactionOutputInformationEx& transfer);
+  void rebuildBalance();
+  void unlockMaturedTransfers() const;
+  uint64_t scanBalance(uint32_t flags) const;
+
   void copyToSpent(const TransactionBlockInfo& block, const ITransactionReader& tx, size_t inputIndex, const TransactionOutputInformationEx& output);
 
 private:
@@ -267,6 +275,12 @@ private:
   SpentTransfersMultiIndex m_spentTransfers;
   //std::unordered_map<key_image_t, KeyOutputInfo, boost::hash<key_image_t>> m_keyImages;
 
+  // Balance of visible transfers, indexed by output type. Confirmed transfers that aren't unlocked yet are
+  // kept aside in m_maturingTransfers and move to m_unlockedBalance once they unlock.
+  uint64_t m_unconfirmedBalance[3];
+  mutable uint64_t m_unlockedBalance[3];
+  mutable std::unordered_set<const TransactionOutputInformationEx*> m_maturingTransfers;
+
   uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
   size_t m_transactionSpendableAge;
   const cryptonote::Currency& m_currency;
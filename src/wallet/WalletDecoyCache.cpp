@@ -0,0 +1,105 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "WalletDecoyCache.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+
+#include "common/ShuffleGenerator.h"
+#include "cryptonote/crypto/crypto.h"
+
+namespace cryptonote {
+
+WalletDecoyCache::WalletDecoyCache(const DecoyCachePolicy& policy) : m_policy(policy) {
+}
+
+const DecoyCachePolicy& WalletDecoyCache::getPolicy() const {
+  return m_policy;
+}
+
+void WalletDecoyCache::setPolicy(const DecoyCachePolicy& policy) {
+  m_policy = policy;
+  clear();
+}
+
+bool WalletDecoyCache::canServe(uint64_t outsCount) const {
+  return m_policy.outputsPerAmount != 0 && m_policy.maxAmounts != 0 && outsCount <= m_policy.outputsPerAmount;
+}
+
+std::vector<uint64_t> WalletDecoyCache::getStaleAmounts(const std::vector<uint64_t>& amounts, std::time_t now) const {
+  std::vector<uint64_t> staleAmounts;
+  std::unordered_set<uint64_t> seen;
+
+  for (auto amount: amounts) {
+    if (!seen.insert(amount).second) {
+      continue;
+    }
+
+    auto it = m_pools.find(amount);
+    if (it == m_pools.end() || !isFresh(it->second, now)) {
+      staleAmounts.push_back(amount);
+    }
+  }
+
+  return staleAmounts;
+}
+
+void WalletDecoyCache::update(const std::vector<outs_for_amount>& fetched, std::time_t now) {
+  for (const auto& outs: fetched) {
+    Pool& pool = m_pools[outs.amount];
+    pool.outs = outs.outs;
+    pool.updated = now;
+  }
+}
+
+std::vector<WalletDecoyCache::outs_for_amount> WalletDecoyCache::draw(const std::vector<uint64_t>& amounts, uint64_t outsCount) const {
+  std::vector<outs_for_amount> result;
+  result.reserve(amounts.size());
+
+  std::default_random_engine randomGenerator(crypto::rand<std::default_random_engine::result_type>());
+
+  for (auto amount: amounts) {
+    outs_for_amount outs;
+    outs.amount = amount;
+
+    auto it = m_pools.find(amount);
+    if (it != m_pools.end()) {
+      const auto& candidates = it->second.outs;
+      ShuffleGenerator<size_t, std::default_random_engine> generator(candidates.size(), std::default_random_engine(randomGenerator()));
+
+      size_t count = static_cast<size_t>(std::min<uint64_t>(outsCount, candidates.size()));
+      outs.outs.reserve(count);
+      for (size_t i = 0; i < count; ++i) {
+        outs.outs.push_back(candidates[generator()]);
+      }
+    }
+
+    result.push_back(std::move(outs));
+  }
+
+  return result;
+}
+
+void WalletDecoyCache::trim() {
+  while (m_pools.size() > m_policy.maxAmounts) {
+    auto oldest = std::min_element(m_pools.begin(), m_pools.end(), [] (const std::pair<const uint64_t, Pool>& a, const std::pair<const uint64_t, Pool>& b) {
+      return a.second.updated < b.second.updated;
+    });
+
+    m_pools.erase(oldest);
+  }
+}
+
+void WalletDecoyCache::clear() {
+  m_pools.clear();
+}
+
+bool WalletDecoyCache::isFresh(const Pool& pool, std::time_t now) const {
+  return now >= pool.updated && static_cast<uint64_t>(now - pool.updated) < m_policy.maxAgeSeconds;
+}
+
+
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <unordered_map>
+#include <vector>
+
+#include "rpc/CoreRpcServerCommandsDefinitions.h"
+
+namespace cryptonote {
+
+struct DecoyCachePolicy {
+  //candidate outputs fetched and kept per amount, 0 disables the cache. Off unless the caller opts in
+  uint64_t outputsPerAmount = 0;
+  //pools older than this are fetched again before use
+  uint64_t maxAgeSeconds = 10 * 60;
+  //amounts kept at once, the oldest pool is dropped first
+  size_t maxAmounts = 256;
+};
+
+//Candidate decoy outputs per amount. Spends draw their decoys from these pools
+//instead of asking the daemon for fresh random outputs every time.
+class WalletDecoyCache {
+public:
+  typedef COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs_for_amount;
+
+  explicit WalletDecoyCache(const DecoyCachePolicy& policy = DecoyCachePolicy());
+
+  const DecoyCachePolicy& getPolicy() const;
+  void setPolicy(const DecoyCachePolicy& policy);
+  //true if pools can serve outsCount decoys per amount under the current policy
+  bool canServe(uint64_t outsCount) const;
+
+  //distinct amounts without a fresh pool
+  std::vector<uint64_t> getStaleAmounts(const std::vector<uint64_t>& amounts, std::time_t now) const;
+  void update(const std::vector<outs_for_amount>& fetched, std::time_t now);
+  //random outputs from the pools, in the order of amounts. a pool smaller than outsCount gives all its outputs
+  std::vector<outs_for_amount> draw(const std::vector<uint64_t>& amounts, uint64_t outsCount) const;
+  //drops the oldest pools above the policy limit
+  void trim();
+  void clear();
+
+private:
+  struct Pool {
+    std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry> outs;
+    std::time_t updated;
+  };
+
+  bool isFresh(const Pool& pool, std::time_t now) const;
+
+  DecoyCachePolicy m_policy;
+  std::unordered_map<uint64_t, Pool> m_pools;
+};
+
+}
@@ -5,11 +5,13 @@
 #include "WalletGreen.h"
 
 #include <algorithm>
+#include <atomic>
 #include <ctime>
 #include <cassert>
 #include <numeric>
 #include <random>
 #include <set>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -220,6 +222,21 @@ cryptonote::account_public_address_t parseAccountAddressString(const std::string
   return address;
 }
 
+// Zeroes through a volatile pointer, the compiler may drop plain stores to memory that is not read again
+void wipe(void* data, size_t size) {
+  volatile uint8_t* p = static_cast<volatile uint8_t*>(data);
+  while (size--) {
+    *p++ = 0;
+  }
+}
+
+// clear() only moves the end, the characters stay in the string's buffer up to its capacity
+void wipe(std::string& secret) {
+  secret.resize(secret.capacity());
+  wipe(&secret[0], secret.size());
+  secret.clear();
+}
+
 }
 
 namespace cryptonote {
@@ -229,6 +246,7 @@ WalletGreen::WalletGreen(System::Dispatcher& dispatcher, const Currency& currenc
   m_currency(currency),
   m_node(node),
   m_stopped(false),
+  m_fullSaveRequired(true),
   m_blockchainSynchronizerStarted(false),
   m_blockchainSynchronizer(node, currency.genesisBlockHash()),
   m_synchronizer(currency, m_blockchainSynchronizer, node),
@@ -287,6 +305,9 @@ void WalletGreen::doShutdown() {
   std::queue<WalletEvent> noEvents;
   std::swap(m_events, noEvents);
 
+  wipe(m_password);
+  wipe(&m_key, sizeof(m_key));
+
   m_state = WalletState::NOT_INITIALIZED;
 }
 
@@ -299,7 +320,10 @@ void WalletGreen::clearCaches() {
   m_unlockTransactionsJob.clear();
   m_transactions.clear();
   m_transfers.clear();
+  m_addressTransactions.clear();
+  m_decoyCache.clear();
   m_uncommitedTransactions.clear();
+  m_changedTransactions.clear();
   m_actualBalance = 0;
   m_pendingBalance = 0;
   m_fusionTxsCache.clear();
@@ -316,11 +340,13 @@ void WalletGreen::initWithKeys(const public_key_t& viewPublicKey, const secret_k
   m_viewPublicKey = viewPublicKey;
   m_viewSecretKey = viewSecretKey;
   m_password = password;
+  generate_chacha_key(m_password, m_key);
 
   assert(m_blockchain.empty());
   m_blockchain.push_back(m_currency.genesisBlockHash());
 
   m_blockchainSynchronizer.addObserver(this);
+  m_fullSaveRequired = true;
 
   m_state = WalletState::INITIALIZED;
 }
@@ -332,10 +358,78 @@ void WalletGreen::save(std::ostream& destination, bool saveDetails, bool saveCac
   stopBlockchainSynchronizer();
 
   unsafeSave(destination, saveDetails, saveCache);
+  if (saveDetails) {
+    // Created transactions are left out of a save without cache, they still have to reach the journal
+    forgetSavedTransactions(saveCache);
+  }
+
+  // A snapshot without transaction details can't be brought up to date by change records
+  m_fullSaveRequired = !saveDetails;
 
   startBlockchainSynchronizer();
 }
 
+bool WalletGreen::saveChanges(std::ostream& destination) {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  if (m_fullSaveRequired) {
+    return false;
+  }
+
+  // Transactions and transfers are only modified on the dispatcher, so unlike save() there is no need
+  // to stop the synchronizer. Created transactions are not committed yet and are written once they change state.
+  std::vector<size_t> changedTransactions;
+  changedTransactions.reserve(m_changedTransactions.size());
+  for (auto id: m_changedTransactions) {
+    if (m_transactions.get<RandomAccessIndex>()[id].state != WalletTransactionState::CREATED) {
+      changedTransactions.push_back(id);
+    }
+  }
+
+  if (changedTransactions.empty()) {
+    return true;
+  }
+
+  WalletSerializer s(
+    *this,
+    m_viewPublicKey,
+    m_viewSecretKey,
+    m_actualBalance,
+    m_pendingBalance,
+    m_walletsContainer,
+    m_synchronizer,
+    m_unlockTransactionsJob,
+    m_transactions,
+    m_transfers,
+    m_transactionSoftLockTime,
+    m_uncommitedTransactions
+  );
+
+  Writer output(destination);
+  s.saveChanges(m_key, output, changedTransactions);
+
+  forgetSavedTransactions(false);
+  return true;
+}
+
+void WalletGreen::forgetSavedTransactions(bool createdSaved) {
+  if (createdSaved) {
+    m_changedTransactions.clear();
+    return;
+  }
+
+  // Created transactions stay in the journal until they are sent or deleted and can be written
+  auto& transactions = m_transactions.get<RandomAccessIndex>();
+  for (auto it = m_changedTransactions.begin(); it != m_changedTransactions.end();) {
+    if (transactions[*it].state == WalletTransactionState::CREATED) {
+      ++it;
+    } else {
+      it = m_changedTransactions.erase(it);
+    }
+  }
+}
+
 void WalletGreen::unsafeSave(std::ostream& destination, bool saveDetails, bool saveCache) {
   WalletTransactions transactions;
   WalletTransfers transfers;
@@ -366,10 +460,17 @@ void WalletGreen::unsafeSave(std::ostream& destination, bool saveDetails, bool s
   );
 
   Writer output(destination);
-  s.save(m_password, output, saveDetails, saveCache);
+  s.save(m_key, output, saveDetails, saveCache);
 }
 
 void WalletGreen::load(std::istream& source, const std::string& password) {
+  chacha_key_t key;
+  generate_chacha_key(password, key);
+
+  load(source, password, key);
+}
+
+void WalletGreen::load(std::istream& source, const std::string& password, const chacha_key_t& key) {
   if (m_state != WalletState::NOT_INITIALIZED) {
     throw std::system_error(make_error_code(error::WRONG_STATE));
   }
@@ -378,7 +479,7 @@ void WalletGreen::load(std::istream& source, const std::string& password) {
 
   stopBlockchainSynchronizer();
 
-  unsafeLoad(source, password);
+  unsafeLoad(source, password, key);
 
   assert(m_blockchain.empty());
   if (m_walletsContainer.get<RandomAccessIndex>().size() != 0) {
@@ -393,7 +494,7 @@ void WalletGreen::load(std::istream& source, const std::string& password) {
   m_state = WalletState::INITIALIZED;
 }
 
-void WalletGreen::unsafeLoad(std::istream& source, const std::string& password) {
+void WalletGreen::unsafeLoad(std::istream& source, const std::string& password, const chacha_key_t& key) {
   WalletSerializer s(
     *this,
     m_viewPublicKey,
@@ -410,9 +511,13 @@ void WalletGreen::unsafeLoad(std::istream& source, const std::string& password)
   );
 
   Reader inputStream(source);
-  s.load(password, inputStream);
+  s.load(key, inputStream);
+  rebuildAddressTransactions();
 
   m_password = password;
+  m_key = key;
+  m_changedTransactions.clear();
+  m_fullSaveRequired = false;
   m_blockchainSynchronizer.addObserver(this);
 }
 
@@ -424,7 +529,10 @@ void WalletGreen::changePassword(const std::string& oldPassword, const std::stri
     throw std::system_error(make_error_code(error::WRONG_PASSWORD));
   }
 
+  wipe(m_password);
   m_password = newPassword;
+  generate_chacha_key(m_password, m_key);
+  m_fullSaveRequired = true;
 }
 
 size_t WalletGreen::getAddressCount() const {
@@ -519,10 +627,11 @@ std::string WalletGreen::doCreateAddress(const public_key_t& spendPublicKey, con
 
     if (creationTimestamp + m_currency.blockFutureTimeLimit() < currentTime) {
       std::string password = m_password;
+      chacha_key_t key = m_key;
       std::stringstream ss;
       unsafeSave(ss, true, false);
       shutdown();
-      load(ss, password);
+      load(ss, password, key);
     }
   } catch (std::exception&) {
     startBlockchainSynchronizer();
@@ -530,6 +639,7 @@ std::string WalletGreen::doCreateAddress(const public_key_t& spendPublicKey, con
   }
 
   startBlockchainSynchronizer();
+  m_fullSaveRequired = true;
 
   return address;
 }
@@ -602,6 +712,7 @@ void WalletGreen::deleteAddress(const std::string& address) {
   deleteFromUncommitedTransactions(deletedTransactions);
 
   m_walletsContainer.get<KeysIndex>().erase(it);
+  m_fullSaveRequired = true;
 
   if (m_walletsContainer.get<RandomAccessIndex>().size() != 0) {
     startBlockchainSynchronizer();
@@ -708,6 +819,71 @@ size_t WalletGreen::transfer(const TransactionParameters& transactionParameters)
   return doTransfer(transactionParameters);
 }
 
+std::vector<size_t> WalletGreen::transfer(const std::vector<TransactionParameters>& sendingTransactions) {
+  Tools::ScopeExit releaseContext([this] {
+    m_dispatcher.yield();
+  });
+
+  System::EventLock lk(m_readyEvent);
+
+  throwIfNotInitialized();
+  throwIfTrackingMode();
+  throwIfStopped();
+
+  std::vector<BatchTransaction> batch(sendingTransactions.size());
+  std::set<std::pair<uint64_t, uint32_t>> usedOutputs;
+  for (size_t i = 0; i < sendingTransactions.size(); ++i) {
+    batch[i].parameters = &sendingTransactions[i];
+    selectBatchTransfers(batch[i], usedOutputs);
+  }
+
+  requestBatchMixinOuts(batch);
+  buildBatchTransactions(batch);
+
+  std::vector<size_t> transactionIds;
+  transactionIds.reserve(batch.size());
+  Tools::ScopeExit rollbackTransactions([this, &transactionIds] {
+    for (auto transactionId: transactionIds) {
+      try {
+        removeUnconfirmedTransaction(BinaryArray::objectHash(m_uncommitedTransactions[transactionId]));
+      } catch (...) {
+      }
+
+      m_uncommitedTransactions.erase(transactionId);
+      updateTransactionStateAndPushEvent(transactionId, WalletTransactionState::FAILED);
+    }
+  });
+
+  for (auto& batchTransaction: batch) {
+    const PreparedTransaction& prepared = batchTransaction.preparedTransaction;
+    transactionIds.push_back(validateSaveAndSendTransaction(*prepared.transaction, prepared.destinations, false, false));
+  }
+
+  rollbackTransactions.cancel();
+
+  auto relayErrors = relayTransactions(transactionIds);
+  for (size_t i = 0; i < transactionIds.size(); ++i) {
+    size_t transactionId = transactionIds[i];
+    if (relayErrors[i]) {
+      try {
+        removeUnconfirmedTransaction(BinaryArray::objectHash(m_uncommitedTransactions[transactionId]));
+      } catch (...) {
+        // the transaction is deleted during transaction pool synchronization after wallet relaunch
+      }
+    }
+
+    m_uncommitedTransactions.erase(transactionId);
+    updateTransactionStateAndPushEvent(transactionId, relayErrors[i] ? WalletTransactionState::FAILED : WalletTransactionState::SUCCEEDED);
+  }
+
+  return transactionIds;
+}
+
+void WalletGreen::setDecoyCachePolicy(const DecoyCachePolicy& policy) {
+  System::EventLock lk(m_readyEvent);
+  m_decoyCache.setPolicy(policy);
+}
+
 void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
   const std::vector<WalletOrder>& orders,
   uint64_t fee,
@@ -735,6 +911,20 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
     requestMixinOuts(selectedTransfers, mixIn, mixinResult);
   }
 
+  buildTransaction(selectedTransfers, mixinResult, foundMoney, mixIn, extra, unlockTimestamp, donation, changeDestination, preparedTransaction);
+}
+
+//doesn't touch wallet state, so it may run outside of the dispatcher thread
+void WalletGreen::buildTransaction(const std::vector<OutputToTransfer>& selectedTransfers,
+  std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult,
+  uint64_t foundMoney,
+  uint64_t mixIn,
+  const std::string& extra,
+  uint64_t unlockTimestamp,
+  const DonationSettings& donation,
+  const cryptonote::account_public_address_t& changeDestination,
+  PreparedTransaction& preparedTransaction) const {
+
   std::vector<InputInfo> keysInfo;
   prepareInputs(selectedTransfers, mixinResult, mixIn, keysInfo);
 
@@ -822,6 +1012,152 @@ size_t WalletGreen::doTransfer(const TransactionParameters& transactionParameter
   return validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, false, true);
 }
 
+void WalletGreen::selectBatchTransfers(BatchTransaction& batchTransaction, std::set<std::pair<uint64_t, uint32_t>>& usedOutputs) {
+  const TransactionParameters& parameters = *batchTransaction.parameters;
+
+  validateTransactionParameters(parameters);
+  batchTransaction.changeDestination = getChangeDestination(parameters.changeDestination, parameters.sourceAddresses);
+
+  std::vector<WalletOuts> wallets;
+  if (!parameters.sourceAddresses.empty()) {
+    wallets = pickWallets(parameters.sourceAddresses);
+  } else {
+    wallets = pickWalletsWithMoney();
+  }
+
+  //outputs spent by earlier transactions of the batch are not unconfirmed yet, so skip them here
+  for (auto& wallet: wallets) {
+    wallet.outs.erase(std::remove_if(wallet.outs.begin(), wallet.outs.end(), [&usedOutputs] (const TransactionOutputInformation& out) {
+      return usedOutputs.count(std::make_pair(out.amount, out.globalOutputIndex)) != 0;
+    }), wallet.outs.end());
+  }
+
+  wallets.erase(std::remove_if(wallets.begin(), wallets.end(), [] (const WalletOuts& wallet) {
+    return wallet.outs.empty();
+  }), wallets.end());
+
+  PreparedTransaction& preparedTransaction = batchTransaction.preparedTransaction;
+  preparedTransaction.destinations = convertOrdersToTransfers(parameters.destinations);
+  preparedTransaction.neededMoney = countNeededMoney(preparedTransaction.destinations, parameters.fee);
+
+  batchTransaction.foundMoney = selectTransfers(preparedTransaction.neededMoney, parameters.mixIn == 0, m_currency.defaultDustThreshold(),
+    std::move(wallets), batchTransaction.selectedTransfers);
+
+  if (batchTransaction.foundMoney < preparedTransaction.neededMoney) {
+    throw std::system_error(make_error_code(error::WRONG_AMOUNT), "Not enough money");
+  }
+
+  for (const auto& transfer: batchTransaction.selectedTransfers) {
+    usedOutputs.emplace(transfer.out.amount, transfer.out.globalOutputIndex);
+  }
+}
+
+void WalletGreen::requestBatchMixinOuts(std::vector<BatchTransaction>& batch) {
+  typedef cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount outs_for_amount;
+
+  std::vector<uint64_t> amounts;
+  uint64_t mixIn = 0;
+  for (const auto& batchTransaction: batch) {
+    if (batchTransaction.parameters->mixIn != 0) {
+      for (const auto& transfer: batchTransaction.selectedTransfers) {
+        amounts.push_back(transfer.out.amount);
+      }
+
+      mixIn = std::max(mixIn, batchTransaction.parameters->mixIn);
+    }
+  }
+
+  if (mixIn == 0) {
+    return;
+  }
+
+  std::vector<outs_for_amount> mixinResult;
+  requestRandomOuts(std::move(amounts), mixIn, mixinResult);
+  if (mixinResult.size() != std::accumulate(batch.begin(), batch.end(), size_t(0), [] (size_t count, const BatchTransaction& batchTransaction) {
+    return count + (batchTransaction.parameters->mixIn != 0 ? batchTransaction.selectedTransfers.size() : 0);
+  })) {
+    throw std::system_error(make_error_code(error::INTERNAL_WALLET_ERROR), "Wrong random outputs count");
+  }
+
+  //the daemon returns outputs in random order, so taking the first ones is the same as asking for fewer
+  auto resultIt = mixinResult.begin();
+  for (auto& batchTransaction: batch) {
+    uint64_t transactionMixIn = batchTransaction.parameters->mixIn;
+    if (transactionMixIn == 0) {
+      continue;
+    }
+
+    size_t inputCount = batchTransaction.selectedTransfers.size();
+    batchTransaction.mixinResult.assign(std::make_move_iterator(resultIt), std::make_move_iterator(resultIt + inputCount));
+    resultIt += inputCount;
+
+    for (auto& outs: batchTransaction.mixinResult) {
+      if (outs.outs.size() > transactionMixIn) {
+        outs.outs.resize(transactionMixIn);
+      }
+    }
+
+    checkIfEnoughMixins(batchTransaction.mixinResult, transactionMixIn);
+  }
+}
+
+void WalletGreen::buildBatchTransactions(std::vector<BatchTransaction>& batch) const {
+  std::atomic<size_t> nextTransaction(0);
+  auto buildTransactions = [this, &batch, &nextTransaction] {
+    for (size_t i = nextTransaction++; i < batch.size(); i = nextTransaction++) {
+      BatchTransaction& batchTransaction = batch[i];
+      const TransactionParameters& parameters = *batchTransaction.parameters;
+
+      buildTransaction(batchTransaction.selectedTransfers,
+        batchTransaction.mixinResult,
+        batchTransaction.foundMoney,
+        parameters.mixIn,
+        parameters.extra,
+        parameters.unlockTimestamp,
+        parameters.donation,
+        batchTransaction.changeDestination,
+        batchTransaction.preparedTransaction);
+    }
+  };
+
+  size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), batch.size());
+
+  std::vector<std::unique_ptr<System::RemoteContext<void>>> workers;
+  for (size_t i = 0; i < threadCount; ++i) {
+    workers.emplace_back(new System::RemoteContext<void>(m_dispatcher, buildTransactions));
+  }
+
+  for (auto& worker: workers) {
+    worker->get();
+  }
+}
+
+std::vector<std::error_code> WalletGreen::relayTransactions(const std::vector<size_t>& transactionIds) {
+  std::vector<std::error_code> errors(transactionIds.size());
+  if (transactionIds.empty()) {
+    return errors;
+  }
+
+  System::Event completion(m_dispatcher);
+  size_t pendingCount = transactionIds.size();
+
+  throwIfStopped();
+
+  for (size_t i = 0; i < transactionIds.size(); ++i) {
+    m_node.relayTransaction(m_uncommitedTransactions[transactionIds[i]], [&errors, &completion, &pendingCount, i, this](std::error_code error) {
+      errors[i] = error;
+      this->m_dispatcher.remoteSpawn([&completion, &pendingCount] {
+        if (--pendingCount == 0) {
+          completion.set();
+        }
+      });
+    });
+  }
+
+  completion.wait();
+  return errors;
+}
+
 size_t WalletGreen::makeTransaction(const TransactionParameters& sendingTransaction) {
   throwIfNotInitialized();
   throwIfTrackingMode();
@@ -924,10 +1260,37 @@ void WalletGreen::pushBackOutgoingTransfers(size_t txId, const std::vector<Walle
     d.address = dest.address;
     d.amount = dest.amount;
 
+    indexTransfer(txId, d.address);
     m_transfers.emplace_back(txId, std::move(d));
   }
 }
 
+void WalletGreen::indexTransfer(size_t transactionId, const std::string& address) {
+  if (!address.empty()) {
+    uint32_t blockHeight = m_transactions.get<RandomAccessIndex>()[transactionId].blockHeight;
+    m_addressTransactions[address].emplace(blockHeight, transactionId);
+  }
+}
+
+void WalletGreen::reindexTransactionHeight(size_t transactionId, uint32_t previousHeight) {
+  uint32_t blockHeight = m_transactions.get<RandomAccessIndex>()[transactionId].blockHeight;
+  auto bounds = getTransactionTransfersRange(transactionId);
+  for (auto it = bounds.first; it != bounds.second; ++it) {
+    auto addressIt = m_addressTransactions.find(it->second.address);
+    if (addressIt != m_addressTransactions.end()) {
+      addressIt->second.erase(std::make_pair(previousHeight, transactionId));
+      addressIt->second.emplace(blockHeight, transactionId);
+    }
+  }
+}
+
+void WalletGreen::rebuildAddressTransactions() {
+  m_addressTransactions.clear();
+  for (const auto& transfer: m_transfers) {
+    indexTransfer(transfer.first, transfer.second.address);
+  }
+}
+
 size_t WalletGreen::insertOutgoingTransactionAndPushEvent(const hash_t& transactionHash, uint64_t fee, const binary_array_t& extra, uint64_t unlockTimestamp) {
   WalletTransaction insertTx;
   insertTx.state = WalletTransactionState::CREATED;
@@ -935,6 +1298,7 @@ size_t WalletGreen::insertOutgoingTransactionAndPushEvent(const hash_t& transact
   insertTx.unlockTime = unlockTimestamp;
   insertTx.blockHeight = cryptonote::WALLET_UNCONFIRMED_TRANSACTION_HEIGHT;
   insertTx.extra.assign(reinterpret_cast<const char*>(extra.data()), extra.size());
+  insertTx.paymentId = getPaymentIdFromExtra(insertTx.extra);
   insertTx.fee = fee;
   insertTx.hash = transactionHash;
   insertTx.totalAmount = 0; // 0 until transactionHandlingEnd() is called
@@ -965,6 +1329,7 @@ bool WalletGreen::updateWalletTransactionInfo(size_t transactionId, const crypto
   auto& txIdIndex = m_transactions.get<RandomAccessIndex>();
   assert(transactionId < txIdIndex.size());
   auto it = std::next(txIdIndex.begin(), transactionId);
+  uint32_t previousHeight = it->blockHeight;
 
   bool updated = false;
   bool r = txIdIndex.modify(it, [&info, totalAmount, &updated](WalletTransaction& transaction) {
@@ -996,6 +1361,7 @@ bool WalletGreen::updateWalletTransactionInfo(size_t transactionId, const crypto
     // Fix LegacyWallet error. Some old versions didn't fill extra field
     if (transaction.extra.empty() && !info.extra.empty()) {
       transaction.extra = IBinary::to(info.extra);
+      transaction.paymentId = info.paymentId;
       updated = true;
     }
 
@@ -1008,6 +1374,10 @@ bool WalletGreen::updateWalletTransactionInfo(size_t transactionId, const crypto
 
   assert(r);
 
+  if (previousHeight != info.blockHeight) {
+    reindexTransactionHeight(transactionId, previousHeight);
+  }
+
   return updated;
 }
 
@@ -1028,6 +1398,7 @@ size_t WalletGreen::insertBlockchainTransaction(const transaction_infomation_t&
 
   tx.unlockTime = info.unlockTime;
   tx.extra.assign(reinterpret_cast<const char*>(info.extra.data()), info.extra.size());
+  tx.paymentId = info.paymentId;
   tx.totalAmount = txBalance;
   tx.creationTime = info.timestamp;
 
@@ -1164,6 +1535,7 @@ void WalletGreen::appendTransfer(size_t transactionId, size_t firstTransferIdx,
 
   WalletTransfer transfer{ WalletTransferType::USUAL, address, amount };
   m_transfers.emplace(insertIt, std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
+  indexTransfer(transactionId, address);
 }
 
 bool WalletGreen::adjustTransfer(size_t transactionId, size_t firstTransferIdx, const std::string& address, int64_t amount) {
@@ -1197,6 +1569,7 @@ bool WalletGreen::adjustTransfer(size_t transactionId, size_t firstTransferIdx,
   if (!firstAddressTransferFound) {
     WalletTransfer transfer{ WalletTransferType::USUAL, address, amount };
     m_transfers.emplace(it, std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
+    indexTransfer(transactionId, address);
     updated = true;
   }
 
@@ -1234,7 +1607,7 @@ bool WalletGreen::eraseForeignTransfers(size_t transactionId, size_t firstTransf
 }
 
 std::unique_ptr<cryptonote::ITransaction> WalletGreen::makeTransaction(const std::vector<ReceiverAmounts>& decomposedOutputs,
-  std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp) {
+  std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp) const {
 
   std::unique_ptr<ITransaction> tx = createTransaction();
 
@@ -1351,20 +1724,48 @@ void WalletGreen::requestMixinOuts(
     amounts.push_back(out.out.amount);
   }
 
+  requestRandomOuts(std::move(amounts), mixIn, mixinResult);
+  checkIfEnoughMixins(mixinResult, mixIn);
+}
+
+//decoys come from the local pools, only amounts with a missing or outdated pool are asked from the node
+void WalletGreen::requestRandomOuts(std::vector<uint64_t>&& amounts,
+  uint64_t outsCount,
+  std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result) {
+
+  if (!m_decoyCache.canServe(outsCount)) {
+    fetchRandomOuts(std::move(amounts), outsCount, result);
+    return;
+  }
+
+  std::time_t now = std::time(nullptr);
+  std::vector<uint64_t> staleAmounts = m_decoyCache.getStaleAmounts(amounts, now);
+  if (!staleAmounts.empty()) {
+    std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> fetched;
+    fetchRandomOuts(std::move(staleAmounts), m_decoyCache.getPolicy().outputsPerAmount, fetched);
+    m_decoyCache.update(fetched, now);
+  }
+
+  result = m_decoyCache.draw(amounts, outsCount);
+  m_decoyCache.trim();
+}
+
+void WalletGreen::fetchRandomOuts(std::vector<uint64_t>&& amounts,
+  uint64_t outsCount,
+  std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result) {
+
   System::Event requestFinished(m_dispatcher);
   std::error_code mixinError;
 
   throwIfStopped();
 
-  m_node.getRandomOutsByAmounts(std::move(amounts), mixIn, mixinResult, [&requestFinished, &mixinError, this] (std::error_code ec) {
+  m_node.getRandomOutsByAmounts(std::move(amounts), outsCount, result, [&requestFinished, &mixinError, this] (std::error_code ec) {
     mixinError = ec;
     this->m_dispatcher.remoteSpawn(std::bind(asyncRequestCompletion, std::ref(requestFinished)));
   });
 
   requestFinished.wait();
 
-  checkIfEnoughMixins(mixinResult, mixIn);
-
   if (mixinError) {
     throw std::system_error(mixinError);
   }
@@ -1476,7 +1877,7 @@ std::vector<WalletGreen::WalletOuts> WalletGreen::pickWallets(const std::vector<
 
 std::vector<cryptonote::WalletGreen::ReceiverAmounts> WalletGreen::splitDestinations(const std::vector<cryptonote::WalletTransfer>& destinations,
   uint64_t dustThreshold,
-  const cryptonote::Currency& currency) {
+  const cryptonote::Currency& currency) const {
 
   std::vector<ReceiverAmounts> decomposedOutputs;
   for (const auto& destination: destinations) {
@@ -1491,7 +1892,7 @@ std::vector<cryptonote::WalletGreen::ReceiverAmounts> WalletGreen::splitDestinat
 cryptonote::WalletGreen::ReceiverAmounts WalletGreen::splitAmount(
   uint64_t amount,
   const account_public_address_t& destination,
-  uint64_t dustThreshold) {
+  uint64_t dustThreshold) const {
 
   ReceiverAmounts receiverAmounts;
 
@@ -1504,7 +1905,7 @@ void WalletGreen::prepareInputs(
   const std::vector<OutputToTransfer>& selectedTransfers,
   std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult,
   uint64_t mixIn,
-  std::vector<InputInfo>& keysInfo) {
+  std::vector<InputInfo>& keysInfo) const {
 
   typedef cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry out_entry;
 
@@ -1576,15 +1977,11 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(const hash_t&
   throwIfNotInitialized();
   throwIfStopped();
 
-  auto& hashIndex = m_blockchain.get<BlockHashIndex>();
-  auto it = hashIndex.find(blockHash);
-  if (it == hashIndex.end()) {
+  uint32_t blockIndex = getBlockIndex(blockHash);
+  if (blockIndex == std::numeric_limits<uint32_t>::max()) {
     return std::vector<TransactionsInBlockInfo>();
   }
 
-  auto heightIt = m_blockchain.project<BlockHeightIndex>(it);
-
-  uint32_t blockIndex = static_cast<uint32_t>(std::distance(m_blockchain.get<BlockHeightIndex>().begin(), heightIt));
   return getTransactionsInBlocks(blockIndex, count);
 }
 
@@ -1595,6 +1992,63 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(uint32_t block
   return getTransactionsInBlocks(blockIndex, count);
 }
 
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(const std::vector<std::string>& addresses, const hash_t& blockHash, size_t count) const {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  uint32_t blockIndex = getBlockIndex(blockHash);
+  if (blockIndex == std::numeric_limits<uint32_t>::max()) {
+    return std::vector<TransactionsInBlockInfo>();
+  }
+
+  return getTransactionsInBlocks(addresses, blockIndex, count);
+}
+
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  return getTransactionsInBlocks(addresses, blockIndex, count);
+}
+
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsByPaymentId(const hash_t& paymentId) const {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  std::vector<TransactionsInBlockInfo> result;
+  // Transactions without a payment id all share NULL_HASH, it never names a payment
+  if (paymentId == NULL_HASH) {
+    return result;
+  }
+
+  std::vector<const WalletTransaction*> transactions;
+  auto range = m_transactions.get<TransactionPaymentIdIndex>().equal_range(paymentId);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->state == WalletTransactionState::SUCCEEDED && it->blockHeight < m_blockchain.size()) {
+      transactions.push_back(&*it);
+    }
+  }
+
+  std::sort(transactions.begin(), transactions.end(), [] (const WalletTransaction* lhs, const WalletTransaction* rhs) {
+    return lhs->blockHeight < rhs->blockHeight;
+  });
+
+  for (const WalletTransaction* transaction: transactions) {
+    if (result.empty() || result.back().blockHash != m_blockchain[transaction->blockHeight]) {
+      TransactionsInBlockInfo info;
+      info.blockHash = m_blockchain[transaction->blockHeight];
+      result.emplace_back(std::move(info));
+    }
+
+    WalletTransactionWithTransfers transactionWithTransfers;
+    transactionWithTransfers.transaction = *transaction;
+    transactionWithTransfers.transfers = getTransactionTransfers(*transaction);
+    result.back().transactions.emplace_back(std::move(transactionWithTransfers));
+  }
+
+  return result;
+}
+
 std::vector<hash_t> WalletGreen::getBlockHashes(uint32_t blockIndex, size_t count) const {
   throwIfNotInitialized();
   throwIfStopped();
@@ -1750,6 +2204,9 @@ void WalletGreen::blocksRollback(uint32_t blockIndex) {
 
   auto& blockHeightIndex = m_blockchain.get<BlockHeightIndex>();
   blockHeightIndex.erase(std::next(blockHeightIndex.begin(), blockIndex), blockHeightIndex.end());
+
+  //cached decoys may come from the detached blocks
+  m_decoyCache.clear();
 }
 
 void WalletGreen::onTransactionDeleteBegin(const public_key_t& viewPublicKey, hash_t transactionHash) {
@@ -1862,6 +2319,12 @@ void WalletGreen::transactionUpdated(const transaction_infomation_t& transaction
 }
 
 void WalletGreen::pushEvent(const WalletEvent& event) {
+  if (event.type == WalletEventType::TRANSACTION_CREATED) {
+    m_changedTransactions.insert(event.transactionCreated.transactionIndex);
+  } else if (event.type == WalletEventType::TRANSACTION_UPDATED) {
+    m_changedTransactions.insert(event.transactionUpdated.transactionIndex);
+  }
+
   m_events.push(event);
   m_eventOccurred.set();
 }
@@ -1900,6 +2363,7 @@ void WalletGreen::transactionDeleted(ITransfersSubscription* object, const hash_
   updateBalance(container);
   deleteUnlockTransactionJob(transactionHash);
 
+  uint32_t previousHeight = it->blockHeight;
   bool updated = false;
   m_transactions.get<TransactionIndex>().modify(it, [&updated](cryptonote::WalletTransaction& tx) {
     if (tx.state == WalletTransactionState::CREATED || tx.state == WalletTransactionState::SUCCEEDED) {
@@ -1915,6 +2379,10 @@ void WalletGreen::transactionDeleted(ITransfersSubscription* object, const hash_
 
   if (updated) {
     auto transactionId = getTransactionId(transactionHash);
+    if (previousHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT) {
+      reindexTransactionHeight(transactionId, previousHeight);
+    }
+
     pushEvent(makeTransactionUpdatedEvent(transactionId));
   }
 }
@@ -2300,13 +2768,13 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32
   auto& blockHeightIndex = m_transactions.get<BlockHeightIndex>();
   uint32_t stopIndex = static_cast<uint32_t>(std::min(m_blockchain.size(), blockIndex + count));
 
+  // one search for the first block, the transactions of the following blocks come next in the height index
+  auto it = blockHeightIndex.lower_bound(blockIndex);
   for (uint32_t height = blockIndex; height < stopIndex; ++height) {
     TransactionsInBlockInfo info;
     info.blockHash = m_blockchain[height];
 
-    auto lowerBound = blockHeightIndex.lower_bound(height);
-    auto upperBound = blockHeightIndex.upper_bound(height);
-    for (auto it = lowerBound; it != upperBound; ++it) {
+    for (; it != blockHeightIndex.end() && it->blockHeight == height; ++it) {
       if (it->state != WalletTransactionState::SUCCEEDED) {
         continue;
       }
@@ -2325,6 +2793,72 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32
   return result;
 }
 
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const {
+  if (count == 0) {
+    throw std::system_error(make_error_code(error::WRONG_PARAMETERS), "blocks count must be greater than zero");
+  }
+
+  std::vector<TransactionsInBlockInfo> result;
+
+  if (blockIndex >= m_blockchain.size()) {
+    return result;
+  }
+
+  uint32_t stopIndex = static_cast<uint32_t>(std::min(m_blockchain.size(), blockIndex + count));
+  result.resize(stopIndex - blockIndex);
+  for (uint32_t height = blockIndex; height < stopIndex; ++height) {
+    result[height - blockIndex].blockHash = m_blockchain[height];
+  }
+
+  // only the entries of the requested blocks are visited, each address index is ordered by height
+  std::set<size_t> transactionIds;
+  for (const auto& address: addresses) {
+    auto it = m_addressTransactions.find(address);
+    if (it == m_addressTransactions.end()) {
+      continue;
+    }
+
+    auto last = it->second.lower_bound(std::make_pair(stopIndex, static_cast<size_t>(0)));
+    for (auto entry = it->second.lower_bound(std::make_pair(blockIndex, static_cast<size_t>(0))); entry != last; ++entry) {
+      transactionIds.insert(entry->second);
+    }
+  }
+
+  auto& transactions = m_transactions.get<RandomAccessIndex>();
+  for (size_t transactionId: transactionIds) {
+    const WalletTransaction& transaction = transactions[transactionId];
+    if (transaction.state != WalletTransactionState::SUCCEEDED || transaction.blockHeight < blockIndex || transaction.blockHeight >= stopIndex) {
+      continue;
+    }
+
+    WalletTransactionWithTransfers transactionWithTransfers;
+    transactionWithTransfers.transaction = transaction;
+    transactionWithTransfers.transfers = getTransactionTransfers(transaction);
+
+    bool hasAddress = std::any_of(transactionWithTransfers.transfers.begin(), transactionWithTransfers.transfers.end(), [&addresses] (const WalletTransfer& transfer) {
+      return std::find(addresses.begin(), addresses.end(), transfer.address) != addresses.end();
+    });
+
+    if (hasAddress) {
+      result[transaction.blockHeight - blockIndex].transactions.emplace_back(std::move(transactionWithTransfers));
+    }
+  }
+
+  return result;
+}
+
+uint32_t WalletGreen::getBlockIndex(const hash_t& blockHash) const {
+  auto& hashIndex = m_blockchain.get<BlockHashIndex>();
+  auto it = hashIndex.find(blockHash);
+  if (it == hashIndex.end()) {
+    return std::numeric_limits<uint32_t>::max();
+  }
+
+  // BlockHeightIndex is random access, so the position is a constant time subtraction
+  auto heightIt = m_blockchain.project<BlockHeightIndex>(it);
+  return static_cast<uint32_t>(heightIt - m_blockchain.get<BlockHeightIndex>().begin());
+}
+
 hash_t WalletGreen::getBlockHashByIndex(uint32_t blockIndex) const {
   assert(blockIndex < m_blockchain.size());
   return m_blockchain.get<BlockHeightIndex>()[blockIndex];
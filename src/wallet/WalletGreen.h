@@ -7,9 +7,11 @@
 #include "IWallet.h"
 
 #include <queue>
+#include <set>
 #include <unordered_map>
 
 #include "IFusionManager.h"
+#include "WalletDecoyCache.h"
 #include "WalletIndices.h"
 
 #include <system/Dispatcher.h>
@@ -35,6 +37,7 @@ public:
 
   virtual void changePassword(const std::string& oldPassword, const std::string& newPassword) override;
   virtual void save(std::ostream& destination, bool saveDetails = true, bool saveCache = true) override;
+  virtual bool saveChanges(std::ostream& destination) override;
 
   virtual size_t getAddressCount() const override;
   virtual std::string getAddress(size_t index) const override;
@@ -59,12 +62,16 @@ public:
   virtual WalletTransactionWithTransfers getTransaction(const hash_t& transactionHash) const override;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const hash_t& blockHash, size_t count) const override;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, const hash_t& blockHash, size_t count) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const hash_t& paymentId) const override;
   virtual std::vector<hash_t> getBlockHashes(uint32_t blockIndex, size_t count) const override;
   virtual uint32_t getBlockCount() const override;
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const override;
   virtual std::vector<size_t> getDelayedTransactionIds() const override;
 
   virtual size_t transfer(const TransactionParameters& sendingTransaction) override;
+  virtual std::vector<size_t> transfer(const std::vector<TransactionParameters>& sendingTransactions) override;
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) override;
   virtual void commitTransaction(size_t) override;
@@ -74,6 +81,8 @@ public:
   virtual void stop() override;
   virtual WalletEvent getEvent() override;
 
+  void setDecoyCachePolicy(const DecoyCachePolicy& policy);
+
   virtual size_t createFusionTransaction(uint64_t threshold, uint64_t mixin) override;
   virtual bool isFusionTransaction(size_t transactionId) const override;
   virtual IFusionManager::EstimateResult estimate(uint64_t threshold) const override;
@@ -185,6 +194,30 @@ protected:
     const cryptonote::account_public_address_t& changeDestinationAddress,
     PreparedTransaction& preparedTransaction);
 
+  void buildTransaction(const std::vector<OutputToTransfer>& selectedTransfers,
+    std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult,
+    uint64_t foundMoney,
+    uint64_t mixIn,
+    const std::string& extra,
+    uint64_t unlockTimestamp,
+    const DonationSettings& donation,
+    const cryptonote::account_public_address_t& changeDestinationAddress,
+    PreparedTransaction& preparedTransaction) const;
+
+  struct BatchTransaction {
+    const TransactionParameters* parameters;
+    cryptonote::account_public_address_t changeDestination;
+    std::vector<OutputToTransfer> selectedTransfers;
+    uint64_t foundMoney;
+    std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> mixinResult;
+    PreparedTransaction preparedTransaction;
+  };
+
+  void selectBatchTransfers(BatchTransaction& batchTransaction, std::set<std::pair<uint64_t, uint32_t>>& usedOutputs);
+  void requestBatchMixinOuts(std::vector<BatchTransaction>& batch);
+  void buildBatchTransactions(std::vector<BatchTransaction>& batch) const;
+  std::vector<std::error_code> relayTransactions(const std::vector<size_t>& transactionIds);
+
   void validateTransactionParameters(const TransactionParameters& transactionParameters);
   size_t doTransfer(const TransactionParameters& transactionParameters);
 
@@ -192,10 +225,17 @@ protected:
     uint64_t mixIn,
     std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult);
 
+  void requestRandomOuts(std::vector<uint64_t>&& amounts,
+    uint64_t outsCount,
+    std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result);
+  void fetchRandomOuts(std::vector<uint64_t>&& amounts,
+    uint64_t outsCount,
+    std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result);
+
   void prepareInputs(const std::vector<OutputToTransfer>& selectedTransfers,
     std::vector<cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& mixinResult,
     uint64_t mixIn,
-    std::vector<InputInfo>& keysInfo);
+    std::vector<InputInfo>& keysInfo) const;
 
   uint64_t selectTransfers(uint64_t needeMoney,
     bool dust,
@@ -204,11 +244,11 @@ protected:
     std::vector<OutputToTransfer>& selectedTransfers);
 
   std::vector<ReceiverAmounts> splitDestinations(const std::vector<WalletTransfer>& destinations,
-    uint64_t dustThreshold, const Currency& currency);
-  ReceiverAmounts splitAmount(uint64_t amount, const account_public_address_t& destination, uint64_t dustThreshold);
+    uint64_t dustThreshold, const Currency& currency) const;
+  ReceiverAmounts splitAmount(uint64_t amount, const account_public_address_t& destination, uint64_t dustThreshold) const;
 
   std::unique_ptr<cryptonote::ITransaction> makeTransaction(const std::vector<ReceiverAmounts>& decomposedOutputs,
-    std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp);
+    std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp) const;
 
   void sendTransaction(const cryptonote::transaction_t& cryptoNoteTransaction);
   size_t validateSaveAndSendTransaction(const ITransactionReader& transaction, const std::vector<WalletTransfer>& destinations, bool isFusion, bool send);
@@ -229,6 +269,9 @@ protected:
   bool eraseTransfersByAddress(size_t transactionId, size_t firstTransferIdx, const std::string& address, bool eraseOutputTransfers);
   bool eraseForeignTransfers(size_t transactionId, size_t firstTransferIdx, const std::unordered_set<std::string>& knownAddresses, bool eraseOutputTransfers);
   void pushBackOutgoingTransfers(size_t txId, const std::vector<WalletTransfer>& destinations);
+  void indexTransfer(size_t transactionId, const std::string& address);
+  void reindexTransactionHeight(size_t transactionId, uint32_t previousHeight);
+  void rebuildAddressTransactions();
   void insertUnlockTransactionJob(const hash_t& transactionHash, uint32_t blockHeight, cryptonote::ITransfersContainer* container);
   void deleteUnlockTransactionJob(const hash_t& transactionHash);
   void startBlockchainSynchronizer();
@@ -236,8 +279,10 @@ protected:
   void addUnconfirmedTransaction(const ITransactionReader& transaction);
   void removeUnconfirmedTransaction(const hash_t& transactionHash);
 
-  void unsafeLoad(std::istream& source, const std::string& password);
+  void load(std::istream& source, const std::string& password, const chacha_key_t& key);
+  void unsafeLoad(std::istream& source, const std::string& password, const chacha_key_t& key);
   void unsafeSave(std::ostream& destination, bool saveDetails, bool saveCache);
+  void forgetSavedTransactions(bool createdSaved);
 
   std::vector<OutputToTransfer> pickRandomFusionInputs(uint64_t threshold, size_t minInputCount, size_t maxInputCount);
   ReceiverAmounts decomposeFusionOutputs(uint64_t inputsAmount);
@@ -257,6 +302,8 @@ protected:
 
   TransfersRange getTransactionTransfersRange(size_t transactionIndex) const;
   std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(uint32_t blockIndex, size_t count) const;
+  std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const;
+  uint32_t getBlockIndex(const hash_t& blockHash) const;
   hash_t getBlockHashByIndex(uint32_t blockIndex) const;
 
   std::vector<WalletTransfer> getTransactionTransfers(const WalletTransaction& transaction) const;
@@ -278,8 +325,15 @@ protected:
   UnlockTransactionJobs m_unlockTransactionsJob;
   WalletTransactions m_transactions;
   WalletTransfers m_transfers; //sorted
+  // address -> (block height, id) of transactions with a transfer to or from it, ordered by height so
+  // that a block range is one lower_bound away. Entries are only added, so a transfer erased later
+  // leaves its transaction here and readers check the height and the transfers again
+  std::unordered_map<std::string, std::set<std::pair<uint32_t, size_t>>> m_addressTransactions;
+  WalletDecoyCache m_decoyCache;
   mutable std::unordered_map<size_t, bool> m_fusionTxsCache; // txIndex -> isFusion
   UncommitedTransactions m_uncommitedTransactions;
+  std::set<size_t> m_changedTransactions; // created or updated since the last save or load
+  bool m_fullSaveRequired; // keys or password changed since the last save or load
 
   bool m_blockchainSynchronizerStarted;
   BlockchainSynchronizer m_blockchainSynchronizer;
@@ -292,6 +346,7 @@ protected:
   WalletState m_state;
 
   std::string m_password;
+  chacha_key_t m_key; // derived from m_password once, the slow hash is too expensive to run on every save
 
   public_key_t m_viewPublicKey;
   secret_key_t m_viewSecretKey;
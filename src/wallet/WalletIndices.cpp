@@ -0,0 +1,23 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "WalletIndices.h"
+
+#include "cryptonote/core/key.h"
+#include "cryptonote/core/transaction/TransactionExtra.h"
+
+namespace cryptonote {
+
+hash_t getPaymentIdFromExtra(const std::string& extra) {
+  hash_t paymentId;
+  std::vector<uint8_t> extraBytes(extra.begin(), extra.end());
+
+  if (!getPaymentIdFromTxExtra(extraBytes, paymentId)) {
+    return NULL_HASH;
+  }
+
+  return paymentId;
+}
+
+}
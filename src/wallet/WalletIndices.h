@@ -42,6 +42,10 @@ struct BlockHeightIndex {};
 struct TransactionHashIndex {};
 struct TransactionIndex {};
 struct BlockHashIndex {};
+struct TransactionPaymentIdIndex {};
+
+// Payment id from a transaction extra, NULL_HASH if it has none. Parsed once when a transaction is stored
+hash_t getPaymentIdFromExtra(const std::string& extra);
 
 typedef boost::multi_index_container <
   WalletRecord,
@@ -81,6 +85,9 @@ typedef boost::multi_index_container <
     >,
     boost::multi_index::ordered_non_unique < boost::multi_index::tag <BlockHeightIndex>,
       boost::multi_index::member<cryptonote::WalletTransaction, uint32_t, &cryptonote::WalletTransaction::blockHeight >
+    >,
+    boost::multi_index::hashed_non_unique < boost::multi_index::tag <TransactionPaymentIdIndex>,
+      BOOST_MULTI_INDEX_MEMBER(cryptonote::WalletTransaction, hash_t, paymentId)
     >
   >
 > WalletTransactions;
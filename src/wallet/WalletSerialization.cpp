@@ -7,6 +7,7 @@
 #include <string>
 #include <sstream>
 #include <type_traits>
+#include <unordered_map>
 
 #include "stream/reader.h"
 #include "stream/writer.h"
@@ -21,6 +22,7 @@
 #include "stream/cryptonote.h"
 #include "stream/transaction.h"
 #include "stream/map.hpp"
+#include "cryptonote/crypto/hash.h"
 #include "cryptonote/structures/array.hpp"
 
 using namespace Common;
@@ -102,6 +104,16 @@ struct WalletTransferDto {
   uint32_t version;
 };
 
+//DO NOT CHANGE IT
+struct WalletTransactionChangeDto {
+  WalletTransactionChangeDto(uint32_t version) : version(version) {}
+
+  WalletTransactionDto transaction;
+  std::vector<WalletTransferDto> transfers;
+
+  uint32_t version;
+};
+
 void serialize(WalletRecordDto& value, cryptonote::ISerializer& serializer) {
   serializer(value.spendPublicKey, "spend_public_key");
   serializer(value.spendSecretKey, "spend_secret_key");
@@ -218,6 +230,32 @@ Writer &operator<<(Writer &o, const WalletTransferDto &v) {
   return o;
 }
 
+Reader &operator>>(Reader &i, WalletTransactionChangeDto &v) {
+  i >> v.transaction;
+
+  uint64_t count;
+  i >> count;
+  v.transfers.clear();
+  for (uint64_t j = 0; j < count; ++j) {
+    WalletTransferDto transfer(v.version);
+    i >> transfer;
+    v.transfers.push_back(std::move(transfer));
+  }
+
+  return i;
+}
+Writer &operator<<(Writer &o, const WalletTransactionChangeDto &v) {
+  o << v.transaction;
+
+  uint64_t count = v.transfers.size();
+  o << count;
+  for (const auto& transfer: v.transfers) {
+    o << transfer;
+  }
+
+  return o;
+}
+
 template <typename Object>
 std::string serialize(Object& obj, const std::string& name) {
   std::stringstream stream;
@@ -307,6 +345,7 @@ cryptonote::WalletTransaction convert(const cryptonote::WalletLegacyTransaction&
   mtx.creationTime = tx.sentTime;
   mtx.unlockTime = tx.unlockTime;
   mtx.extra = tx.extra;
+  mtx.paymentId = getPaymentIdFromExtra(mtx.extra);
   mtx.isBase = tx.isCoinbase;
 
   return mtx;
@@ -321,11 +360,138 @@ cryptonote::WalletTransfer convert(const cryptonote::WalletLegacyTransfer& tr) {
   return mtr;
 }
 
+cryptonote::WalletTransaction convert(const WalletTransactionDto& dto) {
+  cryptonote::WalletTransaction tx;
+
+  tx.state = dto.state;
+  tx.timestamp = dto.timestamp;
+  tx.blockHeight = dto.blockHeight;
+  tx.hash = dto.hash;
+  tx.totalAmount = dto.totalAmount;
+  tx.fee = dto.fee;
+  tx.creationTime = dto.creationTime;
+  tx.unlockTime = dto.unlockTime;
+  tx.extra = dto.extra;
+  tx.paymentId = getPaymentIdFromExtra(tx.extra);
+  tx.isBase = false;
+
+  return tx;
+}
+
+cryptonote::WalletTransfer convert(const WalletTransferDto& dto) {
+  cryptonote::WalletTransfer tr;
+
+  tr.address = dto.address;
+  tr.amount = dto.amount;
+  tr.type = static_cast<cryptonote::WalletTransferType>(dto.type);
+
+  return tr;
+}
+
+hash_t checksum(const std::string& cipher) {
+  hash_t hash;
+  cn_fast_hash(cipher.data(), cipher.size(), reinterpret_cast<char*>(&hash));
+  return hash;
+}
+
+bool loadChangesRecord(Reader& source, const chacha_key_t& key, uint32_t version, std::vector<WalletTransactionChangeDto>& changes) {
+  cryptonote::CryptoContext cryptoContext;
+  cryptoContext.key = key;
+
+  std::string cipher;
+  hash_t expectedChecksum;
+
+  try {
+    source.read(static_cast<void *>(&cryptoContext.iv.data), sizeof(cryptoContext.iv.data));
+    source >> cipher >> expectedChecksum;
+  } catch (std::exception&) {
+    return false;
+  }
+
+  if (checksum(cipher) != expectedChecksum) {
+    return false;
+  }
+
+  std::string plain = decrypt(cipher, cryptoContext);
+
+  const char * b = static_cast<const char *>(plain.data());
+  membuf mem((char *)(b), (char *)(b + plain.size()));
+  std::istream istream(&mem);
+  Reader decrypted(istream);
+
+  uint64_t count = 0;
+  decrypted >> count;
+
+  for (uint64_t i = 0; i < count; ++i) {
+    WalletTransactionChangeDto dto(version);
+    decrypted >> dto;
+    changes.push_back(std::move(dto));
+  }
+
+  return true;
+}
+
+void applyChanges(const std::vector<WalletTransactionChangeDto>& changes, cryptonote::WalletTransactions& walletTransactions,
+  cryptonote::WalletTransfers& walletTransfers) {
+  auto& transactions = walletTransactions.get<cryptonote::RandomAccessIndex>();
+  auto& hashIndex = walletTransactions.get<cryptonote::TransactionIndex>();
+  std::unordered_map<size_t, const std::vector<WalletTransferDto>*> changedTransfers;
+
+  for (const auto& change: changes) {
+    const WalletTransactionDto& dto = change.transaction;
+
+    size_t transactionId;
+    auto it = hashIndex.find(dto.hash);
+    if (it != hashIndex.end()) {
+      transactionId = std::distance(transactions.begin(), walletTransactions.project<cryptonote::RandomAccessIndex>(it));
+      hashIndex.modify(it, [&dto](cryptonote::WalletTransaction& tx) {
+        bool isBase = tx.isBase;
+        tx = convert(dto);
+        tx.isBase = isBase;
+      });
+    } else if (dto.state == cryptonote::WalletTransactionState::DELETED) {
+      continue;
+    } else {
+      transactions.push_back(convert(dto));
+      transactionId = transactions.size() - 1;
+    }
+
+    changedTransfers[transactionId] = &change.transfers;
+  }
+
+  if (changedTransfers.empty()) {
+    return;
+  }
+
+  // Transfers are kept sorted by transaction id, so they are rebuilt in one pass
+  cryptonote::WalletTransfers transfers;
+  transfers.reserve(walletTransfers.size());
+
+  auto transferIt = walletTransfers.begin();
+  for (size_t transactionId = 0; transactionId < transactions.size(); ++transactionId) {
+    auto changedIt = changedTransfers.find(transactionId);
+
+    for (; transferIt != walletTransfers.end() && transferIt->first == transactionId; ++transferIt) {
+      if (changedIt == changedTransfers.end()) {
+        transfers.push_back(*transferIt);
+      }
+    }
+
+    if (changedIt != changedTransfers.end()) {
+      for (const auto& dto: *changedIt->second) {
+        transfers.emplace_back(transactionId, convert(dto));
+      }
+    }
+  }
+
+  walletTransfers = std::move(transfers);
+}
+
 }
 
 namespace cryptonote {
 
-const uint32_t WalletSerializer::SERIALIZATION_VERSION = 5;
+const uint32_t WalletSerializer::SERIALIZATION_VERSION = 6;
 
 void CryptoContext::incIv() {
   uint64_t * i = reinterpret_cast<uint64_t *>(&iv.data[0]);
@@ -360,8 +526,8 @@ WalletSerializer::WalletSerializer(
   uncommitedTransactions(uncommitedTransactions)
 { }
 
-void WalletSerializer::save(const std::string& password, Writer& o, bool saveDetails, bool saveCache) {
-  CryptoContext cryptoContext = generateCryptoContext(password);
+void WalletSerializer::save(const chacha_key_t& key, Writer& o, bool saveDetails, bool saveCache) {
+  CryptoContext cryptoContext = generateCryptoContext(key);
 
   saveVersion(o);
   saveIv(o, cryptoContext.iv);
@@ -383,11 +549,44 @@ void WalletSerializer::save(const std::string& password, Writer& o, bool saveDet
   }
 }
 
-CryptoContext WalletSerializer::generateCryptoContext(const std::string& password) {
-  CryptoContext context;
+void WalletSerializer::saveChanges(const chacha_key_t& key, Writer& destination, const std::vector<size_t>& changedTransactions) {
+  CryptoContext cryptoContext = generateCryptoContext(key);
+  auto& transactions = m_transactions.get<RandomAccessIndex>();
+
+  std::stringstream stream;
+  Writer plain(stream);
 
-  generate_chacha_key(password, context.key);
+  uint64_t count = changedTransactions.size();
+  plain << count;
 
+  for (size_t transactionId: changedTransactions) {
+    assert(transactionId < transactions.size());
+
+    WalletTransactionChangeDto dto(SERIALIZATION_VERSION);
+    dto.transaction = WalletTransactionDto(transactions[transactionId]);
+
+    auto it = std::lower_bound(m_transfers.begin(), m_transfers.end(), transactionId, [](const TransactionTransferPair& pair, size_t id) {
+      return pair.first < id;
+    });
+
+    for (; it != m_transfers.end() && it->first == transactionId; ++it) {
+      dto.transfers.emplace_back(it->second, SERIALIZATION_VERSION);
+    }
+
+    plain << dto;
+  }
+
+  stream.flush();
+  std::string cipher = encrypt(stream.str(), cryptoContext);
+
+  saveIv(destination, cryptoContext.iv);
+  destination << cipher << checksum(cipher);
+}
+
+CryptoContext WalletSerializer::generateCryptoContext(const chacha_key_t& key) {
+  CryptoContext context;
+
+  context.key = key;
   context.iv = rand<chacha_iv_t>();
 
   return context;
@@ -527,27 +726,27 @@ void WalletSerializer::saveTransfers(Writer& destination, CryptoContext& cryptoC
   }
 }
 
-void WalletSerializer::load(const std::string& password, Reader& i) {
+void WalletSerializer::load(const chacha_key_t& key, Reader& i) {
 
   uint32_t version = loadVersion(i);
 
   if (version > SERIALIZATION_VERSION) {
     throw std::system_error(make_error_code(error::WRONG_VERSION));
   } else if (version != 1) {
-    loadWallet(i, password, version);
+    loadWallet(i, key, version);
   } else {
-    loadWalletV1(i, password);
+    loadWalletV1(i, key);
   }
 }
 
-void WalletSerializer::loadWallet(Reader& source, const std::string& password, uint32_t version) {
+void WalletSerializer::loadWallet(Reader& source, const chacha_key_t& key, uint32_t version) {
   cryptonote::CryptoContext cryptoContext;
 
   bool details = false;
   bool cache = false;
 
   loadIv(source, cryptoContext.iv);
-  generateKey(password, cryptoContext.key);
+  cryptoContext.key = key;
 
   loadKeys(source, cryptoContext);
   checkKeys();
@@ -591,16 +790,36 @@ void WalletSerializer::loadWallet(Reader& source, const std::string& password, u
     resetCachedBalance();
   }
 
+  if (version >= 6) {
+    loadChanges(source, cryptoContext.key, version);
+  }
+
   if (details && cache) {
     updateTransactionsBaseStatus();
   }
 }
 
-void WalletSerializer::loadWalletV1(Reader& i, const std::string& password) {
+// Changes records follow the wallet snapshot until the end of the stream. Each one holds the latest state of the
+// transactions changed since the previous save, so they are applied in order. They are laid out as the version
+// in the wallet header says
+void WalletSerializer::loadChanges(Reader& source, const chacha_key_t& key, uint32_t version) {
+  std::vector<WalletTransactionChangeDto> changes;
+
+  while (!source.endOfStream()) {
+    if (!loadChangesRecord(source, key, version, changes)) {
+      // Record was cut short by an interrupted save, everything before it is consistent
+      break;
+    }
+  }
+
+  applyChanges(changes, m_transactions, m_transfers);
+}
+
+void WalletSerializer::loadWalletV1(Reader& i, const chacha_key_t& key) {
   cryptonote::CryptoContext cryptoContext;
 
   i >> cryptoContext.iv;
-  generateKey(password, cryptoContext.key);
+  cryptoContext.key = key;
 
   std::string cipher;
   i >> cipher;
@@ -660,10 +879,6 @@ void WalletSerializer::loadIv(Reader& i, chacha_iv_t& iv) {
   i.read(static_cast<void *>(&iv.data), sizeof(iv.data));
 }
 
-void WalletSerializer::generateKey(const std::string& password, chacha_key_t& key) {
-  generate_chacha_key(password, key);
-}
-
 void WalletSerializer::loadKeys(Reader& source, CryptoContext& cryptoContext) {
   loadPublicKey(source, cryptoContext);
   loadSecretKey(source, cryptoContext);
@@ -892,19 +1107,7 @@ void WalletSerializer::loadTransactions(Reader& source, CryptoContext& cryptoCon
     deserializeEncrypted(dto, "", cryptoContext, source);
     cryptoContext.incIv();
 
-    WalletTransaction tx;
-    tx.state = dto.state;
-    tx.timestamp = dto.timestamp;
-    tx.blockHeight = dto.blockHeight;
-    tx.hash = dto.hash;
-    tx.totalAmount = dto.totalAmount;
-    tx.fee = dto.fee;
-    tx.creationTime = dto.creationTime;
-    tx.unlockTime = dto.unlockTime;
-    tx.extra = dto.extra;
-    tx.isBase = false;
-
-    m_transactions.get<RandomAccessIndex>().push_back(std::move(tx));
+    m_transactions.get<RandomAccessIndex>().push_back(convert(dto));
   }
 }
 
@@ -38,16 +38,19 @@ public:
     UncommitedTransactions& uncommitedTransactions
   );
   
-  void save(const std::string& password, Writer& destination, bool saveDetails, bool saveCache);
-  void load(const std::string& password, Reader& source);
+  // key is derived from the wallet password with generate_chacha_key
+  void save(const chacha_key_t& key, Writer& destination, bool saveDetails, bool saveCache);
+  // Appends a record with the given transactions and their transfers to a saved wallet
+  void saveChanges(const chacha_key_t& key, Writer& destination, const std::vector<size_t>& changedTransactions);
+  void load(const chacha_key_t& key, Reader& source);
 
 private:
   static const uint32_t SERIALIZATION_VERSION;
 
-  void loadWallet(Reader& source, const std::string& password, uint32_t version);
-  void loadWalletV1(Reader& source, const std::string& password);
+  void loadWallet(Reader& source, const chacha_key_t& key, uint32_t version);
+  void loadWalletV1(Reader& source, const chacha_key_t& key);
 
-  CryptoContext generateCryptoContext(const std::string& password);
+  CryptoContext generateCryptoContext(const chacha_key_t& key);
 
   void saveVersion(Writer& destination);
   void saveIv(Writer& destination, chacha_iv_t& iv);
@@ -65,7 +68,6 @@ private:
 
   uint32_t loadVersion(Reader& source);
   void loadIv(Reader& source, chacha_iv_t& iv);
-  void generateKey(const std::string& password, chacha_key_t& key);
   void loadKeys(Reader& source, CryptoContext& cryptoContext);
   void loadPublicKey(Reader& source, CryptoContext& cryptoContext);
   void loadSecretKey(Reader& source, CryptoContext& cryptoContext);
@@ -81,6 +83,7 @@ private:
   void loadUncommitedTransactions(Reader& source, CryptoContext& cryptoContext);
   void loadTransactions(Reader& source, CryptoContext& cryptoContext);
   void loadTransfers(Reader& source, CryptoContext& cryptoContext, uint32_t version);
+  void loadChanges(Reader& source, const chacha_key_t& key, uint32_t version);
 
   void loadWalletV1Keys(Reader &i);
   void loadWalletV1Details(Reader &i);
@@ -168,3 +168,46 @@ TEST_F(BlockTest, create)
   // ASSERT_TRUE(boost::filesystem::exists(c.blocksFileName()));
 
 } // namespace
+
+TEST_F(BlockTest, hashingBlobGivesLongHash)
+{
+  LoggerManager logManager;
+  Currency c = cryptonote::CurrencyBuilder("./data", config::testnet::data, logManager).currency();
+  block_t b = c.genesisBlock();
+
+  BlockHashingBlob blob;
+  ASSERT_TRUE(blob.init(b));
+  for (uint32_t nonce : {0u, 1u, 70u, 0x12345678u, 0xffffffffu})
+  {
+    b.nonce = nonce;
+    blob.setNonce(nonce);
+
+    hash_t expected;
+    hash_t h;
+    ASSERT_TRUE(Block::getLongHash(b, expected));
+    blob.getLongHash(h);
+    ASSERT_EQ(expected, h);
+  }
+}
+
+TEST_F(BlockTest, hashingBlobGivesLongHashesSideBySide)
+{
+  LoggerManager logManager;
+  Currency c = cryptonote::CurrencyBuilder("./data", config::testnet::data, logManager).currency();
+  block_t b = c.genesisBlock();
+
+  BlockHashingBlob blob;
+  ASSERT_TRUE(blob.init(b));
+  for (size_t count = 1; count <= SLOW_HASH_MULTI_MAX; ++count)
+  {
+    hash_t hashes[SLOW_HASH_MULTI_MAX];
+    blob.getLongHashes(100, 3, count, hashes);
+    for (size_t i = 0; i < count; ++i)
+    {
+      b.nonce = static_cast<uint32_t>(100 + 3 * i);
+      hash_t expected;
+      ASSERT_TRUE(Block::getLongHash(b, expected));
+      ASSERT_EQ(expected, hashes[i]);
+    }
+  }
+}
@@ -12,6 +12,7 @@
 #include "ChainSwitch1.h"
 #include "Chaingen001.h"
 #include "DoubleSpend.h"
+#include "IncomingTransactions.h"
 #include "IntegerOverflow.h"
 #include "RingSignature.h"
 #include "TransactionTests.h"
@@ -125,6 +126,7 @@ int main(int argc, char* argv[])
     GENERATE_AND_PLAY(gen_tx_txout_to_key_has_invalid_key);
     GENERATE_AND_PLAY(gen_tx_output_with_zero_amount);
     GENERATE_AND_PLAY(gen_tx_signatures_are_invalid);
+    GENERATE_AND_PLAY(gen_incoming_transactions_batch);
     GENERATE_AND_PLAY_EX(GenerateTransactionWithZeroFee(false));
     GENERATE_AND_PLAY_EX(GenerateTransactionWithZeroFee(true));
 
@@ -0,0 +1,104 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "IncomingTransactions.h"
+
+#include "cryptonote/structures/array.hpp"
+
+using namespace cryptonote;
+
+gen_incoming_transactions_batch::gen_incoming_transactions_batch()
+{
+  REGISTER_CALLBACK_METHOD(gen_incoming_transactions_batch, check_bad_ring_signature_rejected);
+  REGISTER_CALLBACK_METHOD(gen_incoming_transactions_batch, check_duplicates_added_once);
+}
+
+bool gen_incoming_transactions_batch::generate(std::vector<test_event_entry>& events) const
+{
+  uint64_t ts_start = 1338224400;
+
+  GENERATE_ACCOUNT(miner_account);
+
+  //                                                                    events
+  MAKE_GENESIS_BLOCK(events, blk_0, miner_account, ts_start);           //  0
+  events.push_back(miner_account);                                      //  1
+  MAKE_ACCOUNT(events, bob_account);                                    //  2
+  REWIND_BLOCKS(events, blk_0r, blk_0, miner_account);                  // <N blocks>
+  DO_CALLBACK(events, "check_bad_ring_signature_rejected");             //  3 + N
+  DO_CALLBACK(events, "check_duplicates_added_once");                   //  4 + N
+
+  return true;
+}
+
+// The same transfer from the miner to bob every time, built against the chain as it is before the first callback
+bool gen_incoming_transactions_batch::makeTransaction(size_t ev_index, const std::vector<test_event_entry>& events, transaction_t& tx)
+{
+  size_t chainEnd = ev_index;
+  while (chainEnd > 0 && events[chainEnd - 1].type() != typeid(block_t)) {
+    --chainEnd;
+  }
+
+  if (chainEnd == 0) {
+    return false;
+  }
+
+  std::vector<test_event_entry> chain(events.begin(), events.begin() + chainEnd);
+  const Account& miner = boost::get<Account>(events[1]);
+  const Account& bob = boost::get<Account>(events[2]);
+  return construct_tx_to_key(m_logger, chain, tx, boost::get<block_t>(events[chainEnd - 1]), miner, bob, MK_COINS(1), m_currency.minimumFee(), 0);
+}
+
+bool gen_incoming_transactions_batch::check_bad_ring_signature_rejected(cryptonote::core& c, size_t ev_index, const std::vector<test_event_entry>& events)
+{
+  DEFINE_TESTS_ERROR_CONTEXT("gen_incoming_transactions_batch::check_bad_ring_signature_rejected");
+
+  transaction_t tx;
+  CHECK_TEST_CONDITION(makeTransaction(ev_index, events, tx));
+  CHECK_TEST_CONDITION(!tx.signatures.empty() && !tx.signatures[0].empty());
+  tx.signatures[0][0].data[0] ^= 1;
+
+  size_t poolSize = c.get_pool_transactions_count();
+  std::vector<tx_verification_context_t> tvcs;
+  c.handleIncomingTransactions({ BinaryArray::to(tx) }, tvcs);
+
+  CHECK_EQ(1, tvcs.size());
+  CHECK_TEST_CONDITION(tvcs[0].m_verifivation_failed);
+  CHECK_TEST_CONDITION(!tvcs[0].m_added_to_pool);
+  CHECK_TEST_CONDITION(!tvcs[0].m_should_be_relayed);
+  CHECK_EQ(poolSize, c.get_pool_transactions_count());
+
+  return true;
+}
+
+bool gen_incoming_transactions_batch::check_duplicates_added_once(cryptonote::core& c, size_t ev_index, const std::vector<test_event_entry>& events)
+{
+  DEFINE_TESTS_ERROR_CONTEXT("gen_incoming_transactions_batch::check_duplicates_added_once");
+
+  // the same transfer as the one rejected above, with its signature intact
+  transaction_t tx;
+  CHECK_TEST_CONDITION(makeTransaction(ev_index, events, tx));
+  binary_array_t blob = BinaryArray::to(tx);
+
+  size_t poolSize = c.get_pool_transactions_count();
+  std::vector<tx_verification_context_t> tvcs;
+  c.handleIncomingTransactions({ blob, blob }, tvcs);
+
+  CHECK_EQ(2, tvcs.size());
+  CHECK_TEST_CONDITION(!tvcs[0].m_verifivation_failed);
+  CHECK_TEST_CONDITION(tvcs[0].m_added_to_pool);
+  CHECK_TEST_CONDITION(tvcs[0].m_should_be_relayed);
+  CHECK_TEST_CONDITION(!tvcs[1].m_verifivation_failed);
+  CHECK_TEST_CONDITION(!tvcs[1].m_added_to_pool);
+  CHECK_TEST_CONDITION(!tvcs[1].m_should_be_relayed);
+  CHECK_EQ(poolSize + 1, c.get_pool_transactions_count());
+
+  // a later batch finds it in the pool, it is not added or relayed again
+  c.handleIncomingTransactions({ blob }, tvcs);
+  CHECK_EQ(1, tvcs.size());
+  CHECK_TEST_CONDITION(!tvcs[0].m_verifivation_failed);
+  CHECK_TEST_CONDITION(!tvcs[0].m_should_be_relayed);
+  CHECK_EQ(poolSize + 1, c.get_pool_transactions_count());
+
+  return true;
+}
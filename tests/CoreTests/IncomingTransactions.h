@@ -0,0 +1,24 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once 
+
+#include "Chaingen.h"
+
+/************************************************************************/
+/* Relayed transactions handed to core::handleIncomingTransactions      */
+/************************************************************************/
+class gen_incoming_transactions_batch : public test_chain_unit_base
+{
+public:
+  gen_incoming_transactions_batch();
+
+  bool generate(std::vector<test_event_entry>& events) const;
+
+  bool check_bad_ring_signature_rejected(cryptonote::core& c, size_t ev_index, const std::vector<test_event_entry>& events);
+  bool check_duplicates_added_once(cryptonote::core& c, size_t ev_index, const std::vector<test_event_entry>& events);
+
+private:
+  bool makeTransaction(size_t ev_index, const std::vector<test_event_entry>& events, cryptonote::transaction_t& tx);
+};
@@ -0,0 +1,75 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "cryptonote/core/account.h"
+#include "cryptonote/core/BlockTemplateCache.h"
+#include "cryptonote/core/CryptoNoteFormatUtils.h"
+
+#include <logging/LoggerGroup.h>
+
+// Coinbase side of get_block_template for a pool server polling with address_count payout addresses.
+// Without the cache every call sizes a new coinbase from scratch, as every template used to; with it
+// a repeated address is a lookup and a new one reuses the coinbase size already found for the tip.
+template<bool cached, size_t address_count>
+class test_block_template
+{
+public:
+  static const size_t loop_count = 10000;
+  static const size_t transaction_count = 100;
+
+  test_block_template() : m_currency(cryptonote::CurrencyBuilder(os::appdata::path(), config::testnet::data, m_nullLog).currency()), m_next(0)
+  {
+  }
+
+  bool init()
+  {
+    for (size_t i = 0; i < address_count; ++i) {
+      cryptonote::Account account;
+      account.generate();
+      m_addresses.push_back(account.getAccountKeys().address);
+    }
+
+    m_base.previousBlockHash = hash_t();
+    m_base.poolRevision = 1;
+    m_base.height = 100000;
+    m_base.difficulty = 1000;
+    m_base.majorVersion = 1;
+    m_base.minorVersion = 0;
+    m_base.medianSize = m_currency.blockGrantedFullRewardZone();
+    m_base.alreadyGeneratedCoins = 0;
+    m_base.transactionHashes.resize(transaction_count);
+    m_base.transactionsSize = transaction_count * 400;
+    m_base.fee = transaction_count * m_currency.minimumFee();
+    m_base.createdAt = time(nullptr);
+
+    m_cache.reset(new cryptonote::BlockTemplateCache(m_currency, m_nullLog));
+    m_cache->setBase(cryptonote::BlockTemplateCache::Base(m_base));
+    return true;
+  }
+
+  bool test()
+  {
+    if (!cached) {
+      m_cache->setBase(cryptonote::BlockTemplateCache::Base(m_base));
+    }
+
+    cryptonote::block_t b;
+    const cryptonote::account_public_address_t& address = m_addresses[m_next++ % address_count];
+    return m_cache->makeBlock(b, address, m_extraNonce, m_base.createdAt);
+  }
+
+private:
+  Logging::LoggerGroup m_nullLog;
+  cryptonote::Currency m_currency;
+  std::unique_ptr<cryptonote::BlockTemplateCache> m_cache;
+  cryptonote::BlockTemplateCache::Base m_base;
+  std::vector<cryptonote::account_public_address_t> m_addresses;
+  binary_array_t m_extraNonce;
+  size_t m_next;
+};
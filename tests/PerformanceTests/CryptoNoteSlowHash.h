@@ -4,10 +4,15 @@
 
 #pragma once
 
+#include <array>
+#include <iostream>
+
 #include "common/hex.h"
 #include "cryptonote/crypto/crypto.h"
 #include "cryptonote/core/key.h"
 
+#include "PerformanceTests.h"
+
 class test_cn_slow_hash {
 public:
   static const size_t loop_count = 10;
@@ -42,3 +47,62 @@ private:
   data_t m_data;
   hash_t m_expected_hash;
 };
+
+// cn_slow_hash_multi of count inputs as long as a block hashing blob. init checks it against
+// cn_slow_hash and prints the hashes per second of both, test() measures the multi hash alone.
+template <size_t count>
+class test_cn_slow_hash_multi {
+public:
+  static const size_t loop_count = 10;
+
+  bool init() {
+    for (size_t i = 0; i < count; ++i) {
+      for (size_t j = 0; j < m_inputs[i].size(); ++j) {
+        m_inputs[i][j] = static_cast<uint8_t>(j * 7 + i);
+      }
+
+      m_data[i] = m_inputs[i].data();
+      m_output[i] = reinterpret_cast<char *>(&m_hashes[i]);
+    }
+
+    const size_t rounds = 4;
+    performance_timer timer;
+    timer.start();
+    for (size_t round = 0; round < rounds; ++round) {
+      for (size_t i = 0; i < count; ++i) {
+        crypto::cn_slow_hash(m_inputs[i].data(), m_inputs[i].size(), reinterpret_cast<char *>(&m_expected[i]), 0, 0);
+      }
+    }
+
+    int singleElapsed = timer.elapsed_ms();
+
+    timer.start();
+    for (size_t round = 0; round < rounds; ++round) {
+      if (!test()) {
+        return false;
+      }
+    }
+
+    int multiElapsed = timer.elapsed_ms();
+
+    std::cout << "cn_slow_hash, 1 at a time:       " << hashesPerSecond(rounds * count, singleElapsed) << " hashes/sec\n";
+    std::cout << "cn_slow_hash_multi, " << count << " at a time: " << hashesPerSecond(rounds * count, multiElapsed) << " hashes/sec\n";
+    return true;
+  }
+
+  bool test() {
+    crypto::cn_slow_hash_multi(m_data.data(), m_inputs[0].size(), count, m_output.data(), 0);
+    return m_hashes == m_expected;
+  }
+
+private:
+  static uint64_t hashesPerSecond(size_t hashes, int elapsed) {
+    return 0 < elapsed ? static_cast<uint64_t>(hashes) * 1000 / elapsed : 0;
+  }
+
+  std::array<std::array<uint8_t, 76>, count> m_inputs;
+  std::array<const void *, count> m_data;
+  std::array<char *, count> m_output;
+  std::array<hash_t, count> m_hashes;
+  std::array<hash_t, count> m_expected;
+};
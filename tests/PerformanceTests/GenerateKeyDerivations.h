@@ -0,0 +1,44 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <vector>
+
+#include "cryptonote/crypto/crypto.h"
+#include "cryptonote/core/key.h"
+
+#include "SingleTransactionTestBase.h"
+
+template<size_t a_batch_size>
+class test_generate_key_derivations : public single_tx_test_base
+{
+  static_assert(0 < a_batch_size, "batch_size must be greater than 0");
+
+public:
+  static const size_t loop_count = 1000 / a_batch_size;
+  static const size_t batch_size = a_batch_size;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    m_tx_pub_keys.assign(batch_size, m_tx_pub_key);
+    m_derivations.resize(batch_size);
+    m_results.resize(batch_size);
+    return true;
+  }
+
+  bool test()
+  {
+    return batch_size == generate_key_derivations((const uint8_t*)m_tx_pub_keys.data(), batch_size,
+      (const uint8_t*)&(m_bob.getAccountKeys().viewSecretKey), (uint8_t*)m_derivations.data(), m_results.data());
+  }
+
+private:
+  std::vector<public_key_t> m_tx_pub_keys;
+  std::vector<key_derivation_t> m_derivations;
+  std::vector<int> m_results;
+};
@@ -0,0 +1,169 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "common/ShuffleGenerator.h"
+#include "cryptonote/core/blockchain/indexing/random_output.h"
+#include "cryptonote/structures/array.hpp"
+#include "rpc/CoreRpcServerCommandsDefinitions.h"
+
+// Daemon side of /getrandom_outs.bin for amount_count amounts and mixin outputs each, the way
+// Blockchain::getRandomOutsByAmount answers it. With indexed the outputs are drawn from the random
+// output index; without it every candidate's transaction is read and parsed from the stored blob
+// first, as the chain did before the index, when the block isn't cached.
+template<bool indexed, size_t amount_count, size_t mixin>
+class test_get_random_outs
+{
+public:
+  static const size_t loop_count = indexed ? 10000 : 1000;
+  static const size_t transaction_count = 10000;
+  static const size_t transactions_per_block = 10;
+  static const uint32_t unlock_window = 10;
+
+  typedef cryptonote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS command;
+
+  bool init()
+  {
+    // Every transaction has an output of each amount, every tenth one stays locked
+    for (size_t i = 0; i < transaction_count; ++i) {
+      cryptonote::transaction_t tx;
+      tx.version = 1;
+      tx.unlockTime = i % 10 == 0 ? 1 : 0;
+      for (uint64_t amount = 1; amount <= amount_count; ++amount) {
+        cryptonote::transaction_output_t output;
+        output.amount = amount;
+        output.target = cryptonote::key_output_t{ crypto::rand<public_key_t>() };
+        tx.outputs.push_back(output);
+      }
+
+      transaction_index_t index;
+      index.block = static_cast<uint32_t>(i / transactions_per_block);
+      index.transaction = static_cast<uint16_t>(i % transactions_per_block);
+      m_transactions.push_back(cryptonote::BinaryArray::to(tx));
+
+      for (uint16_t out = 0; out < tx.outputs.size(); ++out) {
+        m_outputs[tx.outputs[out].amount].push_back(std::make_pair(index, out));
+      }
+    }
+
+    m_height = static_cast<uint32_t>(transaction_count / transactions_per_block);
+    for (uint64_t amount = 1; amount <= amount_count; ++amount) {
+      m_request.amounts.push_back(amount);
+      if (indexed) {
+        syncRandomOutputIndex(amount);
+      }
+    }
+
+    m_request.outs_count = mixin;
+    return true;
+  }
+
+  bool test()
+  {
+    command::response res;
+    if (!(indexed ? getFromIndex(res) : getFromTransactions(res))) {
+      return false;
+    }
+
+    for (const auto& outs : res.outs) {
+      if (outs.outs.size() != mixin) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+private:
+  static bool isUnlocked(uint64_t unlockTime)
+  {
+    return unlockTime == 0;
+  }
+
+  bool readTransaction(const transaction_index_t& index, cryptonote::transaction_t& tx) const
+  {
+    return cryptonote::BinaryArray::from(tx, m_transactions[index.block * transactions_per_block + index.transaction]);
+  }
+
+  void syncRandomOutputIndex(uint64_t amount)
+  {
+    const auto& amountOuts = m_outputs.at(amount);
+    for (size_t i = m_index.size(amount); i < amountOuts.size(); ++i) {
+      cryptonote::transaction_t tx;
+      readTransaction(amountOuts[i].first, tx);
+      const auto& output = tx.outputs[amountOuts[i].second];
+      m_index.push(amount, cryptonote::random_output_entry_t{ boost::get<cryptonote::key_output_t>(output.target).key, tx.unlockTime, amountOuts[i].first.block });
+    }
+  }
+
+  bool getFromIndex(command::response& res)
+  {
+    for (uint64_t amount : m_request.amounts) {
+      command::outs_for_amount& resultOuts = *res.outs.insert(res.outs.end(), command::outs_for_amount());
+      resultOuts.amount = amount;
+
+      syncRandomOutputIndex(amount);
+      size_t limit = m_index.countUpTo(amount, m_height - unlock_window);
+      for (uint32_t i : m_index.pickRandom(amount, limit, m_request.outs_count, isUnlocked)) {
+        command::out_entry& entry = *resultOuts.outs.insert(resultOuts.outs.end(), command::out_entry());
+        entry.global_amount_index = i;
+        entry.out_key = m_index.get(amount, i).key;
+      }
+    }
+
+    return true;
+  }
+
+  bool getFromTransactions(command::response& res)
+  {
+    for (uint64_t amount : m_request.amounts) {
+      command::outs_for_amount& resultOuts = *res.outs.insert(res.outs.end(), command::outs_for_amount());
+      resultOuts.amount = amount;
+
+      const auto& amountOuts = m_outputs.at(amount);
+      size_t limit = 0;
+      for (size_t i = amountOuts.size(); i > 0; --i) {
+        if (amountOuts[i - 1].first.block + unlock_window <= m_height) {
+          limit = i;
+          break;
+        }
+      }
+
+      if (limit == 0) {
+        continue;
+      }
+
+      ShuffleGenerator<size_t, crypto::random_engine<size_t>> generator(limit);
+      for (size_t j = 0; j < limit && resultOuts.outs.size() < m_request.outs_count; ++j) {
+        size_t i = generator();
+        cryptonote::transaction_t tx;
+        if (!readTransaction(amountOuts[i].first, tx)) {
+          return false;
+        }
+
+        const auto& output = tx.outputs[amountOuts[i].second];
+        if (output.target.type() != typeid(cryptonote::key_output_t) || !isUnlocked(tx.unlockTime)) {
+          continue;
+        }
+
+        command::out_entry& entry = *resultOuts.outs.insert(resultOuts.outs.end(), command::out_entry());
+        entry.global_amount_index = static_cast<uint32_t>(i);
+        entry.out_key = boost::get<cryptonote::key_output_t>(output.target).key;
+      }
+    }
+
+    return true;
+  }
+
+  std::vector<binary_array_t> m_transactions;
+  std::map<uint64_t, std::vector<std::pair<transaction_index_t, uint16_t>>> m_outputs;
+  cryptonote::RandomOutputIndex m_index;
+  command::request m_request;
+  uint32_t m_height;
+};
@@ -75,6 +75,11 @@ public:
     return m_elapsed / T::loop_count;
   }
 
+  uint64_t calls_per_second() const
+  {
+    return 0 < m_elapsed ? static_cast<uint64_t>(T::loop_count) * 1000 / m_elapsed : 0;
+  }
+
 private:
   /**
    * Warm up processor core, enabling turbo boost, etc.
@@ -104,7 +109,8 @@ void run_test(const char* test_name)
     std::cout << test_name << " - OK:\n";
     std::cout << "  loop count:    " << T::loop_count << '\n';
     std::cout << "  elapsed:       " << runner.elapsed_time() << " ms\n";
-    std::cout << "  time per call: " << runner.time_per_call() << " ms/call\n" << std::endl;
+    std::cout << "  time per call: " << runner.time_per_call() << " ms/call\n";
+    std::cout << "  calls per sec: " << runner.calls_per_second() << "\n" << std::endl;
   }
   else
   {
@@ -113,6 +119,7 @@ void run_test(const char* test_name)
 }
 
 #define QUOTEME(x) #x
-#define TEST_PERFORMANCE0(test_class)         run_test< test_class >(QUOTEME(test_class))
-#define TEST_PERFORMANCE1(test_class, a0)     run_test< test_class<a0> >(QUOTEME(test_class<a0>))
-#define TEST_PERFORMANCE2(test_class, a0, a1) run_test< test_class<a0, a1> >(QUOTEME(test_class) "<" QUOTEME(a0) ", " QUOTEME(a1) ">")
+#define TEST_PERFORMANCE0(test_class)             run_test< test_class >(QUOTEME(test_class))
+#define TEST_PERFORMANCE1(test_class, a0)         run_test< test_class<a0> >(QUOTEME(test_class<a0>))
+#define TEST_PERFORMANCE2(test_class, a0, a1)     run_test< test_class<a0, a1> >(QUOTEME(test_class) "<" QUOTEME(a0) ", " QUOTEME(a1) ">")
+#define TEST_PERFORMANCE3(test_class, a0, a1, a2) run_test< test_class<a0, a1, a2> >(QUOTEME(test_class) "<" QUOTEME(a0) ", " QUOTEME(a1) ", " QUOTEME(a2) ">")
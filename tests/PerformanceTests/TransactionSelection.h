@@ -0,0 +1,103 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "cryptonote/core/currency.h"
+#include "cryptonote/core/TransactionSelector.h"
+
+#include <logging/LoggerGroup.h>
+
+// Picks a block template out of a synthetic pool of pool_size transactions, either the way
+// fill_block_template used to (everything that fits, best fee per byte first) or with
+// TransactionSelector. The pool is the same for both and from run to run; init prints what the
+// block earns so both can be compared, test() measures selection time.
+template<bool revenue_aware, size_t pool_size>
+class test_transaction_selection
+{
+public:
+  static const size_t loop_count = 1000;
+
+  test_transaction_selection() : m_currency(cryptonote::CurrencyBuilder(os::appdata::path(), config::testnet::data, m_nullLog).currency()),
+                                 m_selector(m_currency, m_currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), m_currency.moneySupply() / 2)
+  {
+  }
+
+  bool init()
+  {
+    std::mt19937 generator(static_cast<std::mt19937::result_type>(pool_size));
+    for (size_t i = 0; i < pool_size; ++i)
+    {
+      // mostly small transactions, a few big ones, fees from the minimum to a thousand times it
+      size_t blobSize = generator() % 10 == 0 ? 5000 + generator() % 10000 : 300 + generator() % 2000;
+      uint64_t fee = m_currency.minimumFee() * (1 + generator() % 1000);
+      m_candidates.push_back({blobSize, fee});
+    }
+
+    std::sort(m_candidates.begin(), m_candidates.end(), [](const cryptonote::TransactionSelector::Candidate &lhs, const cryptonote::TransactionSelector::Candidate &rhs) {
+      return lhs.fee * rhs.blobSize > rhs.fee * lhs.blobSize;
+    });
+
+    size_t totalSize;
+    uint64_t fee;
+    if (!test(totalSize, fee))
+    {
+      return false;
+    }
+
+    std::cout << (revenue_aware ? "Revenue aware" : "Greedy") << " selection out of " << pool_size << " transactions:\n";
+    std::cout << "  block size:    " << totalSize << '\n';
+    std::cout << "  block fee:     " << m_currency.formatAmount(fee) << '\n';
+    std::cout << "  block revenue: " << m_currency.formatAmount(m_selector.getRevenue(totalSize, fee)) << '\n';
+    return true;
+  }
+
+  bool test()
+  {
+    size_t totalSize;
+    uint64_t fee;
+    return test(totalSize, fee);
+  }
+
+private:
+  bool test(size_t &totalSize, uint64_t &fee)
+  {
+    totalSize = 0;
+    fee = 0;
+    m_added.clear();
+
+    if (revenue_aware)
+    {
+      m_selector.select(m_candidates, [this](size_t index) {
+        m_added.push_back(index);
+        return true;
+      }, totalSize, fee);
+    }
+    else
+    {
+      for (size_t i = 0; i < m_candidates.size(); ++i)
+      {
+        if (totalSize + m_candidates[i].blobSize <= m_selector.getMaxSize())
+        {
+          m_added.push_back(i);
+          totalSize += m_candidates[i].blobSize;
+          fee += m_candidates[i].fee;
+        }
+      }
+    }
+
+    return !m_added.empty();
+  }
+
+  Logging::LoggerGroup m_nullLog;
+  cryptonote::Currency m_currency;
+  cryptonote::TransactionSelector m_selector;
+  std::vector<cryptonote::TransactionSelector::Candidate> m_candidates;
+  std::vector<size_t> m_added;
+};
@@ -0,0 +1,113 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "cryptonote/core/account.h"
+#include "cryptonote/crypto/chacha.h"
+#include "NodeRpcProxy/NodeRpcProxy.h"
+#include "wallet/WalletGreen.h"
+
+#include <logging/LoggerGroup.h>
+#include <system/Dispatcher.h>
+
+// WalletGreen filled with transactions directly, as if they had been synchronized, so that a save
+// writes what a wallet in use would.
+class test_wallet_save_filled_wallet : public cryptonote::WalletGreen
+{
+public:
+  test_wallet_save_filled_wallet(System::Dispatcher& dispatcher, const cryptonote::Currency& currency, cryptonote::INode& node) :
+    WalletGreen(dispatcher, currency, node)
+  {
+  }
+
+  void addTransaction(uint32_t blockHeight, const std::string& address, int64_t amount)
+  {
+    cryptonote::transaction_infomation_t info;
+    info.transactionHash = crypto::rand<hash_t>();
+    info.publicKey = public_key_t();
+    info.blockHeight = blockHeight;
+    info.timestamp = 1500000000 + blockHeight * 120;
+    info.unlockTime = 0;
+    info.totalAmountIn = amount + 10;
+    info.totalAmountOut = amount;
+    info.extra.assign(44, 1);
+    info.paymentId = cryptonote::NULL_HASH;
+
+    size_t id = insertBlockchainTransaction(info, -amount);
+
+    cryptonote::WalletTransfer transfer;
+    transfer.type = cryptonote::WalletTransferType::USUAL;
+    transfer.address = address;
+    transfer.amount = amount;
+    pushBackOutgoingTransfers(id, { transfer });
+  }
+
+  // What every save did before the key was kept: the password slow hash, then the save itself
+  void saveDerivingKey(std::ostream& destination)
+  {
+    crypto::generate_chacha_key(m_password, m_key);
+    save(destination);
+  }
+};
+
+// Periodic WalletGreen::save of a small wallet, with the encryption key derived from the password
+// on every save as before, or with the key derived once when the wallet was opened.
+template<bool derive_key, size_t transaction_count>
+class test_wallet_save
+{
+public:
+  static const size_t loop_count = derive_key ? 10 : 1000;
+
+  test_wallet_save() :
+    m_currency(cryptonote::CurrencyBuilder(os::appdata::path(), config::testnet::data, m_nullLog).currency()),
+    m_node("127.0.0.1", 0)
+  {
+  }
+
+  ~test_wallet_save()
+  {
+    if (m_wallet) {
+      m_wallet->shutdown();
+    }
+  }
+
+  bool init()
+  {
+    cryptonote::Account account;
+    account.generate();
+    std::string address = cryptonote::Account::getAddress(account.getAccountKeys().address);
+
+    m_wallet.reset(new test_wallet_save_filled_wallet(m_dispatcher, m_currency, m_node));
+    m_wallet->initialize("password");
+    for (size_t i = 0; i < transaction_count; ++i) {
+      m_wallet->addTransaction(static_cast<uint32_t>(i + 1), address, 1000000 + i);
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    std::ostringstream destination;
+    if (derive_key) {
+      m_wallet->saveDerivingKey(destination);
+    } else {
+      m_wallet->save(destination);
+    }
+
+    return !destination.str().empty();
+  }
+
+private:
+  System::Dispatcher m_dispatcher;
+  Logging::LoggerGroup m_nullLog;
+  cryptonote::Currency m_currency;
+  cryptonote::NodeRpcProxy m_node;
+  std::unique_ptr<test_wallet_save_filled_wallet> m_wallet;
+};
@@ -6,15 +6,20 @@
 #include "PerformanceUtils.h"
 
 // tests
+#include "BlockTemplate.h"
 #include "ConstructTransaction.h"
 #include "CheckRingSignature.h"
 #include "CryptoNoteSlowHash.h"
 #include "DerivePublicKey.h"
 #include "DeriveSecretKey.h"
 #include "GenerateKeyDerivation.h"
+#include "GenerateKeyDerivations.h"
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
+#include "GetRandomOuts.h"
 #include "IsOutToAccount.h"
+#include "TransactionSelection.h"
+#include "WalletSave.h"
 
 int main(int argc, char** argv)
 {
@@ -53,11 +58,31 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_is_out_to_acc);
   TEST_PERFORMANCE0(test_generate_key_image_helper);
   TEST_PERFORMANCE0(test_generate_key_derivation);
+  TEST_PERFORMANCE1(test_generate_key_derivations, 1);
+  TEST_PERFORMANCE1(test_generate_key_derivations, 10);
+  TEST_PERFORMANCE1(test_generate_key_derivations, 100);
   TEST_PERFORMANCE0(test_generate_key_image);
   TEST_PERFORMANCE0(test_derive_public_key);
   TEST_PERFORMANCE0(test_derive_secret_key);
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 2);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 4);
+
+  TEST_PERFORMANCE2(test_wallet_save, true, 20);
+  TEST_PERFORMANCE2(test_wallet_save, false, 20);
+
+  TEST_PERFORMANCE3(test_get_random_outs, false, 20, 10);
+  TEST_PERFORMANCE3(test_get_random_outs, true, 20, 10);
+
+  TEST_PERFORMANCE2(test_block_template, false, 1);
+  TEST_PERFORMANCE2(test_block_template, true, 1);
+  TEST_PERFORMANCE2(test_block_template, true, 1000);
+
+  TEST_PERFORMANCE2(test_transaction_selection, false, 1000);
+  TEST_PERFORMANCE2(test_transaction_selection, true, 1000);
+  TEST_PERFORMANCE2(test_transaction_selection, false, 10000);
+  TEST_PERFORMANCE2(test_transaction_selection, true, 10000);
 
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
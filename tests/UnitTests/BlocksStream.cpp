@@ -0,0 +1,178 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "http/HttpParser.h"
+#include "http/HttpResponse.h"
+#include "rpc/BlocksStream.h"
+#include "cryptonote/structures/array.hpp"
+
+using namespace cryptonote;
+
+namespace {
+
+std::string makeRecord(size_t size, char fill) {
+  std::string out;
+  appendStreamRecord(out, std::string(size, fill));
+  return out;
+}
+
+}
+
+TEST(BlocksStream, chunkedResponseIsParsedChunkByChunk) {
+  std::vector<std::string> chunks = { "first", std::string(300, 'x'), "last" };
+  size_t produced = 0;
+
+  HttpResponse response;
+  response.setChunkedBody([&](std::string& chunk) {
+    if (produced == chunks.size()) {
+      return false;
+    }
+
+    chunk = chunks[produced++];
+    return true;
+  });
+
+  std::stringstream stream;
+  stream << response;
+  ASSERT_EQ(std::string::npos, stream.str().find("Content-Length"));
+
+  HttpParser parser;
+  HttpResponse received;
+  std::vector<std::string> receivedChunks;
+  parser.receiveResponse(stream, received, [&](const std::string& data) { receivedChunks.push_back(data); });
+
+  ASSERT_EQ(HttpResponse::STATUS_200, received.getStatus());
+  ASSERT_EQ(chunks, receivedChunks);
+}
+
+TEST(BlocksStream, chunkedResponseIsCollectedIntoBody) {
+  bool done = false;
+  HttpResponse response;
+  response.setChunkedBody([&](std::string& chunk) {
+    if (done) {
+      return false;
+    }
+
+    chunk = "body";
+    done = true;
+    return true;
+  });
+
+  std::stringstream stream;
+  stream << response;
+
+  HttpParser parser;
+  HttpResponse received;
+  parser.receiveResponse(stream, received);
+  ASSERT_EQ("body", received.getBody());
+}
+
+TEST(BlocksStream, readerJoinsRecordsSplitAcrossChunks) {
+  std::string stream = makeRecord(10, 'a') + makeRecord(1, 'b') + makeRecord(70000, 'c');
+  appendStreamTerminator(stream);
+
+  std::vector<std::string> records;
+  BlocksStreamReader reader([&](const std::string& record) { records.push_back(record); });
+
+  for (size_t offset = 0; offset < stream.size(); offset += 7) {
+    ASSERT_FALSE(reader.isFinished());
+    reader.feed(stream.substr(offset, 7));
+  }
+
+  ASSERT_TRUE(reader.isFinished());
+  ASSERT_EQ(3, records.size());
+  ASSERT_EQ(std::string(10, 'a'), records[0]);
+  ASSERT_EQ(std::string(1, 'b'), records[1]);
+  ASSERT_EQ(std::string(70000, 'c'), records[2]);
+}
+
+TEST(BlocksStream, readerRejectsDataAfterTerminator) {
+  std::string stream;
+  appendStreamTerminator(stream);
+  stream += makeRecord(1, 'a');
+
+  BlocksStreamReader reader([](const std::string&) {});
+  ASSERT_ANY_THROW(reader.feed(stream));
+}
+
+TEST(BlocksStream, blockRecordRoundTrip) {
+  block_t block;
+  block.majorVersion = 1;
+  block.minorVersion = 0;
+  block.timestamp = 1000;
+  block.nonce = 42;
+  block.baseTransaction.version = 1;
+  block.baseTransaction.unlockTime = 10;
+
+  transaction_prefix_info_t txp;
+  txp.txPrefix.version = 1;
+  txp.txPrefix.unlockTime = 77;
+  memset(&txp.txHash, 3, sizeof(txp.txHash));
+
+  block_short_info_t item;
+  memset(&item.blockId, 1, sizeof(item.blockId));
+  item.block = IBinary::to(BinaryArray::to(block));
+  item.txPrefixes.push_back(txp);
+
+  BlockShortEntry entry;
+  ASSERT_TRUE(loadBlockRecord(storeBlockRecord(item), entry));
+  ASSERT_EQ(item.blockId, entry.blockHash);
+  ASSERT_TRUE(entry.hasBlock);
+  ASSERT_EQ(block.nonce, entry.block.nonce);
+  ASSERT_EQ(block.timestamp, entry.block.timestamp);
+  ASSERT_EQ(1, entry.txsShortInfo.size());
+  ASSERT_EQ(txp.txHash, entry.txsShortInfo[0].txId);
+  ASSERT_EQ(77, entry.txsShortInfo[0].txPrefix.unlockTime);
+
+  block_short_info_t idOnly;
+  idOnly.blockId = item.blockId;
+  ASSERT_TRUE(loadBlockRecord(storeBlockRecord(idOnly), entry));
+  ASSERT_FALSE(entry.hasBlock);
+  ASSERT_TRUE(entry.txsShortInfo.empty());
+
+  std::string truncated = storeBlockRecord(item);
+  truncated.pop_back();
+  ASSERT_FALSE(loadBlockRecord(truncated, entry));
+}
+
+TEST(BlocksStream, storedBlockRecordMatchesShortInfoRecord) {
+  block_entry_t stored;
+  stored.bl.majorVersion = 1;
+  stored.bl.minorVersion = 0;
+  stored.bl.timestamp = 1000;
+  stored.bl.nonce = 42;
+  stored.bl.baseTransaction.version = 1;
+  stored.bl.baseTransaction.unlockTime = 10;
+  stored.transactions.resize(3);
+  stored.transactions[0].tx = stored.bl.baseTransaction;
+
+  block_short_info_t item;
+  memset(&item.blockId, 1, sizeof(item.blockId));
+
+  for (size_t i = 1; i < stored.transactions.size(); ++i) {
+    transaction_t& tx = stored.transactions[i].tx;
+    tx.version = 1;
+    tx.unlockTime = 70 + i;
+
+    transaction_prefix_info_t txp;
+    txp.txPrefix = tx;
+    txp.txHash = BinaryArray::objectHash(tx);
+    stored.bl.transactionHashes.push_back(txp.txHash);
+    item.txPrefixes.push_back(txp);
+  }
+
+  item.block = IBinary::to(BinaryArray::to(stored.bl));
+  ASSERT_EQ(storeBlockRecord(item), storeBlockRecord(item.blockId, stored, true));
+
+  block_short_info_t idOnly;
+  idOnly.blockId = item.blockId;
+  ASSERT_EQ(storeBlockRecord(idOnly), storeBlockRecord(item.blockId, stored, false));
+
+  stored.transactions.pop_back();
+  ASSERT_ANY_THROW(storeBlockRecord(item.blockId, stored, true));
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+
+#include "cryptonote/core/blockchain/indexing/difficulty_window.h"
+#include "crypto/difficulty.h"
+
+using namespace cryptonote;
+
+namespace {
+
+const size_t TEST_WINDOW = 10;
+const size_t TEST_LAG = 3;
+const size_t TEST_CUT = 2;
+const size_t TEST_TIMESTAMP_WINDOW = 7;
+
+class DifficultyWindowTest : public ::testing::Test {
+public:
+  DifficultyWindowTest() : window(TEST_WINDOW, TEST_LAG, TEST_TIMESTAMP_WINDOW), generator(0) {
+    config.target = 120;
+    config.cut = TEST_CUT;
+    config.lag = TEST_LAG;
+    config.window = TEST_WINDOW;
+  }
+
+  void push() {
+    difficulty_window_entry_t entry;
+    // timestamps go back and forth, as miners' clocks do
+    entry.timestamp = 1000000 + chain.size() * 120 + generator() % 600;
+    entry.cumulativeDifficulty = (chain.empty() ? 0 : chain.back().cumulativeDifficulty) + 1 + generator() % 1000;
+    chain.push_back(entry);
+    if (window.height() + 1 == chain.size()) {
+      window.push(entry);
+    }
+  }
+
+  void pop() {
+    if (window.height() == chain.size()) {
+      window.pop();
+    }
+
+    chain.pop_back();
+  }
+
+  // what Blockchain::syncDifficultyWindow does
+  void sync() {
+    if (window.height() == chain.size() && window.isComplete()) {
+      return;
+    }
+
+    uint32_t height = static_cast<uint32_t>(chain.size());
+    uint32_t count = static_cast<uint32_t>(std::min<size_t>(height, std::max(TEST_WINDOW + TEST_LAG, TEST_TIMESTAMP_WINDOW)));
+    window.reset(height - count);
+    for (uint32_t i = height - count; i < height; ++i) {
+      window.push(chain[i]);
+    }
+  }
+
+  // what Blockchain::getDifficultyForNextBlock used to do
+  uint64_t expectedDifficulty() {
+    std::vector<uint64_t> timestamps;
+    std::vector<difficulty_t> difficulties;
+    size_t offset = chain.size() - std::min(chain.size(), TEST_WINDOW + TEST_LAG);
+    if (offset == 0) {
+      ++offset;
+    }
+
+    for (; offset < chain.size(); ++offset) {
+      timestamps.push_back(chain[offset].timestamp);
+      difficulties.push_back(chain[offset].cumulativeDifficulty);
+    }
+
+    return next_difficulty(timestamps.data(), timestamps.size(), difficulties.data(), reinterpret_cast<uint64_t*>(&config));
+  }
+
+  uint64_t windowDifficulty() {
+    std::vector<difficulty_t> difficulties = window.getCumulativeDifficulties();
+    const std::vector<uint64_t>& timestamps = window.getDifficultyTimestamps();
+    EXPECT_TRUE(std::is_sorted(timestamps.begin(), timestamps.end()));
+    EXPECT_EQ(timestamps.size(), difficulties.size());
+    return next_difficulty_sorted(timestamps.data(), timestamps.size(), difficulties.data(), reinterpret_cast<uint64_t*>(&config));
+  }
+
+  uint64_t expectedMedian() {
+    std::vector<uint64_t> timestamps;
+    for (size_t i = chain.size() - std::min(chain.size(), TEST_TIMESTAMP_WINDOW); i < chain.size(); ++i) {
+      timestamps.push_back(chain[i].timestamp);
+    }
+
+    std::sort(timestamps.begin(), timestamps.end());
+    size_t n = timestamps.size() / 2;
+    return timestamps.size() % 2 ? timestamps[n] : (timestamps[n - 1] + timestamps[n]) / 2;
+  }
+
+  void check() {
+    sync();
+    ASSERT_TRUE(window.isComplete());
+    ASSERT_EQ(expectedDifficulty(), windowDifficulty());
+    ASSERT_EQ(std::min(chain.size(), TEST_TIMESTAMP_WINDOW), window.getTimestampCount());
+    ASSERT_EQ(expectedMedian(), window.getTimestampMedian());
+  }
+
+  DifficultyWindow window;
+  std::vector<difficulty_window_entry_t> chain;
+  std::mt19937 generator;
+  difficulty_config_t config;
+};
+
+}
+
+TEST_F(DifficultyWindowTest, followsGrowingChain) {
+  for (size_t i = 0; i < 200; ++i) {
+    push();
+    ASSERT_NO_FATAL_FAILURE(check());
+  }
+}
+
+TEST_F(DifficultyWindowTest, followsShortReorgs) {
+  for (size_t i = 0; i < 100; ++i) {
+    push();
+  }
+
+  for (size_t round = 0; round < 50; ++round) {
+    size_t depth = generator() % 10;
+    for (size_t i = 0; i < depth; ++i) {
+      pop();
+      ASSERT_TRUE(window.isComplete());
+    }
+
+    for (size_t i = 0; i < depth + 1; ++i) {
+      push();
+    }
+
+    ASSERT_TRUE(window.isComplete());
+    ASSERT_NO_FATAL_FAILURE(check());
+  }
+}
+
+TEST_F(DifficultyWindowTest, becomesIncompleteAfterDeepReorg) {
+  for (size_t i = 0; i < 300; ++i) {
+    push();
+  }
+
+  ASSERT_NO_FATAL_FAILURE(check());
+
+  for (size_t i = 0; i < 150; ++i) {
+    pop();
+  }
+
+  ASSERT_FALSE(window.isComplete());
+  ASSERT_NO_FATAL_FAILURE(check());
+}
+
+TEST_F(DifficultyWindowTest, startsWithGenesisOnly) {
+  push();
+  ASSERT_NO_FATAL_FAILURE(check());
+  ASSERT_EQ(1, windowDifficulty());
+}
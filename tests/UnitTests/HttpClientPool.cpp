@@ -0,0 +1,78 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <system/Context.h>
+#include <system/Dispatcher.h>
+
+#include "rpc/HttpClientPool.h"
+
+using namespace cryptonote;
+using namespace System;
+
+TEST(HttpClientPool, leaseTakesClientFromPool) {
+  Dispatcher dispatcher;
+  HttpClientPool pool(dispatcher, "127.0.0.1", 1, 2);
+  ASSERT_EQ(2, pool.size());
+  ASSERT_EQ(2, pool.idleCount());
+
+  {
+    HttpClientPool::Lease first(pool);
+    ASSERT_EQ(1, pool.idleCount());
+
+    HttpClientPool::Lease second(pool);
+    ASSERT_EQ(0, pool.idleCount());
+    ASSERT_NE(&first.client(), &second.client());
+  }
+
+  ASSERT_EQ(2, pool.idleCount());
+  ASSERT_FALSE(pool.isConnected());
+}
+
+TEST(HttpClientPool, leaseWaitsForReleasedClient) {
+  Dispatcher dispatcher;
+  HttpClientPool pool(dispatcher, "127.0.0.1", 1, 1);
+  HttpClient* leasedClient = nullptr;
+  bool done = false;
+
+  std::unique_ptr<HttpClientPool::Lease> lease(new HttpClientPool::Lease(pool));
+  Context<> context(dispatcher, [&]() {
+    HttpClientPool::Lease waitingLease(pool);
+    leasedClient = &waitingLease.client();
+    done = true;
+  });
+
+  dispatcher.yield();
+  ASSERT_FALSE(done);
+
+  HttpClient* releasedClient = &lease->client();
+  lease.reset();
+  dispatcher.yield();
+  ASSERT_TRUE(done);
+  ASSERT_EQ(releasedClient, leasedClient);
+  ASSERT_EQ(1, pool.idleCount());
+}
+
+TEST(HttpClientPool, concurrentLeasesUseDifferentClients) {
+  Dispatcher dispatcher;
+  HttpClientPool pool(dispatcher, "127.0.0.1", 1, 3);
+  std::vector<HttpClient*> clients;
+
+  auto body = [&]() {
+    HttpClientPool::Lease lease(pool);
+    clients.push_back(&lease.client());
+    dispatcher.yield();
+  };
+
+  Context<> first(dispatcher, body);
+  Context<> second(dispatcher, body);
+  Context<> third(dispatcher, body);
+  dispatcher.yield();
+
+  ASSERT_EQ(3, clients.size());
+  ASSERT_NE(clients[0], clients[1]);
+  ASSERT_NE(clients[0], clients[2]);
+  ASSERT_NE(clients[1], clients[2]);
+}
@@ -76,6 +76,13 @@ bool ICoreStub::handle_incoming_tx(binary_array_t const& tx_blob, cryptonote::tx
   return true;
 }
 
+void ICoreStub::handleIncomingTransactions(const std::vector<binary_array_t>& txBlobs, std::vector<cryptonote::tx_verification_context_t>& tvcs) {
+  tvcs.assign(txBlobs.size(), boost::value_initialized<cryptonote::tx_verification_context_t>());
+  for (size_t i = 0; i < txBlobs.size(); ++i) {
+    handle_incoming_tx(txBlobs[i], tvcs[i], false);
+  }
+}
+
 void ICoreStub::set_blockchain_top(uint32_t height, const hash_t& top_id) {
   topHeight = height;
   topId = top_id;
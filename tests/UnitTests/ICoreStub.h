@@ -28,6 +28,7 @@ public:
   virtual bool get_tx_outputs_gindexs(const hash_t& tx_id, std::vector<uint32_t>& indexs) override;
   virtual cryptonote::ICryptonoteProtocol* get_protocol() override;
   virtual bool handle_incoming_tx(binary_array_t const& tx_blob, cryptonote::tx_verification_context_t& tvc, bool keeped_by_block) override;
+  virtual void handleIncomingTransactions(const std::vector<binary_array_t>& txBlobs, std::vector<cryptonote::tx_verification_context_t>& tvcs) override;
   virtual std::vector<cryptonote::transaction_t> getPoolTransactions() override;
   virtual bool getPoolChanges(const hash_t& tailBlockId, const std::vector<hash_t>& knownTxsIds,
                               std::vector<cryptonote::transaction_t>& addedTxs, std::vector<hash_t>& deletedTxsIds) override;
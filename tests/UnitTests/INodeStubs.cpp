@@ -187,6 +187,9 @@ void INodeTrivialRefreshStub::doRelayTransaction(const transaction_t& transactio
 void INodeTrivialRefreshStub::getRandomOutsByAmounts(std::vector<uint64_t>&& amounts, uint64_t outsCount, std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& result, const Callback& callback)
 {
   m_asyncCounter.addAsyncContext();
+  std::unique_lock<std::mutex> lock(m_walletLock);
+  calls_getRandomOutsByAmounts.push_back(outsCount);
+  lock.unlock();
   std::thread task(&INodeTrivialRefreshStub::doGetRandomOutsByAmounts, this, amounts, outsCount, std::ref(result), callback);
   task.detach();
 }
@@ -104,6 +104,7 @@ public:
   void sendLocalBlockchainUpdated();
 
   std::vector<hash_t> calls_getTransactionOutsGlobalIndices;
+  std::vector<uint64_t> calls_getRandomOutsByAmounts;
 
   virtual ~INodeTrivialRefreshStub();
 
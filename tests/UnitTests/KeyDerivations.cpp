@@ -0,0 +1,82 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "cryptonote/crypto/crypto.h"
+
+namespace {
+
+std::vector<public_key_t> generatePublicKeys(size_t count) {
+  std::vector<public_key_t> keys(count);
+  for (auto& key : keys) {
+    secret_key_t secret;
+    generate_keys((uint8_t*)&key, (uint8_t*)&secret);
+  }
+
+  return keys;
+}
+
+void checkBatchMatchesSingle(const std::vector<public_key_t>& keys, const secret_key_t& viewSecret) {
+  std::vector<key_derivation_t> derivations(keys.size());
+  std::vector<int> results(keys.size());
+  size_t derived = generate_key_derivations((const uint8_t*)keys.data(), keys.size(), (const uint8_t*)&viewSecret,
+    (uint8_t*)derivations.data(), results.data());
+
+  size_t expectedDerived = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    key_derivation_t expected;
+    int expectedResult = generate_key_derivation((const uint8_t*)&keys[i], (const uint8_t*)&viewSecret, (uint8_t*)&expected);
+    ASSERT_EQ(expectedResult, results[i]) << "key " << i;
+    if (expectedResult) {
+      ASSERT_EQ(0, memcmp(&expected, &derivations[i], sizeof(expected))) << "key " << i;
+      ++expectedDerived;
+    }
+  }
+
+  ASSERT_EQ(expectedDerived, derived);
+}
+
+class KeyDerivations : public ::testing::Test {
+public:
+  void SetUp() override {
+    public_key_t viewPublic;
+    generate_keys((uint8_t*)&viewPublic, (uint8_t*)&m_viewSecret);
+  }
+
+protected:
+  secret_key_t m_viewSecret;
+};
+
+}
+
+TEST_F(KeyDerivations, emptyBatch) {
+  ASSERT_EQ(0, generate_key_derivations(nullptr, 0, (const uint8_t*)&m_viewSecret, nullptr, nullptr));
+}
+
+TEST_F(KeyDerivations, singleKeyMatchesGenerateKeyDerivation) {
+  checkBatchMatchesSingle(generatePublicKeys(1), m_viewSecret);
+}
+
+TEST_F(KeyDerivations, batchMatchesGenerateKeyDerivation) {
+  checkBatchMatchesSingle(generatePublicKeys(100), m_viewSecret);
+}
+
+TEST_F(KeyDerivations, invalidKeysDoNotAffectOthers) {
+  auto keys = generatePublicKeys(10);
+
+  // y = 2 does not decode to a curve point
+  public_key_t invalidKey;
+  memset(&invalidKey, 0, sizeof(invalidKey));
+  reinterpret_cast<uint8_t*>(&invalidKey)[0] = 2;
+  ASSERT_EQ(0, check_key((const uint8_t*)&invalidKey));
+
+  keys[0] = invalidKey;
+  keys[5] = invalidKey;
+  keys[9] = invalidKey;
+
+  checkBatchMatchesSingle(keys, m_viewSecret);
+}
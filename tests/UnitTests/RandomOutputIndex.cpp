@@ -0,0 +1,88 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <set>
+
+#include "cryptonote/core/blockchain/indexing/random_output.h"
+
+using namespace cryptonote;
+
+namespace {
+
+random_output_entry_t makeEntry(uint32_t block, uint64_t unlockTime = 0) {
+  random_output_entry_t entry;
+  entry.key = public_key_t();
+  entry.unlockTime = unlockTime;
+  entry.block = block;
+  return entry;
+}
+
+bool alwaysUnlocked(uint64_t) {
+  return true;
+}
+
+}
+
+TEST(RandomOutputIndex, countUpToCountsOutputsOfOlderBlocks) {
+  RandomOutputIndex index;
+  for (uint32_t block : {1, 1, 2, 4, 4, 4, 7}) {
+    index.push(10, makeEntry(block));
+  }
+
+  ASSERT_EQ(0, index.countUpTo(10, 0));
+  ASSERT_EQ(2, index.countUpTo(10, 1));
+  ASSERT_EQ(3, index.countUpTo(10, 3));
+  ASSERT_EQ(6, index.countUpTo(10, 6));
+  ASSERT_EQ(7, index.countUpTo(10, 100));
+  ASSERT_EQ(0, index.countUpTo(20, 100));
+}
+
+TEST(RandomOutputIndex, truncateKeepsPrefix) {
+  RandomOutputIndex index;
+  for (uint32_t block = 0; block < 5; ++block) {
+    index.push(10, makeEntry(block));
+  }
+
+  index.truncate(10, 3);
+  ASSERT_EQ(3, index.size(10));
+  ASSERT_EQ(2, index.get(10, 2).block);
+
+  index.truncate(10, 0);
+  ASSERT_EQ(0, index.size(10));
+}
+
+TEST(RandomOutputIndex, pickRandomReturnsDistinctOutputsBelowLimit) {
+  RandomOutputIndex index;
+  for (uint32_t block = 0; block < 100; ++block) {
+    index.push(10, makeEntry(block));
+  }
+
+  auto picked = index.pickRandom(10, 50, 20, alwaysUnlocked);
+  std::set<uint32_t> distinct(picked.begin(), picked.end());
+
+  ASSERT_EQ(20, picked.size());
+  ASSERT_EQ(20, distinct.size());
+  ASSERT_LT(*distinct.rbegin(), 50);
+}
+
+TEST(RandomOutputIndex, pickRandomSkipsLockedOutputs) {
+  RandomOutputIndex index;
+  for (uint32_t block = 0; block < 10; ++block) {
+    index.push(10, makeEntry(block, block % 2));
+  }
+
+  auto picked = index.pickRandom(10, 10, 10, [](uint64_t unlockTime) { return unlockTime == 0; });
+
+  ASSERT_EQ(5, picked.size());
+  for (auto i : picked) {
+    ASSERT_EQ(0, i % 2);
+  }
+}
+
+TEST(RandomOutputIndex, pickRandomReturnsNothingForUnknownAmount) {
+  RandomOutputIndex index;
+  ASSERT_TRUE(index.pickRandom(10, 10, 10, alwaysUnlocked).empty());
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <array>
+
+#include "cryptonote/crypto/crypto.h"
+
+namespace {
+
+// As long as a block hashing blob, which is more than variant 1 needs.
+const size_t INPUT_SIZE = 76;
+
+class SlowHashMulti : public ::testing::Test {
+public:
+  void SetUp() override {
+    for (size_t i = 0; i < m_inputs.size(); ++i) {
+      for (size_t j = 0; j < INPUT_SIZE; ++j) {
+        m_inputs[i][j] = static_cast<uint8_t>(j * 31 + i * 17 + 5);
+      }
+    }
+  }
+
+  // Hashes the first count inputs at once and each of them alone, the results must not differ.
+  void checkAgainstSingle(size_t count, int variant) {
+    std::array<const void *, SLOW_HASH_MULTI_MAX> data;
+    std::array<hash_t, SLOW_HASH_MULTI_MAX> hashes;
+    std::array<char *, SLOW_HASH_MULTI_MAX> output;
+    for (size_t i = 0; i < count; ++i) {
+      data[i] = m_inputs[i].data();
+      output[i] = reinterpret_cast<char *>(&hashes[i]);
+    }
+
+    crypto::cn_slow_hash_multi(data.data(), INPUT_SIZE, count, output.data(), variant);
+
+    for (size_t i = 0; i < count; ++i) {
+      hash_t expected;
+      crypto::cn_slow_hash(m_inputs[i].data(), INPUT_SIZE, reinterpret_cast<char *>(&expected), variant, 0);
+      EXPECT_EQ(expected, hashes[i]) << "input " << i << " of " << count << ", variant " << variant;
+    }
+  }
+
+protected:
+  std::array<std::array<uint8_t, INPUT_SIZE>, SLOW_HASH_MULTI_MAX> m_inputs;
+};
+
+TEST_F(SlowHashMulti, variant1MatchesSingleHash) {
+  for (size_t count = 2; count <= SLOW_HASH_MULTI_MAX; ++count) {
+    checkAgainstSingle(count, 1);
+  }
+}
+
+TEST_F(SlowHashMulti, variant2MatchesSingleHash) {
+  for (size_t count = 2; count <= SLOW_HASH_MULTI_MAX; ++count) {
+    checkAgainstSingle(count, 2);
+  }
+}
+
+TEST_F(SlowHashMulti, sameInputsGiveSameHashes) {
+  m_inputs[1] = m_inputs[0];
+  m_inputs[2] = m_inputs[0];
+  checkAgainstSingle(3, 2);
+}
+
+}
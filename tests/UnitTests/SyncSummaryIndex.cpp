@@ -0,0 +1,110 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include "cryptonote/crypto/crypto.h"
+#include "cryptonote/core/blockchain/indexing/sync_summary.h"
+#include "cryptonote/core/transaction/TransactionExtra.h"
+#include "cryptonote/structures/array.hpp"
+#include "cryptonote/structures/block_entry.h"
+#include "serialization/SerializationTools.h"
+
+using namespace cryptonote;
+
+namespace {
+
+public_key_t generatePublicKey() {
+  public_key_t key;
+  secret_key_t secret;
+  generate_keys((uint8_t*)&key, (uint8_t*)&secret);
+  return key;
+}
+
+transaction_entry_t makeTransaction(uint32_t firstGlobalIndex, size_t keyOutputs, bool withMultisignatureOutput) {
+  transaction_entry_t entry;
+  entry.tx.version = 1;
+  entry.tx.unlockTime = 0;
+
+  addTransactionPublicKeyToExtra(entry.tx.extra, generatePublicKey());
+
+  for (size_t i = 0; i < keyOutputs; ++i) {
+    if (withMultisignatureOutput && i == 1) {
+      transaction_output_t msig;
+      msig.amount = 5;
+      multi_signature_output_t target;
+      target.requiredSignatureCount = 1;
+      target.keys.push_back(generatePublicKey());
+      msig.target = target;
+      entry.tx.outputs.push_back(msig);
+      entry.m_global_output_indexes.push_back(0);
+    }
+
+    transaction_output_t out;
+    out.amount = 100 * (i + 1);
+    key_output_t target;
+    target.key = generatePublicKey();
+    out.target = target;
+    entry.tx.outputs.push_back(out);
+    entry.m_global_output_indexes.push_back(firstGlobalIndex + static_cast<uint32_t>(i));
+  }
+
+  return entry;
+}
+
+block_entry_t makeBlock(uint32_t height) {
+  block_entry_t block;
+  block.height = height;
+  block.bl.majorVersion = 1;
+  block.bl.minorVersion = 0;
+  block.bl.timestamp = 1000 + height;
+  block.bl.nonce = height;
+
+  block.transactions.push_back(makeTransaction(height, 1, false));
+  base_input_t in;
+  in.blockIndex = height;
+  block.transactions[0].tx.inputs.push_back(in);
+  block.bl.baseTransaction = block.transactions[0].tx;
+
+  block.transactions.push_back(makeTransaction(10 * height, 3, true));
+  block.transactions.push_back(makeTransaction(0, 0, false));
+  block.bl.transactionHashes.push_back(BinaryArray::objectHash(block.transactions[1].tx));
+  block.bl.transactionHashes.push_back(BinaryArray::objectHash(block.transactions[2].tx));
+
+  return block;
+}
+
+}
+
+TEST(SyncSummary, summaryKeepsOnlyKeyOutputs) {
+  block_entry_t block = makeBlock(0);
+  block_sync_summary_t summary = makeSyncSummary(block);
+
+  ASSERT_EQ(Block::getHash(block.bl), summary.blockHash);
+  ASSERT_EQ(block.bl.timestamp, summary.timestamp);
+  // transaction without outputs is dropped
+  ASSERT_EQ(2, summary.transactions.size());
+
+  const transaction_sync_summary_t& miner = summary.transactions[0];
+  ASSERT_EQ(BinaryArray::objectHash(block.bl.baseTransaction), miner.txHash);
+  ASSERT_EQ(getTransactionPublicKeyFromExtra(block.bl.baseTransaction.extra), miner.txPublicKey);
+
+  const transaction_sync_summary_t& tx = summary.transactions[1];
+  ASSERT_EQ(block.bl.transactionHashes[0], tx.txHash);
+  ASSERT_EQ(std::vector<uint16_t>({ 0, 2, 3 }), tx.outputIndexes);
+  ASSERT_EQ(std::vector<uint64_t>({ 100, 200, 300 }), tx.amounts);
+  ASSERT_EQ(std::vector<uint32_t>({ 0, 1, 2 }), tx.globalIndexes);
+  ASSERT_EQ(boost::get<key_output_t>(block.transactions[1].tx.outputs[2].target).key, tx.outputKeys[1]);
+}
+
+TEST(SyncSummary, summarySurvivesKeyValueRoundTrip) {
+  block_entry_t block = makeBlock(0);
+  block_sync_summary_t summary = makeSyncSummary(block);
+  block_sync_summary_t loaded;
+
+  ASSERT_TRUE(loadFromBinaryKeyValue(loaded, storeToBinaryKeyValue(summary)));
+  ASSERT_EQ(summary.transactions.size(), loaded.transactions.size());
+  ASSERT_EQ(summary.transactions[1].outputKeys, loaded.transactions[1].outputKeys);
+  ASSERT_EQ(summary.transactions[1].globalIndexes, loaded.transactions[1].globalIndexes);
+}
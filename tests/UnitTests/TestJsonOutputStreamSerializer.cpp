@@ -0,0 +1,103 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "common/JsonValue.h"
+#include "serialization/JsonOutputStreamSerializer.h"
+#include "serialization/SerializationOverloads.h"
+
+using namespace cryptonote;
+using Common::JsonValue;
+
+namespace {
+
+struct StreamTestItem {
+  std::string hash;
+  uint64_t amount;
+  int64_t delta;
+  bool confirmed;
+  std::vector<uint32_t> indices;
+
+  void serialize(ISerializer& s) {
+    s(hash, "hash");
+    s(amount, "amount");
+    s(delta, "delta");
+    s(confirmed, "confirmed");
+    s(indices, "indices");
+  }
+};
+
+struct StreamTestResponse {
+  uint32_t count;
+  double ratio;
+  StreamTestItem last;
+  std::vector<StreamTestItem> items;
+
+  void serialize(ISerializer& s) {
+    s(count, "count");
+    s(ratio, "ratio");
+    s(last, "last");
+    s(items, "items");
+  }
+};
+
+StreamTestResponse makeResponse(size_t itemCount) {
+  StreamTestResponse response;
+  response.count = static_cast<uint32_t>(itemCount);
+  response.ratio = 0.25;
+  response.last = { "last", 1, -1, false, {} };
+
+  for (size_t i = 0; i < itemCount; ++i) {
+    response.items.push_back({ "hash" + std::to_string(i), i * 1000, -static_cast<int64_t>(i), i % 2 == 0, { 1, 2, static_cast<uint32_t>(i) } });
+  }
+
+  return response;
+}
+
+std::string serializeToTree(StreamTestResponse response) {
+  JsonOutputStreamSerializer serializer;
+  response.serialize(serializer);
+  return serializer.getValue().toString();
+}
+
+std::string serializeToStream(StreamTestResponse response) {
+  std::ostringstream stream;
+  {
+    JsonOutputStreamSerializer serializer(stream);
+    response.serialize(serializer);
+  }
+
+  return stream.str();
+}
+
+}
+
+TEST(JsonOutputStreamSerializer, streamedOutputIsValidJson) {
+  std::string streamed = serializeToStream(makeResponse(3));
+
+  JsonValue parsed;
+  ASSERT_NO_THROW(parsed = JsonValue::fromString(streamed));
+  ASSERT_TRUE(parsed.isObject());
+  ASSERT_EQ(3, parsed("items").size());
+  ASSERT_EQ("hash2", parsed("items")[2]("hash").getString());
+}
+
+TEST(JsonOutputStreamSerializer, streamedOutputMatchesTree) {
+  for (size_t itemCount : { 0, 1, 5 }) {
+    std::string streamed = serializeToStream(makeResponse(itemCount));
+    ASSERT_EQ(serializeToTree(makeResponse(itemCount)), JsonValue::fromString(streamed).toString());
+  }
+}
+
+TEST(JsonOutputStreamSerializer, emptyRootIsEmptyObject) {
+  std::ostringstream stream;
+  {
+    JsonOutputStreamSerializer serializer(stream);
+  }
+
+  ASSERT_EQ("{}", stream.str());
+}
@@ -799,6 +799,21 @@ TEST_F(TransfersContainer_detach, detachConfirmedTransactionWithUnrelatedUnconfi
   ASSERT_EQ(TEST_OUTPUT_AMOUNT, container.balance(ITransfersContainer::IncludeAll));
 }
 
+TEST_F(TransfersContainer_detach, detachLocksRemainingTransferAgain) {
+  addTransaction(TEST_BLOCK_HEIGHT);
+  container.advanceHeight(TEST_BLOCK_HEIGHT + TEST_TRANSACTION_SPENDABLE_AGE * 2);
+  ASSERT_EQ(TEST_OUTPUT_AMOUNT, container.balance(ITransfersContainer::IncludeAllUnlocked));
+
+  container.detach(TEST_BLOCK_HEIGHT + 1);
+
+  ASSERT_EQ(1, container.transfersCount());
+  ASSERT_EQ(0, container.balance(ITransfersContainer::IncludeAllUnlocked));
+  ASSERT_EQ(TEST_OUTPUT_AMOUNT, container.balance(ITransfersContainer::IncludeTypeAll | ITransfersContainer::IncludeStateSoftLocked));
+
+  container.advanceHeight(TEST_BLOCK_HEIGHT + TEST_TRANSACTION_SPENDABLE_AGE);
+  ASSERT_EQ(TEST_OUTPUT_AMOUNT, container.balance(ITransfersContainer::IncludeAllUnlocked));
+}
+
 TEST_F(TransfersContainer_detach, confirmedWithUnconfirmedSpendingTransaction_H1) {
 
   auto tx = addTransaction(TEST_BLOCK_HEIGHT);
@@ -13,6 +13,7 @@
 #include "cryptonote/core/currency.h"
 #include "cryptonote/core/transaction/TransactionApi.h"
 #include "cryptonote/core/transaction/TransactionApiExtra.h"
+#include "cryptonote/core/transaction/TransactionExtra.h"
 #include "INodeStubs.h"
 #include "TestBlockchainGenerator.h"
 #include "TransactionApiHelpers.h"
@@ -696,6 +697,118 @@ TEST_F(WalletApi, transferTooBigMixin) {
   ASSERT_ANY_THROW(sendMoney(RANDOM_ADDRESS, SENT, FEE, 15));
 }
 
+TEST_F(WalletApi, transferAsksNodeForMixinOutputsByDefault) {
+  generateAndUnlockMoney();
+
+  node.setNextTransactionError();
+  try {
+    sendMoney(RANDOM_ADDRESS, SENT, FEE, 3);
+  } catch (std::exception&) {
+  }
+  node.setNextTransactionError();
+  try {
+    sendMoney(RANDOM_ADDRESS, SENT, FEE, 3);
+  } catch (std::exception&) {
+  }
+
+  ASSERT_EQ((std::vector<uint64_t>{3, 3}), node.calls_getRandomOutsByAmounts);
+}
+
+TEST_F(WalletApi, transferDrawsMixinFromDecoyCacheIfEnabled) {
+  generateAndUnlockMoney();
+
+  DecoyCachePolicy policy;
+  policy.outputsPerAmount = 20;
+  alice.setDecoyCachePolicy(policy);
+
+  node.setNextTransactionError();
+  try {
+    sendMoney(RANDOM_ADDRESS, SENT, FEE, 3);
+  } catch (std::exception&) {
+  }
+
+  ASSERT_EQ(1, node.calls_getRandomOutsByAmounts.size());
+  ASSERT_EQ(20, node.calls_getRandomOutsByAmounts[0]);
+}
+
+TEST_F(WalletApi, batchTransferReturnsNothingForEmptyBatch) {
+  auto ids = alice.transfer(std::vector<cryptonote::TransactionParameters>());
+  ASSERT_TRUE(ids.empty());
+  ASSERT_EQ(0, alice.getTransactionCount());
+}
+
+TEST_F(WalletApi, batchTransferSendsEveryTransaction) {
+  generateAndUnlockMoney();
+  size_t transactionCount = alice.getTransactionCount();
+
+  cryptonote::TransactionParameters first;
+  first.destinations = {{RANDOM_ADDRESS, SENT}};
+  first.fee = FEE;
+
+  cryptonote::TransactionParameters second = first;
+  second.destinations = {{RANDOM_ADDRESS, SENT + 1}};
+
+  auto ids = alice.transfer(std::vector<cryptonote::TransactionParameters>{first, second});
+
+  ASSERT_EQ(2, ids.size());
+  ASSERT_NE(ids[0], ids[1]);
+  ASSERT_EQ(transactionCount + 2, alice.getTransactionCount());
+
+  for (auto id: ids) {
+    WalletTransaction tx = alice.getTransaction(id);
+    ASSERT_EQ(WalletTransactionState::SUCCEEDED, tx.state);
+
+    cryptonote::transaction_t relayed;
+    ASSERT_TRUE(generator.getTransactionByHash(tx.hash, relayed, true));
+  }
+}
+
+TEST_F(WalletApi, batchTransferSendsNothingIfAnyTransactionIsInvalid) {
+  generateAndUnlockMoney();
+  size_t transactionCount = alice.getTransactionCount();
+
+  cryptonote::TransactionParameters valid;
+  valid.destinations = {{RANDOM_ADDRESS, SENT}};
+  valid.fee = FEE;
+
+  cryptonote::TransactionParameters invalid = valid;
+  invalid.changeDestination = "Wrong address";
+
+  ASSERT_ANY_THROW(alice.transfer(std::vector<cryptonote::TransactionParameters>{valid, invalid}));
+  ASSERT_EQ(transactionCount, alice.getTransactionCount());
+}
+
+TEST_F(WalletApi, batchTransferDoesNotSpendOutputTwice) {
+  generateAndUnlockMoney();
+  size_t transactionCount = alice.getTransactionCount();
+
+  cryptonote::TransactionParameters params;
+  params.destinations = {{RANDOM_ADDRESS, alice.getActualBalance() / 2}};
+  params.fee = FEE;
+
+  try {
+    alice.transfer(std::vector<cryptonote::TransactionParameters>{params, params});
+    FAIL() << "Both transactions can't be paid from the same balance";
+  } catch (const std::system_error& e) {
+    ASSERT_EQ(cryptonote::error::WRONG_AMOUNT, e.code().value());
+  }
+
+  ASSERT_EQ(transactionCount, alice.getTransactionCount());
+}
+
+TEST_F(WalletApi, batchTransferTooBigMixin) {
+  generateAndUnlockMoney();
+
+  node.setMaxMixinCount(10);
+
+  cryptonote::TransactionParameters params;
+  params.destinations = {{RANDOM_ADDRESS, SENT}};
+  params.fee = FEE;
+  params.mixIn = 15;
+
+  ASSERT_ANY_THROW(alice.transfer(std::vector<cryptonote::TransactionParameters>{params}));
+}
+
 TEST_F(WalletApi, transferNegativeAmount) {
   generateAndUnlockMoney();
   ASSERT_ANY_THROW(sendMoney(RANDOM_ADDRESS, -static_cast<int64_t>(SENT), FEE));
@@ -1029,6 +1142,58 @@ void compareWalletsTransactionTransfers(const cryptonote::WalletGreen& alice, co
 //   wait(100);
 // }
 
+TEST_F(WalletApi, loadAppliesSavedChanges) {
+  std::stringstream data;
+  alice.save(data, true, false);
+
+  generateAndUnlockMoney();
+  ASSERT_TRUE(alice.saveChanges(data));
+
+  WalletGreen bob(dispatcher, currency, node, TRANSACTION_SOFTLOCK_TIME);
+  bob.load(data, "pass");
+
+  ASSERT_NE(0, bob.getTransactionCount());
+  compareWalletsTransactionTransfers(alice, bob);
+
+  bob.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, loadIgnoresTruncatedChanges) {
+  std::stringstream data;
+  alice.save(data, true, false);
+  size_t snapshotSize = data.str().size();
+
+  generateAndUnlockMoney();
+  ASSERT_TRUE(alice.saveChanges(data));
+
+  std::stringstream truncated(data.str().substr(0, data.str().size() - 1));
+
+  WalletGreen bob(dispatcher, currency, node, TRANSACTION_SOFTLOCK_TIME);
+  ASSERT_NO_THROW(bob.load(truncated, "pass"));
+  ASSERT_LT(snapshotSize, truncated.str().size());
+  ASSERT_EQ(0, bob.getTransactionCount());
+
+  bob.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, saveChangesRequiresFullSaveAfterPasswordChange) {
+  std::stringstream data;
+  alice.save(data, true, false);
+
+  alice.changePassword("pass", "pass2");
+  ASSERT_FALSE(alice.saveChanges(data));
+}
+
+TEST_F(WalletApi, saveChangesRequiresFullSaveAfterSaveWithoutDetails) {
+  std::stringstream data;
+  alice.save(data, false, false);
+
+  generateAndUnlockMoney();
+  ASSERT_FALSE(alice.saveChanges(data));
+}
+
 TEST_F(WalletApi, loadWithWrongPassword) {
   std::stringstream data;
   alice.save(data, false, false);
@@ -2966,6 +3131,112 @@ size_t getTransactionsCount(const std::vector<TransactionsInBlockInfo>& transact
 //   ASSERT_TRUE(transactionWithTransfersFound(alice, transactions, transactionId2));
 // }
 
+TEST_F(WalletApi, getTransactionsFromSeveralBlocksReturnsEveryConfirmedTransaction) {
+  generateAndUnlockMoney();
+
+  uint32_t blockCount = alice.getBlockCount();
+  size_t expectedCount = 0;
+  for (size_t i = 0; i < alice.getTransactionCount(); ++i) {
+    auto transaction = alice.getTransaction(i);
+    if (transaction.state == WalletTransactionState::SUCCEEDED && transaction.blockHeight < blockCount) {
+      ++expectedCount;
+    }
+  }
+
+  auto transactions = alice.getTransactions(0, blockCount);
+
+  ASSERT_EQ(blockCount, transactions.size());
+  ASSERT_NE(0, expectedCount);
+  ASSERT_EQ(expectedCount, getTransactionsCount(transactions));
+}
+
+TEST_F(WalletApi, getTransactionsByAddressReturnsSameTransactionsAsUnfiltered) {
+  generateAndUnlockMoney();
+
+  uint32_t blockCount = alice.getBlockCount();
+  auto allTransactions = alice.getTransactions(0, blockCount);
+  auto addressTransactions = alice.getTransactions({aliceAddress}, 0, blockCount);
+
+  ASSERT_EQ(allTransactions.size(), addressTransactions.size());
+  ASSERT_NE(0, getTransactionsCount(addressTransactions));
+  ASSERT_EQ(getTransactionsCount(allTransactions), getTransactionsCount(addressTransactions));
+}
+
+TEST_F(WalletApi, getTransactionsByAddressOfEveryBlockMatchUnfiltered) {
+  generateAndUnlockMoney();
+
+  uint32_t blockCount = alice.getBlockCount();
+  size_t addressTransactionCount = 0;
+  for (uint32_t blockIndex = 0; blockIndex < blockCount; ++blockIndex) {
+    auto blockTransactions = alice.getTransactions(blockIndex, 1);
+    auto addressTransactions = alice.getTransactions({aliceAddress}, blockIndex, 1);
+
+    ASSERT_EQ(1, addressTransactions.size());
+    ASSERT_EQ(getTransactionsCount(blockTransactions), getTransactionsCount(addressTransactions)) << "block " << blockIndex;
+    addressTransactionCount += getTransactionsCount(addressTransactions);
+  }
+
+  ASSERT_EQ(getTransactionsCount(alice.getTransactions(0, blockCount)), addressTransactionCount);
+}
+
+TEST_F(WalletApi, getTransactionsByAddressSkipsOtherAddresses) {
+  generateAndUnlockMoney();
+
+  uint32_t blockCount = alice.getBlockCount();
+  auto transactions = alice.getTransactions({RANDOM_ADDRESS}, 0, blockCount);
+
+  ASSERT_EQ(blockCount, transactions.size());
+  ASSERT_EQ(0, getTransactionsCount(transactions));
+}
+
+TEST_F(WalletApi, getTransactionsByPaymentIdThrowsIfNotInitialized) {
+  WalletGreen wallet(dispatcher, currency, node);
+  ASSERT_ANY_THROW(wallet.getTransactionsByPaymentId(NULL_HASH));
+}
+
+TEST_F(WalletApi, getTransactionsByPaymentIdReturnsEmptyArrayIfNoTransactionHasIt) {
+  generateAndUnlockMoney();
+
+  hash_t paymentId;
+  std::generate(std::begin(paymentId.data), std::end(paymentId.data), std::rand);
+
+  ASSERT_TRUE(alice.getTransactionsByPaymentId(paymentId).empty());
+}
+
+TEST_F(WalletApi, getTransactionsByPaymentIdReturnsEmptyArrayForNullPaymentId) {
+  generateAndUnlockMoney();
+
+  ASSERT_NE(0, alice.getTransactionCount());
+  ASSERT_TRUE(alice.getTransactionsByPaymentId(NULL_HASH).empty());
+}
+
+TEST(WalletTransactionsPaymentIdIndex, findsTransactionsByPaymentIdFromExtra) {
+  const std::string PAYMENT_ID = "dededededededededededededededededededededededededededededededede";
+  std::vector<uint8_t> extra;
+  ASSERT_TRUE(createTxExtraWithPaymentId(PAYMENT_ID, extra));
+
+  WalletTransactions transactions;
+  WalletTransaction withPaymentId;
+  withPaymentId.hash = Key::zero<hash_t>();
+  withPaymentId.extra.assign(extra.begin(), extra.end());
+  withPaymentId.paymentId = getPaymentIdFromExtra(withPaymentId.extra);
+
+  WalletTransaction withoutPaymentId;
+  std::generate(std::begin(withoutPaymentId.hash.data), std::end(withoutPaymentId.hash.data), std::rand);
+  withoutPaymentId.paymentId = getPaymentIdFromExtra(withoutPaymentId.extra);
+
+  transactions.get<RandomAccessIndex>().push_back(withPaymentId);
+  transactions.get<RandomAccessIndex>().push_back(withoutPaymentId);
+
+  hash_t paymentId;
+  ASSERT_TRUE(hex::podFrom(PAYMENT_ID, paymentId));
+
+  auto range = transactions.get<TransactionPaymentIdIndex>().equal_range(paymentId);
+  ASSERT_EQ(1, std::distance(range.first, range.second));
+  ASSERT_EQ(withPaymentId.hash, range.first->hash);
+  ASSERT_EQ(1, transactions.get<TransactionPaymentIdIndex>().count(NULL_HASH));
+}
+
 TEST_F(WalletApi, getTransactionsReturnsBlockWithCorrectHash) {
   waitForWalletEvent(alice, cryptonote::WalletEventType::SYNC_COMPLETED, std::chrono::seconds(3));
 
@@ -0,0 +1,120 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <set>
+
+#include "wallet/WalletDecoyCache.h"
+
+using namespace cryptonote;
+
+namespace {
+
+const std::time_t NOW = 1000000;
+
+WalletDecoyCache::outs_for_amount makeOuts(uint64_t amount, uint64_t count) {
+  WalletDecoyCache::outs_for_amount outs;
+  outs.amount = amount;
+  for (uint64_t i = 0; i < count; ++i) {
+    COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry entry;
+    entry.global_amount_index = i;
+    entry.out_key = public_key_t();
+    outs.outs.push_back(entry);
+  }
+
+  return outs;
+}
+
+DecoyCachePolicy makePolicy(uint64_t outputsPerAmount, uint64_t maxAgeSeconds, size_t maxAmounts) {
+  DecoyCachePolicy policy;
+  policy.outputsPerAmount = outputsPerAmount;
+  policy.maxAgeSeconds = maxAgeSeconds;
+  policy.maxAmounts = maxAmounts;
+  return policy;
+}
+
+}
+
+TEST(WalletDecoyCache, emptyCacheReportsEveryDistinctAmountStale) {
+  WalletDecoyCache cache;
+  auto stale = cache.getStaleAmounts({10, 20, 10}, NOW);
+
+  ASSERT_EQ((std::vector<uint64_t>{10, 20}), stale);
+}
+
+TEST(WalletDecoyCache, updatedAmountIsFreshUntilMaxAge) {
+  WalletDecoyCache cache(makePolicy(100, 60, 10));
+  cache.update({makeOuts(10, 100)}, NOW);
+
+  ASSERT_TRUE(cache.getStaleAmounts({10}, NOW + 59).empty());
+  ASSERT_EQ((std::vector<uint64_t>{10}), cache.getStaleAmounts({10}, NOW + 60));
+}
+
+TEST(WalletDecoyCache, drawReturnsDistinctOutputsInRequestOrder) {
+  WalletDecoyCache cache;
+  cache.update({makeOuts(10, 100), makeOuts(20, 100)}, NOW);
+
+  auto result = cache.draw({20, 10, 20}, 15);
+
+  ASSERT_EQ(3, result.size());
+  ASSERT_EQ(20, result[0].amount);
+  ASSERT_EQ(10, result[1].amount);
+  ASSERT_EQ(20, result[2].amount);
+
+  for (const auto& outs: result) {
+    std::set<uint64_t> indices;
+    for (const auto& out: outs.outs) {
+      indices.insert(out.global_amount_index);
+    }
+
+    ASSERT_EQ(15, outs.outs.size());
+    ASSERT_EQ(15, indices.size());
+  }
+}
+
+TEST(WalletDecoyCache, drawReturnsWholePoolIfItIsSmall) {
+  WalletDecoyCache cache;
+  cache.update({makeOuts(10, 3)}, NOW);
+
+  auto result = cache.draw({10, 30}, 5);
+
+  ASSERT_EQ(3, result[0].outs.size());
+  ASSERT_TRUE(result[1].outs.empty());
+}
+
+TEST(WalletDecoyCache, trimDropsOldestPools) {
+  WalletDecoyCache cache(makePolicy(100, 600, 2));
+  cache.update({makeOuts(10, 1)}, NOW);
+  cache.update({makeOuts(20, 1)}, NOW + 1);
+  cache.update({makeOuts(30, 1)}, NOW + 2);
+  cache.trim();
+
+  ASSERT_EQ((std::vector<uint64_t>{10}), cache.getStaleAmounts({10, 20, 30}, NOW + 2));
+}
+
+TEST(WalletDecoyCache, canServeOnlyMixinsWithinPolicy) {
+  WalletDecoyCache cache(makePolicy(50, 600, 10));
+
+  ASSERT_TRUE(cache.canServe(50));
+  ASSERT_FALSE(cache.canServe(51));
+
+  cache.setPolicy(makePolicy(0, 600, 10));
+  ASSERT_FALSE(cache.canServe(1));
+}
+
+TEST(WalletDecoyCache, isDisabledByDefault) {
+  WalletDecoyCache cache;
+
+  ASSERT_EQ(0, cache.getPolicy().outputsPerAmount);
+  ASSERT_FALSE(cache.canServe(1));
+}
+
+TEST(WalletDecoyCache, setPolicyDropsPools) {
+  WalletDecoyCache cache;
+  cache.update({makeOuts(10, 100)}, NOW);
+  cache.setPolicy(DecoyCachePolicy());
+
+  ASSERT_EQ((std::vector<uint64_t>{10}), cache.getStaleAmounts({10}, NOW));
+}
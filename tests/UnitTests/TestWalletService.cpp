@@ -5,11 +5,13 @@
 #include "gtest/gtest.h"
 
 #include <algorithm>
+#include <iterator>
 #include <queue>
 #include <system_error>
 
 #include <IWallet.h>
 
+#include "cryptonote/core/account.h"
 #include "cryptonote/core/currency.h"
 #include "logging/LoggerGroup.h"
 #include "logging/ConsoleLogger.h"
@@ -45,6 +47,7 @@ struct IWalletBaseStub : public cryptonote::IWallet {
 
   virtual void changePassword(const std::string& oldPassword, const std::string& newPassword) override { }
   virtual void save(std::ostream& destination, bool saveDetails = true, bool saveCache = true) override { }
+  virtual bool saveChanges(std::ostream& destination) override { return true; }
 
   virtual size_t getAddressCount() const override { return 0; }
   virtual std::string getAddress(size_t index) const override { return ""; }
@@ -69,12 +72,16 @@ struct IWalletBaseStub : public cryptonote::IWallet {
   virtual WalletTransactionWithTransfers getTransaction(const hash_t& transactionHash) const override { return WalletTransactionWithTransfers(); }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const hash_t& blockHash, size_t count) const override { return {}; }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, const hash_t& blockHash, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const hash_t& paymentId) const override { return {}; }
   virtual std::vector<hash_t> getBlockHashes(uint32_t blockIndex, size_t count) const override { return {}; }
   virtual uint32_t getBlockCount() const override { return 0; }
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const override { return {}; }
   virtual std::vector<size_t> getDelayedTransactionIds() const override { return {}; }
 
   virtual size_t transfer(const TransactionParameters& sendingTransaction) override { return 0; }
+  virtual std::vector<size_t> transfer(const std::vector<TransactionParameters>& sendingTransactions) override { return {}; }
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) override { return 0; }
   virtual void commitTransaction(size_t transactionId) override { }
@@ -512,7 +519,18 @@ public:
     return transactions;
   }
 
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, const hash_t& blockHash, size_t count) const override {
+    requestedAddresses = addresses;
+    return transactions;
+  }
+
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const std::vector<std::string>& addresses, uint32_t blockIndex, size_t count) const override {
+    requestedAddresses = addresses;
+    return transactions;
+  }
+
   std::vector<TransactionsInBlockInfo> transactions;
+  mutable std::vector<std::string> requestedAddresses;
 };
 
 TEST_F(WalletServiceTest_getTransactions, addressesFilter_emptyReturnsTransaction) {
@@ -575,6 +593,23 @@ TEST_F(WalletServiceTest_getTransactions, addressesFilter_emptyReturnsTransactio
 //   ASSERT_EQ(hex::podTo(testTransactions[0].transactions[0].transaction.hash), transactions[0].transactions[0].transactionHash);
 // }
 
+TEST_F(WalletServiceTest_getTransactions, addressesFilter_asksWalletForAddressTransactions) {
+  WalletGetTransactionsStub wallet(dispatcher);
+  wallet.transactions = testTransactions;
+
+  auto service = createWalletService(wallet);
+
+  cryptonote::Account account;
+  account.generate();
+  std::string address = cryptonote::Account::getAddress(account.getAccountKeys().address);
+
+  std::vector<TransactionHashesInBlockRpcInfo> transactionHashes;
+  auto ec = service->getTransactionHashes({address}, 0, 1, "", transactionHashes);
+
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(std::vector<std::string>{address}, wallet.requestedAddresses);
+}
+
 TEST_F(WalletServiceTest_getTransactions, paymentIdFilter_existentReturnsTransaction) {
   WalletGetTransactionsStub wallet(dispatcher);
   wallet.transactions = testTransactions;
@@ -637,6 +672,96 @@ TEST_F(WalletServiceTest_getTransactions, blockNotFound) {
   ASSERT_EQ(make_error_code(cryptonote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND), ec);
 }
 
+class WalletGetTransactionsChainStub : public IWalletBaseStub {
+public:
+  WalletGetTransactionsChainStub(System::Dispatcher& d) : IWalletBaseStub(d) {}
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const hash_t& blockHash, size_t count) const override {
+    auto it = std::find_if(blocks.begin(), blocks.end(), [&blockHash] (const TransactionsInBlockInfo& block) { return block.blockHash == blockHash; });
+    return getTransactions(static_cast<uint32_t>(std::distance(blocks.begin(), it)), count);
+  }
+
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override {
+    requestedCounts.push_back(count);
+    if (blockIndex >= blocks.size()) {
+      return {};
+    }
+
+    return std::vector<TransactionsInBlockInfo>(blocks.begin() + blockIndex, blocks.begin() + std::min(blocks.size(), blockIndex + count));
+  }
+
+  std::vector<TransactionsInBlockInfo> blocks;
+  mutable std::vector<size_t> requestedCounts;
+};
+
+TEST_F(WalletServiceTest_getTransactions, longRangeIsReadInSlices) {
+  WalletGetTransactionsChainStub wallet(dispatcher);
+  for (size_t i = 0; i < 250; ++i) {
+    TransactionsInBlockInfo block;
+    block.blockHash = generateRandomHash();
+    wallet.blocks.push_back(block);
+  }
+
+  auto service = createWalletService(wallet);
+
+  WalletService::TransactionHashesReader reader;
+  ASSERT_FALSE(service->getTransactionHashes({}, 0, 300, "", reader));
+  ASSERT_EQ(1, wallet.requestedCounts.size());
+
+  std::vector<TransactionHashesInBlockRpcInfo> blocks;
+  std::vector<TransactionHashesInBlockRpcInfo> transactionHashes;
+  while (reader(blocks)) {
+    std::move(blocks.begin(), blocks.end(), std::back_inserter(transactionHashes));
+    blocks.clear();
+  }
+
+  ASSERT_EQ(wallet.blocks.size(), transactionHashes.size());
+  for (size_t i = 0; i < wallet.blocks.size(); ++i) {
+    ASSERT_EQ(hex::podTo(wallet.blocks[i].blockHash), transactionHashes[i].blockHash);
+  }
+
+  for (size_t count : wallet.requestedCounts) {
+    ASSERT_GE(101, count);
+  }
+}
+
+class WalletGetTransactionsByPaymentIdStub : public IWalletBaseStub {
+public:
+  WalletGetTransactionsByPaymentIdStub(System::Dispatcher& d) : IWalletBaseStub(d) {}
+  virtual std::vector<TransactionsInBlockInfo> getTransactionsByPaymentId(const hash_t& paymentId) const override {
+    requestedPaymentId = paymentId;
+    return transactions;
+  }
+
+  std::vector<TransactionsInBlockInfo> transactions;
+  mutable hash_t requestedPaymentId;
+};
+
+TEST_F(WalletServiceTest_getTransactions, getTransactionsByPaymentId_returnsTransactionsFromWallet) {
+  WalletGetTransactionsByPaymentIdStub wallet(dispatcher);
+  wallet.transactions = testTransactions;
+
+  auto service = createWalletService(wallet);
+
+  std::vector<TransactionsInBlockRpcInfo> transactions;
+  auto ec = service->getTransactionsByPaymentId(PAYMENT_ID, {}, transactions);
+
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(PAYMENT_ID, hex::podTo(wallet.requestedPaymentId));
+
+  ASSERT_EQ(1, transactions.size());
+  ASSERT_EQ(1, transactions[0].transactions.size());
+  ASSERT_EQ(hex::podTo(testTransactions[0].transactions[0].transaction.hash), transactions[0].transactions[0].transactionHash);
+}
+
+TEST_F(WalletServiceTest_getTransactions, getTransactionsByPaymentId_invalidPaymentId) {
+  WalletGetTransactionsByPaymentIdStub wallet(dispatcher);
+  auto service = createWalletService(wallet);
+
+  std::vector<TransactionsInBlockRpcInfo> transactions;
+  auto ec = service->getTransactionsByPaymentId("invalid payment id", {}, transactions);
+  ASSERT_EQ(make_error_code(cryptonote::error::WalletServiceErrorCode::WRONG_PAYMENT_ID_FORMAT), ec);
+}
+
 class WalletServiceTest_getTransaction : public WalletServiceTest_getTransactions {
 };
 
@@ -799,6 +924,115 @@ TEST_F(WalletServiceTest_sendTransaction, incorrectTransferAddress) {
   ASSERT_EQ(make_error_code(cryptonote::error::BAD_ADDRESS), ec);
 }
 
+struct WalletBatchTransferStub : public IWalletBaseStub {
+  WalletBatchTransferStub(System::Dispatcher& dispatcher) : IWalletBaseStub(dispatcher) {
+  }
+
+  virtual std::vector<size_t> transfer(const std::vector<TransactionParameters>& sendingTransactions) override {
+    ++batchCalls;
+    if (failBatch) {
+      throw std::system_error(make_error_code(error::WRONG_AMOUNT));
+    }
+
+    std::vector<size_t> ids;
+    for (const auto& params: sendingTransactions) {
+      ids.push_back(addTransaction(params));
+    }
+
+    return ids;
+  }
+
+  virtual size_t transfer(const TransactionParameters& sendingTransaction) override {
+    if (sendingTransaction.fee == unpayableFee) {
+      throw std::system_error(make_error_code(error::WRONG_AMOUNT));
+    }
+
+    return addTransaction(sendingTransaction);
+  }
+
+  virtual WalletTransaction getTransaction(size_t transactionIndex) const override {
+    return WalletTransactionBuilder().hash(hashes.at(transactionIndex)).state(WalletTransactionState::SUCCEEDED).build();
+  }
+
+  size_t addTransaction(const TransactionParameters& params) {
+    hash_t hash;
+    std::generate(std::begin(hash.data), std::end(hash.data), std::rand);
+
+    sent.push_back(params);
+    hashes.push_back(hash);
+    return hashes.size() - 1;
+  }
+
+  bool failBatch = false;
+  uint64_t unpayableFee = 0;
+  size_t batchCalls = 0;
+  std::vector<TransactionParameters> sent;
+  std::vector<hash_t> hashes;
+};
+
+class WalletServiceTest_sendTransactions : public WalletServiceTest_getTransactions {
+protected:
+  SendTransaction::Request makeRequest(uint64_t fee) {
+    cryptonote::Account account;
+    account.generate();
+
+    SendTransaction::Request request;
+    request.transfers.push_back(WalletRpcOrder {cryptonote::Account::getAddress(account.getAccountKeys().address), 11111});
+    request.fee = fee;
+    return request;
+  }
+};
+
+TEST_F(WalletServiceTest_sendTransactions, invalidTransactionDoesNotStopOthers) {
+  WalletBatchTransferStub wallet(dispatcher);
+  auto service = createWalletService(wallet);
+
+  SendTransactions::Request request;
+  request.transactions.push_back(makeRequest(10));
+  request.transactions.push_back(makeRequest(20));
+  request.transactions.back().transfers.push_back(WalletRpcOrder{"wrong address", 12131});
+  request.transactions.push_back(makeRequest(30));
+
+  std::vector<SendTransactionResult> results;
+  auto ec = service->sendTransactions(request, results);
+
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(1, wallet.batchCalls);
+  ASSERT_EQ(2, wallet.sent.size());
+  ASSERT_EQ(3, results.size());
+
+  ASSERT_EQ(0, results[0].errorCode);
+  ASSERT_EQ(hex::podTo(wallet.hashes[0]), results[0].transactionHash);
+  ASSERT_EQ(make_error_code(cryptonote::error::BAD_ADDRESS).value(), results[1].errorCode);
+  ASSERT_TRUE(results[1].transactionHash.empty());
+  ASSERT_EQ(0, results[2].errorCode);
+  ASSERT_EQ(hex::podTo(wallet.hashes[1]), results[2].transactionHash);
+}
+
+TEST_F(WalletServiceTest_sendTransactions, failedBatchIsSentOneByOne) {
+  WalletBatchTransferStub wallet(dispatcher);
+  wallet.failBatch = true;
+  wallet.unpayableFee = 20;
+  auto service = createWalletService(wallet);
+
+  SendTransactions::Request request;
+  request.transactions.push_back(makeRequest(10));
+  request.transactions.push_back(makeRequest(20));
+  request.transactions.push_back(makeRequest(30));
+
+  std::vector<SendTransactionResult> results;
+  auto ec = service->sendTransactions(request, results);
+
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(2, wallet.sent.size());
+  ASSERT_EQ(10, wallet.sent[0].fee);
+  ASSERT_EQ(30, wallet.sent[1].fee);
+
+  ASSERT_EQ(hex::podTo(wallet.hashes[0]), results[0].transactionHash);
+  ASSERT_EQ(make_error_code(error::WRONG_AMOUNT).value(), results[1].errorCode);
+  ASSERT_EQ(hex::podTo(wallet.hashes[1]), results[2].transactionHash);
+}
+
 class WalletServiceTest_createDelayedTransaction : public WalletServiceTest_getTransactions {
   virtual void SetUp() override;
 protected:
@@ -698,28 +698,28 @@ transaction_t createTestFusionTransaction(const Currency& currency) {
   return builder.createFusionTransactionBySize(TEST_TRANSACTION_SIZE);
 }
 
-transaction_t createTestOrdinaryTransactionWithExtra(const Currency& currency, size_t extraSize) {
+transaction_t createTestOrdinaryTransactionWithExtra(const Currency& currency, size_t extraSize, uint64_t feeMultiplier) {
   TestTransactionBuilder builder;
   if (extraSize != 0) {
     builder.appendExtra(binary_array_t(extraSize, 0));
   }
 
   builder.addTestInput(100 * currency.minimumFee());
-  builder.addTestKeyOutput(99 * currency.minimumFee(), 0);
+  builder.addTestKeyOutput((100 - feeMultiplier) * currency.minimumFee(), 0);
   return convertTx(*builder.build());
 }
 
-transaction_t createTestOrdinaryTransaction(const Currency& currency) {
-  auto tx = createTestOrdinaryTransactionWithExtra(currency, 0);
+transaction_t createTestOrdinaryTransaction(const Currency& currency, uint64_t feeMultiplier = 1) {
+  auto tx = createTestOrdinaryTransactionWithExtra(currency, 0, feeMultiplier);
   size_t realSize = BinaryArray::size(tx);
   if (realSize < TEST_TRANSACTION_SIZE) {
     size_t extraSize = TEST_TRANSACTION_SIZE - realSize;
-    tx = createTestOrdinaryTransactionWithExtra(currency, extraSize);
+    tx = createTestOrdinaryTransactionWithExtra(currency, extraSize, feeMultiplier);
 
     realSize = BinaryArray::size(tx);
     if (realSize > TEST_TRANSACTION_SIZE) {
       extraSize -= realSize - TEST_TRANSACTION_SIZE;
-      tx = createTestOrdinaryTransactionWithExtra(currency, extraSize);
+      tx = createTestOrdinaryTransactionWithExtra(currency, extraSize, feeMultiplier);
     }
   }
 
@@ -783,10 +783,12 @@ public:
 
 }
 
+// Nothing is generated yet in these tests, so the block reward is all fees. Past the median
+// ordinary transactions go in while the penalized fees still grow, which takes 4 more here.
 TEST_F(TxPool_FillBlockTemplate, TxPoolAddsFusionTransactionsToBlockTemplateNoMoreThanLimit) {
   ASSERT_NO_FATAL_FAILURE(doTest(TEST_MAX_TX_COUNT_PER_BLOCK,
     TEST_MAX_TX_COUNT_PER_BLOCK,
-    TEST_MAX_TX_COUNT_PER_BLOCK - TEST_FUSION_TX_COUNT_PER_BLOCK,
+    TEST_TX_COUNT_UP_TO_MEDIAN - TEST_FUSION_TX_COUNT_PER_BLOCK + 4,
     TEST_FUSION_TX_COUNT_PER_BLOCK));
 }
 
@@ -799,10 +801,397 @@ TEST_F(TxPool_FillBlockTemplate, TxPoolAddsFusionTransactionsUpToMedianIfThereAr
   ASSERT_NO_FATAL_FAILURE(doTest(0, TEST_MAX_TX_COUNT_PER_BLOCK, 0, TEST_TX_COUNT_UP_TO_MEDIAN));
 }
 
-TEST_F(TxPool_FillBlockTemplate, TxPoolContinuesToAddOrdinaryTransactionsUpTo125PerCentOfMedianAfterAddingFusionTransactions) {
+TEST_F(TxPool_FillBlockTemplate, TxPoolContinuesToAddOrdinaryTransactionsPastMedianAfterAddingFusionTransactions) {
   size_t fusionTxCount = TEST_FUSION_TX_COUNT_PER_BLOCK - 1;
   ASSERT_NO_FATAL_FAILURE(doTest(TEST_MAX_TX_COUNT_PER_BLOCK,
     fusionTxCount,
-    TEST_MAX_TX_COUNT_PER_BLOCK - fusionTxCount,
+    TEST_TX_COUNT_UP_TO_MEDIAN - fusionTxCount + 4,
     fusionTxCount));
 }
+
+TEST_F(TxPool_FillBlockTemplate, TxPoolAppendsTransactionsAddedAfterBlockTemplateWasFilled) {
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  for (size_t i = 0; i < 2; ++i) {
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency), tvc, false));
+  }
+
+  uint64_t revision = pool->getRevision();
+  block_t block;
+  size_t totalSize;
+  uint64_t totalFee;
+  ASSERT_TRUE(pool->fill_block_template(block, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), 0, totalSize, totalFee));
+  ASSERT_EQ(2, block.transactionHashes.size());
+
+  for (size_t i = 0; i < 3; ++i) {
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency), tvc, false));
+  }
+
+  std::vector<hash_t> addedIds;
+  ASSERT_TRUE(pool->getAddedSince(revision, addedIds));
+  ASSERT_EQ(3, addedIds.size());
+
+  ASSERT_TRUE(pool->append_to_block_template(block.transactionHashes, addedIds, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), totalSize, totalFee));
+  ASSERT_EQ(5, block.transactionHashes.size());
+  ASSERT_EQ(5 * TEST_TRANSACTION_SIZE, totalSize);
+}
+
+TEST_F(TxPool_FillBlockTemplate, TxPoolDoesNotAppendTransactionThatDoesNotFit) {
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  for (size_t i = 0; i < TEST_MAX_TX_COUNT_PER_BLOCK; ++i) {
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency), tvc, false));
+  }
+
+  uint64_t revision = pool->getRevision();
+  block_t block;
+  size_t totalSize;
+  uint64_t totalFee;
+  ASSERT_TRUE(pool->fill_block_template(block, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), 0, totalSize, totalFee));
+
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency), tvc, false));
+
+  std::vector<hash_t> addedIds;
+  ASSERT_TRUE(pool->getAddedSince(revision, addedIds));
+
+  std::vector<hash_t> transactionHashes = block.transactionHashes;
+  ASSERT_FALSE(pool->append_to_block_template(transactionHashes, addedIds, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), totalSize, totalFee));
+  ASSERT_EQ(block.transactionHashes, transactionHashes);
+}
+
+TEST_F(tx_pool, TxPoolReportsNoAdditionsAfterRemoval) {
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  auto tx = createTestOrdinaryTransaction(currency);
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(tx, tvc, false));
+
+  uint64_t revision = pool->getRevision();
+  transaction_t takenTx;
+  size_t blobSize;
+  uint64_t fee;
+  ASSERT_TRUE(pool->take_tx(BinaryArray::objectHash(tx), takenTx, blobSize, fee));
+  ASSERT_NE(revision, pool->getRevision());
+
+  std::vector<hash_t> addedIds;
+  ASSERT_FALSE(pool->getAddedSince(revision, addedIds));
+}
+
+namespace {
+
+class CountingTransactionValidator : public TransactionValidator {
+public:
+  CountingTransactionValidator() : checkCount(0) {}
+
+  virtual bool checkTransactionInputs(const cryptonote::transaction_t& tx, block_info_t& maxUsedBlock, block_info_t& lastFailed) override {
+    ++checkCount;
+    maxUsedBlock.height = 0;
+    maxUsedBlock.id = NULL_HASH;
+    return true;
+  }
+
+  virtual bool haveSpentKeyImages(const cryptonote::transaction_t& tx) override {
+    return spentTransactions.count(BinaryArray::objectHash(tx)) != 0;
+  }
+
+  size_t checkCount;
+  std::unordered_set<hash_t> spentTransactions;
+};
+
+}
+
+TEST_F(TxPool_FillBlockTemplate, TxPoolChecksTransactionsOnlyOnceForSeveralTemplates) {
+  CountingTransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  for (size_t i = 0; i < 5; ++i) {
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency), tvc, false));
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    block_t block;
+    size_t totalSize;
+    uint64_t totalFee;
+    ASSERT_TRUE(pool->fill_block_template(block, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), 0, totalSize, totalFee));
+    ASSERT_EQ(5, block.transactionHashes.size());
+  }
+
+  ASSERT_EQ(5, validator.checkCount);
+}
+
+TEST_F(TxPool_FillBlockTemplate, TxPoolRechecksOnlyTransactionsSpendingWhatBlockSpent) {
+  CountingTransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  std::vector<transaction_t> transactions;
+  for (size_t i = 0; i < 3; ++i) {
+    transactions.push_back(createTestOrdinaryTransaction(currency));
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(transactions.back(), tvc, false));
+  }
+
+  block_t block;
+  size_t totalSize;
+  uint64_t totalFee;
+  ASSERT_TRUE(pool->fill_block_template(block, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), 0, totalSize, totalFee));
+  ASSERT_EQ(3, block.transactionHashes.size());
+  ASSERT_EQ(3, validator.checkCount);
+
+  // a block with a double spend of the first transaction arrives
+  hash_t spentId = BinaryArray::objectHash(transactions[0]);
+  validator.spentTransactions.insert(spentId);
+  ASSERT_TRUE(pool->on_blockchain_inc(2, NULL_HASH, std::vector<transaction_t>(1, transactions[0])));
+
+  ASSERT_TRUE(pool->fill_block_template(block, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), 0, totalSize, totalFee));
+  ASSERT_EQ(2, block.transactionHashes.size());
+  ASSERT_EQ(block.transactionHashes.end(), std::find(block.transactionHashes.begin(), block.transactionHashes.end(), spentId));
+  ASSERT_EQ(4, validator.checkCount);
+
+  // and is popped again
+  validator.spentTransactions.clear();
+  ASSERT_TRUE(pool->on_blockchain_dec(1, NULL_HASH, std::vector<transaction_t>(1, transactions[0])));
+
+  ASSERT_TRUE(pool->fill_block_template(block, currency.blockGrantedFullRewardZone(), std::numeric_limits<size_t>::max(), 0, totalSize, totalFee));
+  ASSERT_EQ(3, block.transactionHashes.size());
+  ASSERT_EQ(5, validator.checkCount);
+}
+
+TEST_F(tx_pool, TxPoolEvictsTransactionsPayingLeastPerByteWhenFull) {
+  currency = cryptonote::CurrencyBuilder(os::appdata::path(), config::testnet::data, logger).mempoolMaxSize(3 * TEST_TRANSACTION_SIZE + TEST_TRANSACTION_SIZE / 2).currency();
+  currency.setPath(m_configDir.string());
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  auto cheapest = createTestOrdinaryTransaction(currency, 1);
+  for (const auto& tx : { cheapest, createTestOrdinaryTransaction(currency, 2), createTestOrdinaryTransaction(currency, 3) }) {
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(tx, tvc, false));
+    ASSERT_TRUE(tvc.m_added_to_pool);
+  }
+
+  size_t poolSize = pool->get_transactions_size();
+  ASSERT_EQ(3 * BinaryArray::size(cheapest), poolSize);
+
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency, 4), tvc, false));
+  ASSERT_TRUE(tvc.m_added_to_pool);
+
+  ASSERT_EQ(3, pool->get_transactions_count());
+  ASSERT_EQ(poolSize, pool->get_transactions_size());
+  ASSERT_EQ(1, pool->get_evicted_transactions_count());
+  ASSERT_FALSE(pool->have_tx(BinaryArray::objectHash(cheapest)));
+}
+
+TEST_F(tx_pool, TxPoolIgnoresTransactionPayingNoMoreThanFullPool) {
+  currency = cryptonote::CurrencyBuilder(os::appdata::path(), config::testnet::data, logger).mempoolMaxSize(2 * TEST_TRANSACTION_SIZE + TEST_TRANSACTION_SIZE / 2).currency();
+  currency.setPath(m_configDir.string());
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  for (size_t i = 0; i < 2; ++i) {
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency, 2), tvc, false));
+  }
+
+  auto tx = createTestOrdinaryTransaction(currency, 2);
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(tx, tvc, false));
+  ASSERT_FALSE(tvc.m_verifivation_failed);
+  ASSERT_FALSE(tvc.m_added_to_pool);
+  ASSERT_FALSE(tvc.m_should_be_relayed);
+
+  ASSERT_EQ(2, pool->get_transactions_count());
+  ASSERT_EQ(0, pool->get_evicted_transactions_count());
+  ASSERT_FALSE(pool->have_tx(BinaryArray::objectHash(tx)));
+}
+
+TEST_F(tx_pool, TxPoolReportsChangesSinceSequence) {
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  auto tx1 = createTestOrdinaryTransaction(currency);
+  auto tx2 = createTestOrdinaryTransaction(currency);
+  auto tx3 = createTestOrdinaryTransaction(currency);
+  for (const auto& tx : { tx1, tx2 }) {
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(tx, tvc, false));
+  }
+
+  uint64_t sequence = pool->get_sequence();
+
+  std::vector<hash_t> newIds;
+  std::vector<hash_t> deletedIds;
+  ASSERT_TRUE(pool->get_changes_since(sequence, newIds, deletedIds));
+  ASSERT_TRUE(newIds.empty());
+  ASSERT_TRUE(deletedIds.empty());
+
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(tx3, tvc, false));
+
+  transaction_t takenTx;
+  size_t blobSize;
+  uint64_t fee;
+  ASSERT_TRUE(pool->take_tx(BinaryArray::objectHash(tx1), takenTx, blobSize, fee));
+
+  ASSERT_TRUE(pool->get_changes_since(sequence, newIds, deletedIds));
+  ASSERT_EQ(std::vector<hash_t>({ BinaryArray::objectHash(tx3) }), newIds);
+  ASSERT_EQ(std::vector<hash_t>({ BinaryArray::objectHash(tx1) }), deletedIds);
+  ASSERT_LT(sequence, pool->get_sequence());
+
+  // the same as a full difference from what was known at sequence
+  std::vector<hash_t> differenceNewIds;
+  std::vector<hash_t> differenceDeletedIds;
+  pool->get_difference({ BinaryArray::objectHash(tx1), BinaryArray::objectHash(tx2) }, differenceNewIds, differenceDeletedIds);
+  ASSERT_EQ(newIds, differenceNewIds);
+  ASSERT_EQ(deletedIds, differenceDeletedIds);
+}
+
+TEST_F(tx_pool, TxPoolDoesNotReportChangesForUnknownSequence) {
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(createTestOrdinaryTransaction(currency), tvc, false));
+
+  uint64_t sequence = pool->get_sequence();
+  std::vector<hash_t> newIds;
+  std::vector<hash_t> deletedIds;
+  ASSERT_FALSE(pool->get_changes_since(1, newIds, deletedIds));
+  ASSERT_FALSE(pool->get_changes_since(sequence + 1, newIds, deletedIds));
+  ASSERT_TRUE(newIds.empty());
+  ASSERT_TRUE(deletedIds.empty());
+}
+
+TEST_F(tx_pool, TxPoolRechecksKeyImagesOfTransactionsCheckedBeforeAdding) {
+  CountingTransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  block_info_t maxUsedBlock;
+  maxUsedBlock.height = 1;
+  maxUsedBlock.id = crypto::rand<hash_t>();
+
+  auto tx = createTestOrdinaryTransaction(currency);
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(tx, BinaryArray::objectHash(tx), BinaryArray::size(tx), maxUsedBlock, tvc));
+  ASSERT_TRUE(tvc.m_added_to_pool);
+  ASSERT_TRUE(tvc.m_should_be_relayed);
+
+  auto spentTx = createTestOrdinaryTransaction(currency);
+  validator.spentTransactions.insert(BinaryArray::objectHash(spentTx));
+  tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_FALSE(pool->add_tx(spentTx, BinaryArray::objectHash(spentTx), BinaryArray::size(spentTx), maxUsedBlock, tvc));
+  ASSERT_TRUE(tvc.m_verifivation_failed);
+  ASSERT_FALSE(tvc.m_added_to_pool);
+
+  ASSERT_EQ(1, pool->get_transactions_count());
+}
+
+TEST_F(tx_pool, TxPoolIsRestoredFromSnapshot) {
+  boost::filesystem::create_directories(m_configDir);
+
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  std::vector<transaction_t> transactions;
+  for (uint64_t feeMultiplier = 1; feeMultiplier <= 3; ++feeMultiplier) {
+    transactions.push_back(createTestOrdinaryTransaction(currency, feeMultiplier));
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(transactions.back(), tvc, false));
+  }
+
+  size_t totalSize = pool->get_transactions_size();
+  ASSERT_TRUE(pool->deinit());
+  pool.reset(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  ASSERT_EQ(transactions.size(), pool->get_transactions_count());
+  ASSERT_EQ(totalSize, pool->get_transactions_size());
+  for (const auto& tx : transactions) {
+    ASSERT_TRUE(pool->have_tx(BinaryArray::objectHash(tx)));
+  }
+
+  // spent key images come back too
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_FALSE(pool->add_tx(transactions.front(), tvc, false));
+  ASSERT_FALSE(tvc.m_added_to_pool);
+}
+
+TEST_F(tx_pool, TxPoolShrinksToMaxSizeOnLoad) {
+  boost::filesystem::create_directories(m_configDir);
+
+  TransactionValidator validator;
+  FakeTimeProvider timeProvider;
+  std::unique_ptr<TxMemoryPool> pool(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  std::vector<transaction_t> transactions;
+  for (uint64_t feeMultiplier = 1; feeMultiplier <= 4; ++feeMultiplier) {
+    transactions.push_back(createTestOrdinaryTransaction(currency, feeMultiplier));
+    tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+    ASSERT_TRUE(pool->add_tx(transactions.back(), tvc, false));
+    ASSERT_TRUE(tvc.m_added_to_pool);
+  }
+
+  ASSERT_TRUE(pool->deinit());
+  pool.reset();
+
+  // the two cheapest go, the pool saved above is over the new limit
+  currency = cryptonote::CurrencyBuilder(os::appdata::path(), config::testnet::data, logger).mempoolMaxSize(2 * TEST_TRANSACTION_SIZE + TEST_TRANSACTION_SIZE / 2).currency();
+  currency.setPath(m_configDir.string());
+  pool.reset(new TxMemoryPool(currency, validator, timeProvider, logger));
+  ASSERT_TRUE(pool->init());
+
+  ASSERT_EQ(2, pool->get_transactions_count());
+  ASSERT_EQ(2, pool->get_evicted_transactions_count());
+  ASSERT_FALSE(pool->have_tx(BinaryArray::objectHash(transactions[0])));
+  ASSERT_FALSE(pool->have_tx(BinaryArray::objectHash(transactions[1])));
+  ASSERT_TRUE(pool->have_tx(BinaryArray::objectHash(transactions[2])));
+  ASSERT_TRUE(pool->have_tx(BinaryArray::objectHash(transactions[3])));
+
+  // evicted transactions are not taken back while the pool stays full
+  tx_verification_context_t tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(transactions[0], tvc, false));
+  ASSERT_FALSE(tvc.m_added_to_pool);
+  ASSERT_EQ(2, pool->get_transactions_count());
+
+  // but are once it has room again, unlike expired ones
+  transaction_t taken;
+  size_t blobSize;
+  uint64_t fee;
+  ASSERT_TRUE(pool->take_tx(BinaryArray::objectHash(transactions[3]), taken, blobSize, fee));
+
+  tvc = boost::value_initialized<tx_verification_context_t>();
+  ASSERT_TRUE(pool->add_tx(transactions[0], tvc, false));
+  ASSERT_TRUE(tvc.m_added_to_pool);
+  ASSERT_EQ(2, pool->get_transactions_count());
+}
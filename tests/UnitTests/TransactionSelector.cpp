@@ -0,0 +1,152 @@
+// Copyright (c) 2011-2016 The Cryptonote developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+
+#include "cryptonote/core/currency.h"
+#include "cryptonote/core/TransactionSelector.h"
+#include "logging/ConsoleLogger.h"
+
+using namespace cryptonote;
+
+namespace {
+
+const size_t TEST_MEDIAN_SIZE = 20000;
+const size_t TEST_MINER_TX_BLOB_RESERVED_SIZE = 600;
+const size_t TEST_FREE_SIZE = TEST_MEDIAN_SIZE - TEST_MINER_TX_BLOB_RESERVED_SIZE;
+// with nothing generated yet the base reward is 1, so only fees count
+const uint64_t FEES_ONLY = 0;
+const uint64_t HALF_GENERATED = UINT64_C(1) << 62;
+
+class TransactionSelectorTest : public ::testing::Test {
+public:
+  TransactionSelectorTest() :
+    m_currency(CurrencyBuilder(os::appdata::path(), config::testnet::data, m_logger).
+      blockGrantedFullRewardZone(TEST_MEDIAN_SIZE).
+      minerTxBlobReservedSize(TEST_MINER_TX_BLOB_RESERVED_SIZE).
+      moneySupply(UINT64_C(1) << 63).
+      currency()) {
+  }
+
+  std::vector<size_t> select(const TransactionSelector& selector, const std::vector<TransactionSelector::Candidate>& candidates, size_t& totalSize, uint64_t& fee) {
+    std::vector<size_t> picked;
+    totalSize = 0;
+    fee = 0;
+    selector.select(candidates, [&picked](size_t index) {
+      picked.push_back(index);
+      return true;
+    }, totalSize, fee);
+
+    std::sort(picked.begin(), picked.end());
+    return picked;
+  }
+
+  // what fill_block_template used to do: everything that fits, best fee per byte first
+  uint64_t greedyRevenue(const TransactionSelector& selector, const std::vector<TransactionSelector::Candidate>& candidates) {
+    size_t totalSize = 0;
+    uint64_t fee = 0;
+    for (const auto& candidate : candidates) {
+      if (totalSize + candidate.blobSize <= selector.getMaxSize()) {
+        totalSize += candidate.blobSize;
+        fee += candidate.fee;
+      }
+    }
+
+    return selector.getRevenue(totalSize, fee);
+  }
+
+  std::vector<TransactionSelector::Candidate> generatePool(std::mt19937& generator, size_t count, uint64_t maxFeePerByte) {
+    std::vector<TransactionSelector::Candidate> candidates;
+    for (size_t i = 0; i < count; ++i) {
+      size_t blobSize = 300 + generator() % 3000;
+      candidates.push_back({ blobSize, blobSize * (1 + generator() % maxFeePerByte) });
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const TransactionSelector::Candidate& lhs, const TransactionSelector::Candidate& rhs) {
+      return lhs.fee * rhs.blobSize > rhs.fee * lhs.blobSize;
+    });
+
+    return candidates;
+  }
+
+protected:
+  Logging::ConsoleLogger m_logger;
+  Currency m_currency;
+};
+
+}
+
+TEST_F(TransactionSelectorTest, fillsFreeZoneBetterThanGreedy) {
+  TransactionSelector selector(m_currency, TEST_MEDIAN_SIZE, std::numeric_limits<size_t>::max(), HALF_GENERATED);
+  ASSERT_EQ(TEST_FREE_SIZE, selector.getFreeSize());
+
+  // greedy takes 0 and 1 and has no room left for 2 or 3, which together pay more than 1
+  std::vector<TransactionSelector::Candidate> candidates = {
+    { TEST_FREE_SIZE - 1000, 100000 },
+    { 600, 330 },
+    { 500, 250 },
+    { 500, 250 }
+  };
+
+  size_t totalSize;
+  uint64_t fee;
+  ASSERT_EQ(std::vector<size_t>({ 0, 2, 3 }), select(selector, candidates, totalSize, fee));
+  ASSERT_EQ(TEST_FREE_SIZE, totalSize);
+  ASSERT_EQ(100500, fee);
+}
+
+TEST_F(TransactionSelectorTest, staysInFreeZoneIfPenaltyOutweighsFees) {
+  TransactionSelector selector(m_currency, TEST_MEDIAN_SIZE, std::numeric_limits<size_t>::max(), HALF_GENERATED);
+
+  std::vector<TransactionSelector::Candidate> candidates(30, { 1000, 1000 });
+  size_t totalSize;
+  uint64_t fee;
+  select(selector, candidates, totalSize, fee);
+  ASSERT_EQ(19000, totalSize);
+  ASSERT_EQ(19000, fee);
+}
+
+TEST_F(TransactionSelectorTest, goesPastMedianWhileRevenueGrows) {
+  TransactionSelector selector(m_currency, TEST_MEDIAN_SIZE, std::numeric_limits<size_t>::max(), FEES_ONLY);
+
+  std::vector<TransactionSelector::Candidate> candidates(40, { 1000, 1000 });
+  size_t totalSize;
+  uint64_t fee;
+  select(selector, candidates, totalSize, fee);
+  ASSERT_LT(TEST_FREE_SIZE, totalSize);
+  ASSERT_GT(selector.getMaxSize(), totalSize);
+
+  uint64_t revenue = selector.getRevenue(totalSize, fee);
+  ASSERT_GT(revenue, selector.getRevenue(totalSize - 1000, fee - 1000));
+  ASSERT_GE(revenue, selector.getRevenue(totalSize + 1000, fee + 1000));
+}
+
+TEST_F(TransactionSelectorTest, respectsMaxCumulativeSize) {
+  TransactionSelector selector(m_currency, TEST_MEDIAN_SIZE, 5500, FEES_ONLY);
+
+  std::vector<TransactionSelector::Candidate> candidates(10, { 1000, 1000 });
+  size_t totalSize;
+  uint64_t fee;
+  select(selector, candidates, totalSize, fee);
+  ASSERT_EQ(5000, totalSize);
+}
+
+TEST_F(TransactionSelectorTest, earnsAtLeastAsMuchAsGreedy) {
+  std::mt19937 generator(0);
+  for (uint64_t alreadyGenerated : { FEES_ONLY, HALF_GENERATED }) {
+    TransactionSelector selector(m_currency, TEST_MEDIAN_SIZE, std::numeric_limits<size_t>::max(), alreadyGenerated);
+    for (size_t round = 0; round < 20; ++round) {
+      auto candidates = generatePool(generator, 10 + generator() % 100, 1000);
+
+      size_t totalSize;
+      uint64_t fee;
+      select(selector, candidates, totalSize, fee);
+      ASSERT_LE(totalSize, selector.getMaxSize());
+      ASSERT_GE(selector.getRevenue(totalSize, fee), greedyRevenue(selector, candidates));
+    }
+  }
+}